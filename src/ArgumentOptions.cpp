@@ -13,6 +13,20 @@
 #include <getopt.h>
 #include <unistd.h>
 
+// long options without a short form
+enum {
+	OPTION_CACHE = 256,
+	OPTION_CACHE_SIZE,
+	OPTION_CACHE_STATS,
+	OPTION_CHECK_LEXER,
+	OPTION_MEM_REPORT,
+	OPTION_PCH,
+	OPTION_SERVER,
+	OPTION_TIME_REPORT
+};
+
+#define DEFAULT_CACHE_SIZE (100ULL * 1024 * 1024)
+
 ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 	includeDirs.push_back("./");
 	output = NULL;
@@ -21,15 +35,48 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 	
 	verbose = false;
 	
-	const char *shortOptions = "cEI:ho:rsevV";
+	jobs = 1;
+	
+	dependencies = false;
+	systemDependencies = false;
+	dependenciesOnly = false;
+	dependencyFile = NULL;
+	
+	cacheDir = getenv("UCC_CACHE_DIR");
+	cacheSize = DEFAULT_CACHE_SIZE;
+	cacheStats = false;
+	
+	pchFile = NULL;
+	precompileHeader = false;
+	
+	serverSocket = NULL;
+	
+	timeReport = false;
+	jsonTimeReport = false;
+	
+	memReport = false;
+	
+	checkLexer = false;
+	
+	const char *shortOptions = "cEI:hj:M::o:rsevV";
 	struct option longOptions[] = {
+			{"cache", true, NULL, OPTION_CACHE},
+			{"cache-size", true, NULL, OPTION_CACHE_SIZE},
+			{"cache-stats", false, NULL, OPTION_CACHE_STATS},
+			{"check-lexer", false, NULL, OPTION_CHECK_LEXER},
 			{"include", true, NULL, 'I'},
+			{"jobs", true, NULL, 'j'},
+			{"mem-report", false, NULL, OPTION_MEM_REPORT},
 			{"output", true, NULL, 'o'},
+			{"pch", true, NULL, OPTION_PCH},
 			{"run", false, NULL, 'r'},
+			{"server", true, NULL, OPTION_SERVER},
 			{"syntax", false, NULL, 's'},
+			{"time-report", optional_argument, NULL, OPTION_TIME_REPORT},
 			{"nopreprocessor", false, NULL, 'e'},
 			{"version", false, NULL, 'v'},
 			{"verbose", false, NULL, 'V'},
+			{NULL, false, NULL, 0}
 	};
 	int longIndex;
 	
@@ -52,6 +99,12 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 			case 'I':
 				addIncludeDir(optarg);
 				break;
+			case 'j':
+				setJobs(optarg);
+				break;
+			case 'M':
+				setDependencies(optarg, argc, argv);
+				break;
 			case 'o':
 				output = optarg;
 				break;
@@ -68,6 +121,30 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 			case 'V':
 				verbose = true;
 				break;
+			case OPTION_CACHE:
+				cacheDir = optarg;
+				break;
+			case OPTION_CACHE_SIZE:
+				setCacheSize(optarg);
+				break;
+			case OPTION_CACHE_STATS:
+				cacheStats = true;
+				break;
+			case OPTION_CHECK_LEXER:
+				checkLexer = true;
+				break;
+			case OPTION_MEM_REPORT:
+				memReport = true;
+				break;
+			case OPTION_PCH:
+				pchFile = optarg;
+				break;
+			case OPTION_SERVER:
+				serverSocket = optarg;
+				break;
+			case OPTION_TIME_REPORT:
+				setTimeReport(optarg);
+				break;
 			case '?':
 				// long opt already printed an error
 				showUsage();
@@ -78,18 +155,30 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 		}
 	}
 	
+	// the dependencies are found by the preprocessor, nothing else is needed
+	if (dependenciesOnly) step = PREPROCESS;
+	
 	assert(optind >= 0);
 	for (int i = optind; i < argc; ++i) {
 		std::string ext = getFileUpperCaseExtension(argv[i]);
-		if (ext != "C" && ext != "ASM" && ext != "VM" && ext != "") {
+		if (ext != "C" && ext != "H" && ext != "ASM" && ext != "UO" && ext != "VM" && ext != "") {
 			std::cerr << "Unknown file type: " << argv[i] << std::endl;
 			exit(-1);
 		}
 		
+		if (ext == "H") precompileHeader = true;
 		files.push_back(argv[i]);
 	}
 	
-	if (files.empty()) {
+	if (precompileHeader && (!pchFile || files.size() != 1)) {
+		std::cerr << "ucc: a header can only be precompiled alone, with --pch <file>." << std::endl;
+		exit(-1);
+	}
+	
+	// the header is only preprocessed
+	if (precompileHeader) step = PREPROCESS;
+	
+	if (files.empty() && !serverSocket) {
 		std::cerr << "ucc: no input files." << std::endl;
 		exit(-1);
 	}
@@ -124,6 +213,80 @@ bool ArgumentOptions::isVerbose() const {
 	return verbose;
 }
 
+unsigned int ArgumentOptions::getJobs() const {
+	return jobs;
+}
+
+bool ArgumentOptions::isDependencies() const {
+	return dependencies;
+}
+
+bool ArgumentOptions::isSystemDependencies() const {
+	return systemDependencies;
+}
+
+bool ArgumentOptions::isDependenciesOnly() const {
+	return dependenciesOnly;
+}
+
+std::string ArgumentOptions::getDependencyFile() const {
+	if (dependencyFile) return dependencyFile;
+	if (dependenciesOnly) return "";
+	
+	// the output with the extension replaced by .d
+	std::string file = getOutputFile();
+	std::string::size_type dot = file.rfind('.');
+	std::string::size_type slash = file.rfind('/');
+	if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) file.erase(dot);
+	
+	return file + ".d";
+}
+
+const char *ArgumentOptions::getCacheDir() const {
+	if (cacheDir && !*cacheDir) return NULL;
+	return cacheDir;
+}
+
+unsigned long long ArgumentOptions::getCacheSize() const {
+	return cacheSize;
+}
+
+bool ArgumentOptions::isCacheStats() const {
+	return cacheStats;
+}
+
+const char *ArgumentOptions::getPchFile() const {
+	return pchFile;
+}
+
+bool ArgumentOptions::isPrecompileHeader() const {
+	return precompileHeader;
+}
+
+bool ArgumentOptions::isServer() const {
+	return serverSocket;
+}
+
+const char *ArgumentOptions::getServerSocket() const {
+	return serverSocket;
+}
+
+bool ArgumentOptions::isTimeReport() const {
+	return timeReport;
+}
+
+bool ArgumentOptions::isJsonTimeReport() const {
+	return jsonTimeReport;
+}
+
+bool ArgumentOptions::isMemReport() const {
+	return memReport;
+}
+
+bool ArgumentOptions::isCheckLexer() const {
+	return checkLexer;
+}
+
 void ArgumentOptions::addIncludeDir(const char *path) {
 	unsigned int len = strlen(path);
 	if (!len) return;
@@ -131,16 +294,96 @@ void ArgumentOptions::addIncludeDir(const char *path) {
 	else includeDirs.push_back(std::string(path) + "/");
 }
 
+void ArgumentOptions::setJobs(const char *arg) {
+	char *end;
+	long n = strtol(arg, &end, 10);
+	
+	if (*end || n < 1) {
+		std::cerr << "ucc: invalid number of jobs: " << arg << std::endl;
+		exit(-1);
+	}
+	
+	jobs = n;
+}
+
+/*
+ * -M, -MM, -MD, -MMD, -MF file and -MFfile, getopt sees them as -M with an
+ * optional argument.
+ */
+void ArgumentOptions::setDependencies(const char *arg, int argc, char * const argv[]) {
+	std::string mode = arg ? arg : "";
+	
+	if (mode.size() > 0 && mode[0] == 'F') {
+		if (mode.size() > 1) dependencyFile = arg + 1;
+		else if (optind < argc) dependencyFile = argv[optind++];
+		else {
+			std::cerr << "ucc: missing dependency file after -MF" << std::endl;
+			exit(-1);
+		}
+		return;
+	}
+	
+	if (mode == "" || mode == "M") dependenciesOnly = true;
+	else if (mode != "D" && mode != "MD") {
+		std::cerr << "ucc: unknown option: -M" << mode << std::endl;
+		exit(-1);
+	}
+	
+	dependencies = true;
+	systemDependencies = mode == "" || mode == "D";
+}
+
+void ArgumentOptions::setCacheSize(const char *arg) {
+	char *end;
+	long n = strtol(arg, &end, 10);
+	
+	if (*end || n < 1) {
+		std::cerr << "ucc: invalid cache size: " << arg << std::endl;
+		exit(-1);
+	}
+	
+	// in megabytes
+	cacheSize = (unsigned long long)n * 1024 * 1024;
+}
+
+void ArgumentOptions::setTimeReport(const char *arg) {
+	if (arg && strcmp(arg, "json")) {
+		std::cerr << "ucc: invalid time report format: " << arg << std::endl;
+		exit(-1);
+	}
+	
+	timeReport = true;
+	jsonTimeReport = arg;
+}
+
 void ArgumentOptions::showUsage() {
 	std::cerr << "Usage: ucc [OPTIONS] FILE..." << std::endl;
 	
 	std::cerr << "  -c\t\t\t Compile only." << std::endl;
+	std::cerr << "      --cache <dir>\t Reuse the compiled files cached in dir"
+			<< " (default: $UCC_CACHE_DIR)." << std::endl;
+	std::cerr << "      --cache-size <n>\t Keep the cache under n MB (default: 100)." << std::endl;
+	std::cerr << "      --cache-stats\t Show the cache hits and misses." << std::endl;
+	std::cerr << "      --check-lexer\t Check the C lexer against the scanner of the grammar on"
+			<< " the inputs, not preprocessed (for the tests)." << std::endl;
 	std::cerr << "  -e, --no-preprocessor\t Do not run the preprocessor." << std::endl;
 	std::cerr << "  -E\t\t\t Preprocess only." << std::endl;
 	std::cerr << "  -h, --help\t\t Show this help and exit." << std::endl;
+	std::cerr << "  -j, --jobs <n>\t Compile up to n files in parallel." << std::endl;
+	std::cerr << "      --mem-report\t Show the memory allocated by each phase." << std::endl;
+	std::cerr << "  -M, -MM\t\t Only write the files the output depends on (-MM omits the"
+			<< " system headers)." << std::endl;
+	std::cerr << "  -MD, -MMD\t\t Also write the dependencies to the output with a .d"
+			<< " extension." << std::endl;
+	std::cerr << "  -MF <file>\t\t Write the dependencies to file." << std::endl;
 	std::cerr << "  -o, --output <file>\t Specify the output file." << std::endl;
+	std::cerr << "      --pch <file>\t Precompile the header given as input to file, or start"
+			<< " from it the inputs whose first directive includes that header." << std::endl;
 	std::cerr << "  -r, --run\t\t Run the program." << std::endl;
 	std::cerr << "  -s, --syntax\t\t Syntax check only." << std::endl;
+	std::cerr << "      --server <socket>\t Keep the tables loaded and compile for the clients"
+			<< " connecting to socket (clients use $UCC_SERVER)." << std::endl;
+	std::cerr << "      --time-report[=json]  Show the time of each phase for each file." << std::endl;
 	std::cerr << "  -v, --version\t\t Show the version and exit." << std::endl;
 	std::cerr << "  -V, --verbose\t\t Show debug infromation." << std::endl;
 }
@@ -27,11 +27,53 @@ class ArgumentOptions {
 		bool isPreprocess() const;
 		bool isVerbose() const;
 		
+		// number of translation units compiled in parallel
+		unsigned int getJobs() const;
+		
+		// write the files each output depends on, as a make rule
+		bool isDependencies() const;
+		bool isSystemDependencies() const;
+		
+		// -M and -MM only write the dependencies, -MD and -MMD also compile
+		bool isDependenciesOnly() const;
+		
+		// empty to write them to the standard output
+		std::string getDependencyFile() const;
+		
+		// NULL if the compilation cache is not used
+		const char *getCacheDir() const;
+		unsigned long long getCacheSize() const;
+		bool isCacheStats() const;
+		
+		/*
+		 * NULL if no precompiled header is used. If the input is a header,
+		 * it is precompiled to this file, otherwise the inputs that include
+		 * the header first start from it.
+		 */
+		const char *getPchFile() const;
+		bool isPrecompileHeader() const;
+		
+		// run as a compile server listening at the socket
+		bool isServer() const;
+		const char *getServerSocket() const;
+		
+		bool isTimeReport() const;
+		bool isJsonTimeReport() const;
+		
+		bool isMemReport() const;
+		
+		// lex the inputs both with CLexer and with the scanner it replaced
+		bool isCheckLexer() const;
+		
 		static void showUsage();
 		static void showVersion();
 		
 	private:
 		void addIncludeDir(const char *path);
+		void setJobs(const char *arg);
+		void setDependencies(const char *arg, int argc, char * const argv[]);
+		void setCacheSize(const char *arg);
+		void setTimeReport(const char *arg);
 		
 		FileList files;
 		FileList includeDirs;
@@ -41,6 +83,29 @@ class ArgumentOptions {
 		bool preprocess;
 		
 		bool verbose;
+		
+		unsigned int jobs;
+		
+		bool dependencies;
+		bool systemDependencies;
+		bool dependenciesOnly;
+		const char *dependencyFile;
+		
+		const char *cacheDir;
+		unsigned long long cacheSize;
+		bool cacheStats;
+		
+		const char *pchFile;
+		bool precompileHeader;
+		
+		const char *serverSocket;
+		
+		bool timeReport;
+		bool jsonTimeReport;
+		
+		bool memReport;
+		
+		bool checkLexer;
 };
 
 #endif
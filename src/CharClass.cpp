@@ -0,0 +1,185 @@
+#include "CharClass.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHAR_CLASS_VECTOR
+#include <immintrin.h>
+#endif
+
+// the flags of each character, by its unsigned value
+const unsigned char CharClass::table[256] = {
+	0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x43, 0x01, 0x43, 0x43, 0x43, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x43, 0x40, 0x00, 0x40, 0x40, 0x40, 0x40, 0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00,
+	0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70,
+	0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x40, 0x00, 0x40, 0x40, 0x70,
+	0x40, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70,
+	0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40
+};
+
+typedef const char *(*ScanFunction)(const char *begin, const char *end);
+
+static const char *skipPlainTextTable(const char *begin, const char *end) {
+	while (begin != end && CharClass::isPlainText(*begin)) ++begin;
+	return begin;
+}
+
+static const char *skipSpacesTable(const char *begin, const char *end) {
+	while (begin != end && CharClass::isSpace(*begin)) ++begin;
+	return begin;
+}
+
+#ifdef CHAR_CLASS_VECTOR
+
+/*
+ * The same loops on 16 or 32 characters at once: each class is a few
+ * compares, the first character out of it is the lowest bit of the mask.
+ * The characters left at the end go through the table.
+ */
+__attribute__((target("sse2")))
+static const char *skipPlainTextSse2(const char *begin, const char *end) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i newLine = _mm_set1_epi8('\n');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i slash = _mm_set1_epi8('/');
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i apostrophe = _mm_set1_epi8('\'');
+	
+	while (end - begin >= 16) {
+		__m128i chars = _mm_loadu_si128((const __m128i *)begin);
+		
+		__m128i found = _mm_or_si128(_mm_cmpeq_epi8(chars, zero), _mm_cmpeq_epi8(chars, newLine));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, backslash));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, slash));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, quote));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, apostrophe));
+		
+		int mask = _mm_movemask_epi8(found);
+		if (mask) return begin + __builtin_ctz(mask);
+		
+		begin += 16;
+	}
+	
+	return skipPlainTextTable(begin, end);
+}
+
+__attribute__((target("sse2")))
+static const char *skipSpacesSse2(const char *begin, const char *end) {
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i controls = _mm_set1_epi8('\r' - '\t');
+	
+	while (end - begin >= 16) {
+		__m128i chars = _mm_loadu_si128((const __m128i *)begin);
+		
+		// '\t' to '\r' are the unsigned values from 0 to 4 once '\t' is taken
+		__m128i control = _mm_sub_epi8(chars, tab);
+		control = _mm_cmpeq_epi8(_mm_min_epu8(control, controls), control);
+		
+		__m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chars, space), control);
+		
+		int mask = ~_mm_movemask_epi8(spaces) & 0xFFFF;
+		if (mask) return begin + __builtin_ctz(mask);
+		
+		begin += 16;
+	}
+	
+	return skipSpacesTable(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char *skipPlainTextAvx2(const char *begin, const char *end) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i newLine = _mm256_set1_epi8('\n');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i slash = _mm256_set1_epi8('/');
+	const __m256i quote = _mm256_set1_epi8('\"');
+	const __m256i apostrophe = _mm256_set1_epi8('\'');
+	
+	while (end - begin >= 32) {
+		__m256i chars = _mm256_loadu_si256((const __m256i *)begin);
+		
+		__m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(chars, zero), _mm256_cmpeq_epi8(chars, newLine));
+		found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, backslash));
+		found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, slash));
+		found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, quote));
+		found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, apostrophe));
+		
+		unsigned int mask = _mm256_movemask_epi8(found);
+		if (mask) return begin + __builtin_ctz(mask);
+		
+		begin += 32;
+	}
+	
+	return skipPlainTextSse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char *skipSpacesAvx2(const char *begin, const char *end) {
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i controls = _mm256_set1_epi8('\r' - '\t');
+	
+	while (end - begin >= 32) {
+		__m256i chars = _mm256_loadu_si256((const __m256i *)begin);
+		
+		__m256i control = _mm256_sub_epi8(chars, tab);
+		control = _mm256_cmpeq_epi8(_mm256_min_epu8(control, controls), control);
+		
+		__m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chars, space), control);
+		
+		unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(spaces);
+		if (mask) return begin + __builtin_ctz(mask);
+		
+		begin += 32;
+	}
+	
+	return skipSpacesSse2(begin, end);
+}
+
+#endif
+
+struct ScanFunctions {
+	ScanFunction skipPlainText;
+	ScanFunction skipSpaces;
+};
+
+// the best loops this processor runs, chosen once when the program starts
+static ScanFunctions selectScanFunctions() {
+	ScanFunctions functions;
+	functions.skipPlainText = &skipPlainTextTable;
+	functions.skipSpaces = &skipSpacesTable;
+	
+#ifdef CHAR_CLASS_VECTOR
+	__builtin_cpu_init();
+	
+	if (__builtin_cpu_supports("avx2")) {
+		functions.skipPlainText = &skipPlainTextAvx2;
+		functions.skipSpaces = &skipSpacesAvx2;
+	}
+	else if (__builtin_cpu_supports("sse2")) {
+		functions.skipPlainText = &skipPlainTextSse2;
+		functions.skipSpaces = &skipSpacesSse2;
+	}
+#endif
+	
+	return functions;
+}
+
+static const ScanFunctions scanFunctions = selectScanFunctions();
+
+const char *CharClass::skipPlainText(const char *begin, const char *end) {
+	return scanFunctions.skipPlainText(begin, end);
+}
+
+const char *CharClass::skipSpaces(const char *begin, const char *end) {
+	return scanFunctions.skipSpaces(begin, end);
+}
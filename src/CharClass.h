@@ -0,0 +1,75 @@
+#ifndef CHAR_CLASS_H
+#define CHAR_CLASS_H
+
+/*
+ * The classes of characters tested by the loops of the scanners, read from
+ * one table instead of the <cctype> functions, which depend on the locale.
+ * The longest runs (the skipped lines, the spaces) can also be passed over
+ * in a buffer, 16 or 32 characters at a time when the processor has SSE2
+ * or AVX2, with the table otherwise.
+ */
+class CharClass {
+	public:
+		// ' ', '\t', '\n', '\v', '\f' or '\r'
+		static bool isSpace(char c);
+		
+		// a white space that does not end the line
+		static bool isLineSpace(char c);
+		
+		static bool isDigit(char c);
+		static bool isHexDigit(char c);
+		
+		// \w and (\w|\d) of the grammars
+		static bool isIdentifierStart(char c);
+		static bool isIdentifier(char c);
+		
+		// not the end of the line or of the input, a '\\', a '/' or a quote
+		static bool isPlainText(char c);
+		
+		// the first character from begin on that is not plain text (or not a space), end if none
+		static const char *skipPlainText(const char *begin, const char *end);
+		static const char *skipSpaces(const char *begin, const char *end);
+		
+	private:
+		enum Flag {
+			SPACE = 0x01,
+			LINE_SPACE = 0x02,
+			DIGIT = 0x04,
+			HEX_DIGIT = 0x08,
+			IDENTIFIER_START = 0x10,
+			IDENTIFIER = 0x20,
+			PLAIN_TEXT = 0x40
+		};
+		
+		static const unsigned char table[256];
+};
+
+inline bool CharClass::isSpace(char c) {
+	return table[(unsigned char)c] & SPACE;
+}
+
+inline bool CharClass::isLineSpace(char c) {
+	return table[(unsigned char)c] & LINE_SPACE;
+}
+
+inline bool CharClass::isDigit(char c) {
+	return table[(unsigned char)c] & DIGIT;
+}
+
+inline bool CharClass::isHexDigit(char c) {
+	return table[(unsigned char)c] & HEX_DIGIT;
+}
+
+inline bool CharClass::isIdentifierStart(char c) {
+	return table[(unsigned char)c] & IDENTIFIER_START;
+}
+
+inline bool CharClass::isIdentifier(char c) {
+	return table[(unsigned char)c] & IDENTIFIER;
+}
+
+inline bool CharClass::isPlainText(char c) {
+	return table[(unsigned char)c] & PLAIN_TEXT;
+}
+
+#endif
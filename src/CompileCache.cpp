@@ -0,0 +1,242 @@
+#include "CompileCache.h"
+
+#include "ObjectFile.h"
+#include "Sha256.h"
+#include "TokenStream.h"
+#include "UccDefs.h"
+#include "vm/Program.h"
+
+#include <parser/ParserError.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+#define CACHE_ENTRY_EXTENSION ".uo"
+#define CACHE_STATS_FILE "stats"
+
+CompileCache::CompileCache(const std::string & dir, unsigned long long limit) : directory(dir),
+		sizeLimit(limit), hits(0), misses(0), tempCount(0), totalHits(0),
+		totalMisses(0), cacheSize(0) {
+		
+	if (directory.empty() || directory[directory.size() - 1] != '/') directory += "/";
+	
+	// a missing directory just makes every lookup a miss and every store fail
+	mkdir(directory.c_str(), 0755);
+	
+	pthread_mutex_init(&mutex, NULL);
+}
+
+CompileCache::~CompileCache() {
+	pthread_mutex_destroy(&mutex);
+}
+
+std::string CompileCache::getKey(const TokenStream & tokens) {
+	std::ostringstream text;
+	tokens.dump(text);
+	
+	return getTextKey(text.str());
+}
+
+std::string CompileCache::getFileKey(const std::string & fileName) {
+	// the input of the unit is left for the compiler, the file is read again
+	std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) return "";
+	
+	std::ostringstream text;
+	text << in.rdbuf();
+	if (!in) return "";
+	
+	return getTextKey(text.str());
+}
+
+std::string CompileCache::getTextKey(const std::string & text) {
+	// no option changes the generated code yet, only the compiler version does
+	Sha256 sha;
+	sha.update(UCC_VERSION);
+	sha.update(std::string(1, '\0'));
+	sha.update(text);
+	
+	return sha.getHexDigest();
+}
+
+Program *CompileCache::load(const std::string & key) {
+	std::string file = getEntryFile(key);
+	Program *program = NULL;
+	
+	if (access(file.c_str(), R_OK) == 0) {
+		try {
+			ObjectFile::ProgramList programs = ObjectFile().readPrograms(file);
+			
+			if (programs.size() == 1) program = programs.front();
+			else {
+				for (ObjectFile::ProgramList::iterator it = programs.begin(); it != programs.end(); ++it) {
+					delete(*it);
+				}
+			}
+		}
+		catch (ParserError &) {
+			// a damaged entry is a miss, it is replaced by the next store
+		}
+	}
+	
+	// the modification time is the last use
+	if (program) utime(file.c_str(), NULL);
+	
+	pthread_mutex_lock(&mutex);
+	if (program) ++hits;
+	else ++misses;
+	pthread_mutex_unlock(&mutex);
+	
+	return program;
+}
+
+void CompileCache::store(const std::string & key, const Program *program) {
+	writeEntry(key, program, NULL);
+}
+
+void CompileCache::store(const std::string & key, const Program *program,
+		const ObjectFile::Writer & code) {
+	
+	writeEntry(key, program, &code);
+}
+
+void CompileCache::flush() {
+	evict();
+	saveStats();
+}
+
+void CompileCache::showStats(std::ostream & out) const {
+	out << "cache directory: " << directory << std::endl;
+	out << "cache hits: " << totalHits << " (" << hits << " in this run)" << std::endl;
+	out << "cache misses: " << totalMisses << " (" << misses << " in this run)" << std::endl;
+	out << "cache size: " << (cacheSize + 1023) / 1024 << " KB of "
+			<< sizeLimit / 1024 << " KB" << std::endl;
+}
+
+std::string CompileCache::getEntryFile(const std::string & key) const {
+	return directory + key + CACHE_ENTRY_EXTENSION;
+}
+
+std::string CompileCache::getStatsFile() const {
+	return directory + CACHE_STATS_FILE;
+}
+
+void CompileCache::writeEntry(const std::string & key, const Program *program,
+		const ObjectFile::Writer *code) {
+	
+	pthread_mutex_lock(&mutex);
+	unsigned int temp = tempCount++;
+	pthread_mutex_unlock(&mutex);
+	
+	// write to a temporary file, so no one reads a partial entry
+	std::ostringstream tempFile;
+	tempFile << getEntryFile(key) << ".tmp" << getpid() << "-" << temp;
+	
+	std::ofstream out(tempFile.str().c_str(), std::ios::out | std::ios::binary);
+	if (!out) return;
+	
+	try {
+		if (code) code->writeObject(out, program->getMemory());
+		else ObjectFile().writeProgram(out, program);
+	}
+	catch (std::runtime_error &) {
+		// an entry that cannot be written is just not cached
+		out.setstate(std::ios::failbit);
+	}
+	out.close();
+	
+	if (!out || rename(tempFile.str().c_str(), getEntryFile(key).c_str())) {
+		remove(tempFile.str().c_str());
+	}
+}
+
+void CompileCache::evict() {
+	typedef std::vector<std::pair<time_t, std::string> > EntryList;
+	
+	DIR *dir = opendir(directory.c_str());
+	if (!dir) return;
+	
+	EntryList entries;
+	unsigned long long size = 0;
+	
+	const std::string ext = CACHE_ENTRY_EXTENSION;
+	
+	struct dirent *ent;
+	while ((ent = readdir(dir))) {
+		std::string name = ent->d_name;
+		if (name.size() <= ext.size() || name.compare(name.size() - ext.size(), ext.size(), ext)) {
+			continue;
+		}
+		
+		struct stat st;
+		std::string file = directory + name;
+		if (stat(file.c_str(), &st)) continue;
+		
+		entries.push_back(std::make_pair(st.st_mtime, file));
+		size += st.st_size;
+	}
+	
+	closedir(dir);
+	
+	if (size > sizeLimit) {
+		// oldest first
+		std::sort(entries.begin(), entries.end());
+		
+		for (EntryList::iterator it = entries.begin(); it != entries.end() && size > sizeLimit; ++it) {
+			struct stat st;
+			if (stat(it->second.c_str(), &st) == 0 && remove(it->second.c_str()) == 0) {
+				size -= st.st_size;
+			}
+		}
+	}
+	
+	cacheSize = size;
+}
+
+void CompileCache::saveStats() {
+	int fd = open(getStatsFile().c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		totalHits = hits;
+		totalMisses = misses;
+		return;
+	}
+	
+	// other ucc processes may be updating the same cache
+	flock(fd, LOCK_EX);
+	
+	char buf[64];
+	ssize_t len = read(fd, buf, sizeof(buf) - 1);
+	buf[len > 0 ? len : 0] = '\0';
+	
+	unsigned long long savedHits = 0;
+	unsigned long long savedMisses = 0;
+	sscanf(buf, "%llu %llu", &savedHits, &savedMisses);
+	
+	totalHits = savedHits + hits;
+	totalMisses = savedMisses + misses;
+	
+	len = sprintf(buf, "%llu %llu\n", totalHits, totalMisses);
+	if (ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0) {
+		if (write(fd, buf, len) != len) {
+			std::cerr << "ucc: cannot save the cache statistics." << std::endl;
+		}
+	}
+	
+	flock(fd, LOCK_UN);
+	close(fd);
+}
@@ -0,0 +1,79 @@
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+
+#include "ObjectFile.h"
+
+#include <iosfwd>
+#include <string>
+
+#include <pthread.h>
+
+class Program;
+class TokenStream;
+
+/*
+ * On-disk cache of compiled translation units.
+ *
+ * The key is a SHA-256 digest of the preprocessed code and of everything else
+ * that changes the generated code, the value is the program stored as a .uo
+ * object. Entries are touched when used and the least recently used ones
+ * are removed when the cache grows past its size limit.
+ *
+ * One cache is shared by all the compile threads.
+ */
+class CompileCache {
+	public:
+		CompileCache(const std::string & dir, unsigned long long limit);
+		~CompileCache();
+		
+		static std::string getKey(const TokenStream & tokens);
+		
+		// key of a file compiled without the preprocessor, empty if it cannot be read
+		static std::string getFileKey(const std::string & fileName);
+		
+		// return NULL if the key is not in the cache
+		Program *load(const std::string & key);
+		
+		void store(const std::string & key, const Program *program);
+		
+		// store a program whose code was written to code as it was compiled
+		void store(const std::string & key, const Program *program, const ObjectFile::Writer & code);
+		
+		// remove the least recently used entries and save the statistics
+		void flush();
+		
+		void showStats(std::ostream & out) const;
+		
+	private:
+		// key of the code as text
+		static std::string getTextKey(const std::string & text);
+		
+		std::string getEntryFile(const std::string & key) const;
+		std::string getStatsFile() const;
+		
+		// code is NULL if the program has its instructions
+		void writeEntry(const std::string & key, const Program *program,
+				const ObjectFile::Writer *code);
+		
+		void evict();
+		
+		// add the counters of this run to the saved ones
+		void saveStats();
+		
+		std::string directory;
+		unsigned long long sizeLimit;
+		
+		pthread_mutex_t mutex;
+		
+		// counters of this run
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int tempCount;
+		
+		// counters of all the runs, set by saveStats
+		unsigned long long totalHits;
+		unsigned long long totalMisses;
+		unsigned long long cacheSize;
+};
+
+#endif
@@ -0,0 +1,192 @@
+#include "CompileServer.h"
+
+#include "ArgumentOptions.h"
+#include "ServerProtocol.h"
+
+#include "compiler/Compiler.h"
+#include "preprocessor/Preprocessor.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <getopt.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+CompileServer::CompileServer(const ArgumentOptions & opt, CompileFunction func) : options(opt),
+		compileFunction(func), preprocessor(NULL), compiler(NULL) {}
+		
+CompileServer::~CompileServer() {
+	delete(preprocessor);
+	delete(compiler);
+}
+
+int CompileServer::run() {
+	int sock = listenServer(options.getServerSocket());
+	if (sock < 0) {
+		if (errno == EADDRINUSE) {
+			std::cerr << "ucc: a server is already running at " << options.getServerSocket() << std::endl;
+		}
+		else {
+			std::cerr << "ucc: cannot listen at " << options.getServerSocket() << ": "
+					<< strerror(errno) << std::endl;
+		}
+		return -1;
+	}
+	
+	// the clients may need any of the tables
+	preprocessor = new Preprocessor(options.getIncludeDirs());
+	preprocessor->loadTables();
+	compiler = new Compiler();
+	compiler->loadTables();
+	
+	// the client processes are not waited for
+	signal(SIGCHLD, SIG_IGN);
+	
+	for (;;) {
+		int client = accept(sock, NULL, NULL);
+		if (client < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			
+			std::cerr << "ucc: server stopped: " << strerror(errno) << std::endl;
+			close(sock);
+			return -1;
+		}
+		
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(sock);
+			serveClient(client);
+			_exit(0);
+		}
+		
+		if (pid < 0) std::cerr << "ucc: cannot fork: " << strerror(errno) << std::endl;
+		close(client);
+	}
+}
+
+bool CompileServer::runClient(const std::string & path, int argc, char *argv[], int & status) {
+	int sock = connectServer(path);
+	if (sock < 0) return false;
+	
+	ServerRequest request;
+	request.fds[0] = STDIN_FILENO;
+	request.fds[1] = STDOUT_FILENO;
+	request.fds[2] = STDERR_FILENO;
+	
+	char *cwd = getcwd(NULL, 0);
+	if (cwd) {
+		request.workingDir = cwd;
+		free(cwd);
+	}
+	
+	// umask can only be read by setting it
+	request.fileModeMask = umask(0);
+	umask(request.fileModeMask);
+	
+	for (char **env = environ; *env; ++env) request.environment.push_back(*env);
+	
+	for (int i = 1; i < argc; ++i) request.arguments.push_back(argv[i]);
+	
+	// if the server went away before taking the request, compile here
+	if (request.workingDir.empty() || !sendServerRequest(sock, request) || !receiveServerAccepted(sock)) {
+		close(sock);
+		return false;
+	}
+	
+	// the compilation started, its output may be written already
+	if (!receiveServerStatus(sock, status)) {
+		std::cerr << "ucc: the server stopped during the compilation." << std::endl;
+		status = -1;
+	}
+	
+	close(sock);
+	
+	return true;
+}
+
+void CompileServer::serveClient(int sock) {
+	// the compilation process must be waited for
+	signal(SIGCHLD, SIG_DFL);
+	
+	ServerRequest request;
+	if (!receiveServerRequest(sock, request)) return;
+	
+	// from now on the client does not compile by itself
+	if (!sendServerAccepted(sock)) {
+		for (unsigned int i = 0; i < 3; ++i) close(request.fds[i]);
+		return;
+	}
+	
+	pid_t pid = fork();
+	if (pid == 0) {
+		close(sock);
+		compile(request);
+	}
+	
+	if (pid < 0) {
+		// the client only gets a status, tell it why
+		std::string error = std::string("ucc: the server cannot fork: ") + strerror(errno) + "\n";
+		if (write(request.fds[2], error.data(), error.size()) != (ssize_t)error.size()) std::cerr << error;
+	}
+	
+	for (unsigned int i = 0; i < 3; ++i) close(request.fds[i]);
+	
+	int status = -1;
+	if (pid > 0) {
+		int result;
+		while (waitpid(pid, &result, 0) < 0 && errno == EINTR);
+		
+		// the status a shell would report
+		status = WIFEXITED(result) ? WEXITSTATUS(result) : 128 + WTERMSIG(result);
+	}
+	
+	sendServerStatus(sock, status);
+	close(sock);
+}
+
+void CompileServer::compile(const ServerRequest & request) {
+	for (int i = 0; i < 3; ++i) {
+		dup2(request.fds[i], i);
+		if (request.fds[i] > 2) close(request.fds[i]);
+	}
+	
+	if (chdir(request.workingDir.c_str())) {
+		std::cerr << "ucc: cannot change to " << request.workingDir << ": "
+				<< strerror(errno) << std::endl;
+		exit(-1);
+	}
+	
+	// the options read from the environment (like UCC_CACHE_DIR) are the client ones
+	clearenv();
+	for (ServerRequest::EnvironmentList::const_iterator it = request.environment.begin();
+			it != request.environment.end(); ++it) {
+		// the request lives until the process exits
+		putenv((char *)it->c_str());
+	}
+	
+	umask(request.fileModeMask);
+	
+	std::vector<char *> argv;
+	argv.push_back((char *)"ucc");
+	for (ServerRequest::ArgumentList::const_iterator it = request.arguments.begin();
+			it != request.arguments.end(); ++it) {
+		argv.push_back((char *)it->c_str());
+	}
+	argv.push_back(NULL);
+	
+	// getopt already parsed the server command line
+	optind = 0;
+	
+	exit(compileFunction(argv.size() - 1, &argv[0], preprocessor, compiler));
+}
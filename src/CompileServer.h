@@ -0,0 +1,54 @@
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+
+#include <string>
+
+class ArgumentOptions;
+class Compiler;
+class Preprocessor;
+struct ServerRequest;
+
+/*
+ * ucc --server: load the tables once and run the compilations of the
+ * clients with them.
+ *
+ * Each client gets a process forked from the server, so it starts with the
+ * tables already loaded. The process uses the client stdin, stdout, stderr,
+ * working directory, umask and environment, and its exit status is sent
+ * back to the client.
+ */
+class CompileServer {
+	public:
+		// a whole ucc run, as main does it
+		typedef int (*CompileFunction)(int argc, char *argv[],
+				Preprocessor *preprocessor, Compiler *compiler);
+				
+		CompileServer(const ArgumentOptions & opt, CompileFunction func);
+		~CompileServer();
+		
+		// serve the clients, return only if the socket cannot be used
+		int run();
+		
+		/*
+		 * Run the command line in the server listening at path.
+		 * Return false if no server accepted it, otherwise status is the
+		 * exit status of the compilation (even if the server stopped
+		 * during it, the compilation must not be repeated).
+		 */
+		static bool runClient(const std::string & path, int argc, char *argv[], int & status);
+		
+	private:
+		// run in a process forked for the client
+		void serveClient(int sock);
+		
+		// run in a process forked for the compilation, does not return
+		void compile(const ServerRequest & request);
+		
+		const ArgumentOptions & options;
+		CompileFunction compileFunction;
+		
+		Preprocessor *preprocessor;
+		Compiler *compiler;
+};
+
+#endif
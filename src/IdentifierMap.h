@@ -0,0 +1,149 @@
+#ifndef IDENTIFIER_MAP_H
+#define IDENTIFIER_MAP_H
+
+#include "IdentifierTable.h"
+
+#include <cassert>
+#include <vector>
+
+/*
+ * Map from the ids of an IdentifierTable, a flat hash table with linear
+ * probing. An empty map allocates nothing, most scopes have few names.
+ */
+template<typename _T>
+class IdentifierMap {
+	public:
+		typedef IdentifierTable::Id Id;
+		
+		IdentifierMap();
+		~IdentifierMap();
+		
+		// NULL if id is not in the map
+		_T *find(Id id);
+		const _T *find(Id id) const;
+		
+		// the value of id, a default one is inserted if id is not in the map
+		_T & operator[](Id id);
+		
+		void erase(Id id);
+		
+		unsigned int size() const;
+		
+	private:
+		struct Entry {
+			Entry();
+			
+			// NONE if the slot is empty
+			Id id;
+			_T value;
+		};
+		typedef std::vector<Entry> EntryList;
+		
+		// the slot of id, or the empty slot where it would be
+		unsigned int getSlot(Id id) const;
+		
+		void grow();
+		
+		// the size is 0 or a power of 2
+		EntryList entries;
+		unsigned int count;
+};
+
+template<typename _T>
+IdentifierMap<_T>::Entry::Entry() : id(IdentifierTable::NONE), value() {}
+
+template<typename _T>
+IdentifierMap<_T>::IdentifierMap() : count(0) {}
+
+template<typename _T>
+IdentifierMap<_T>::~IdentifierMap() {}
+
+template<typename _T>
+_T *IdentifierMap<_T>::find(Id id) {
+	if (count == 0) return NULL;
+	
+	Entry & entry = entries[getSlot(id)];
+	return entry.id == id ? &entry.value : NULL;
+}
+
+template<typename _T>
+const _T *IdentifierMap<_T>::find(Id id) const {
+	if (count == 0) return NULL;
+	
+	const Entry & entry = entries[getSlot(id)];
+	return entry.id == id ? &entry.value : NULL;
+}
+
+template<typename _T>
+_T & IdentifierMap<_T>::operator[](Id id) {
+	assert(id != IdentifierTable::NONE);
+	
+	// keep at most half of the slots used
+	if ((count + 1) * 2 > entries.size()) grow();
+	
+	Entry & entry = entries[getSlot(id)];
+	if (entry.id != id) {
+		entry.id = id;
+		++count;
+	}
+	
+	return entry.value;
+}
+
+template<typename _T>
+void IdentifierMap<_T>::erase(Id id) {
+	if (count == 0) return;
+	
+	unsigned int mask = entries.size() - 1;
+	unsigned int slot = getSlot(id);
+	if (entries[slot].id != id) return;
+	
+	// move back the entries after it, so no probe sequence is broken
+	unsigned int next = slot;
+	for (;;) {
+		next = (next + 1) & mask;
+		if (entries[next].id == IdentifierTable::NONE) break;
+		
+		// the entry can be moved only if its home slot is not in (slot, next]
+		unsigned int home = (entries[next].id * 2654435761u) & mask;
+		if (((next - home) & mask) >= ((next - slot) & mask)) {
+			entries[slot] = entries[next];
+			slot = next;
+		}
+	}
+	
+	entries[slot] = Entry();
+	--count;
+}
+
+template<typename _T>
+unsigned int IdentifierMap<_T>::size() const {
+	return count;
+}
+
+template<typename _T>
+unsigned int IdentifierMap<_T>::getSlot(Id id) const {
+	unsigned int mask = entries.size() - 1;
+	
+	// the ids are consecutive, a multiplicative hash spreads them
+	unsigned int slot = (id * 2654435761u) & mask;
+	while (entries[slot].id != id && entries[slot].id != IdentifierTable::NONE) {
+		slot = (slot + 1) & mask;
+	}
+	
+	return slot;
+}
+
+template<typename _T>
+void IdentifierMap<_T>::grow() {
+	EntryList old;
+	old.swap(entries);
+	
+	entries.resize(old.empty() ? 8 : old.size() * 2);
+	
+	for (typename EntryList::iterator it = old.begin(); it != old.end(); ++it) {
+		if (it->id != IdentifierTable::NONE) entries[getSlot(it->id)] = *it;
+	}
+}
+
+#endif
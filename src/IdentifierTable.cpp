@@ -0,0 +1,64 @@
+#include "IdentifierTable.h"
+
+#include <cassert>
+
+#define INITIAL_SLOTS 256
+
+const IdentifierTable::Id IdentifierTable::NONE;
+
+IdentifierTable::IdentifierTable() : slots(INITIAL_SLOTS, NONE) {}
+
+IdentifierTable::~IdentifierTable() {}
+
+IdentifierTable::Id IdentifierTable::intern(const std::string & name) {
+	unsigned int h = hash(name);
+	unsigned int mask = slots.size() - 1;
+	
+	unsigned int slot = h & mask;
+	while (slots[slot] != NONE) {
+		Id id = slots[slot];
+		if (hashes[id - 1] == h && names[id - 1] == name) return id;
+		slot = (slot + 1) & mask;
+	}
+	
+	names.push_back(name);
+	hashes.push_back(h);
+	Id id = names.size();
+	slots[slot] = id;
+	
+	// keep at most half of the slots used, so the probes are short
+	if (names.size() * 2 > slots.size()) grow();
+	
+	return id;
+}
+
+const std::string & IdentifierTable::getName(Id id) const {
+	assert(id != NONE && id <= names.size());
+	return names[id - 1];
+}
+
+unsigned int IdentifierTable::size() const {
+	return names.size();
+}
+
+unsigned int IdentifierTable::hash(const std::string & name) {
+	// FNV-1a
+	unsigned int h = 2166136261u;
+	for (std::string::const_iterator it = name.begin(); it != name.end(); ++it) {
+		h = (h ^ (unsigned char)*it) * 16777619u;
+	}
+	return h;
+}
+
+void IdentifierTable::grow() {
+	std::vector<Id> newSlots(slots.size() * 2, NONE);
+	unsigned int mask = newSlots.size() - 1;
+	
+	for (Id id = 1; id <= names.size(); ++id) {
+		unsigned int slot = hashes[id - 1] & mask;
+		while (newSlots[slot] != NONE) slot = (slot + 1) & mask;
+		newSlots[slot] = id;
+	}
+	
+	slots.swap(newSlots);
+}
@@ -0,0 +1,41 @@
+#ifndef IDENTIFIER_TABLE_H
+#define IDENTIFIER_TABLE_H
+
+#include <string>
+#include <vector>
+
+/*
+ * Give each different identifier a small integer, so the tables can be
+ * keyed by it (see IdentifierMap) instead of comparing strings.
+ * The ids are given in order, starting at 1 (NONE is never an identifier).
+ */
+class IdentifierTable {
+	public:
+		typedef unsigned int Id;
+		
+		static const Id NONE = 0;
+		
+		IdentifierTable();
+		~IdentifierTable();
+		
+		// the id of name, a new one the first time name is seen
+		Id intern(const std::string & name);
+		
+		const std::string & getName(Id id) const;
+		
+		unsigned int size() const;
+		
+	private:
+		static unsigned int hash(const std::string & name);
+		
+		void grow();
+		
+		// names[id - 1]
+		std::vector<std::string> names;
+		std::vector<unsigned int> hashes;
+		
+		// open addressing, the size is a power of 2 and NONE is an empty slot
+		std::vector<Id> slots;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define READ_BLOCK_SIZE 65536
+
+MappedFile::MappedFile(const std::string & fileName) : open(false), mapping(NULL), size(0) {
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) return;
+	
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED) {
+			// the scanners read it from the start to the end
+			madvise(addr, st.st_size, MADV_SEQUENTIAL);
+			
+			mapping = addr;
+			size = st.st_size;
+			open = true;
+		}
+	}
+	
+	// an empty file has nothing to map, and some files cannot be mapped
+	if (!open) open = readFile(fd);
+	
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (mapping) munmap(mapping, size);
+}
+
+bool MappedFile::isOpen() const {
+	return open;
+}
+
+const char *MappedFile::getData() const {
+	return mapping ? (const char *)mapping : buffer.data();
+}
+
+unsigned long MappedFile::getSize() const {
+	return size;
+}
+
+bool MappedFile::readFile(int fd) {
+	char block[READ_BLOCK_SIZE];
+	
+	ssize_t count;
+	while ((count = read(fd, block, sizeof(block))) > 0) buffer.append(block, count);
+	
+	size = buffer.size();
+	return count == 0;
+}
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+
+/*
+ * The contents of a file, mapped in memory instead of copied. A file that
+ * cannot be mapped (like a pipe) is read into a buffer. The data is valid
+ * while the MappedFile exists.
+ */
+class MappedFile {
+	public:
+		MappedFile(const std::string & fileName);
+		~MappedFile();
+		
+		// false if the file could not be opened or read
+		bool isOpen() const;
+		
+		const char *getData() const;
+		unsigned long getSize() const;
+		
+	private:
+		// not copyable, the mapping belongs to one object
+		MappedFile(const MappedFile & other);
+		MappedFile & operator=(const MappedFile & other);
+		
+		bool readFile(int fd);
+		
+		bool open;
+		
+		// NULL if the file is in buffer
+		void *mapping;
+		unsigned long size;
+		
+		std::string buffer;
+};
+
+#endif
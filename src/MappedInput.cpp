@@ -0,0 +1,77 @@
+#include "MappedInput.h"
+
+#include <parser/ParserError.h>
+
+#include <cassert>
+#include <cstring>
+
+MappedInput::MappedInput(const std::string & fileName) : name(fileName), position(0),
+		line(0), column(0), newLine(true) {}
+
+MappedInput::MappedInput(const Pointer<MappedFile> & mappedFile, const std::string & fileName) :
+		file(mappedFile), name(fileName), position(0), line(0), column(0), newLine(true) {}
+
+MappedInput::~MappedInput() {}
+
+char MappedInput::nextChar() {
+	if (!file) open();
+	if (position >= file->getSize()) return 0;
+	
+	char c = file->getData()[position++];
+	
+	if (newLine) {
+		++line;
+		column = 0;
+	}
+	++column;
+	newLine = c == '\n';
+	
+	return c;
+}
+
+std::string MappedInput::getInputName() const {
+	return name;
+}
+
+unsigned int MappedInput::getInputLine() const {
+	return line;
+}
+
+InputLocation MappedInput::getCurrentLocation() const {
+	return InputLocation(name, line, column);
+}
+
+const char *MappedInput::peek(unsigned long & length) {
+	if (!file) open();
+	
+	length = file->getSize() - position;
+	return file->getData() + position;
+}
+
+void MappedInput::skip(unsigned long count) {
+	assert(file && count <= file->getSize() - position);
+	
+	const char *begin = file->getData() + position;
+	const char *end = begin + count;
+	position += count;
+	
+	// a line at a time, like nextChar counts them
+	while (begin != end) {
+		if (newLine) {
+			++line;
+			column = 0;
+		}
+		
+		const char *lineEnd = (const char *)memchr(begin, '\n', end - begin);
+		newLine = lineEnd;
+		lineEnd = lineEnd ? lineEnd + 1 : end;
+		
+		column += lineEnd - begin;
+		begin = lineEnd;
+	}
+}
+
+void MappedInput::open() {
+	file = new MappedFile(name);
+	if (!file->isOpen()) throw ParserError("Cannot read file: " + name);
+}
@@ -0,0 +1,53 @@
+#ifndef MAPPED_INPUT_H
+#define MAPPED_INPUT_H
+
+#include "MappedFile.h"
+
+#include <parser/Input.h>
+#include <parser/Pointer.h>
+
+#include <string>
+
+/*
+ * An Input that reads a file in place from its mapping, the characters
+ * are not copied. Many inputs may read the same MappedFile (like the
+ * includes of a header), each from its start.
+ */
+class MappedInput : public Input {
+	public:
+		// the file is mapped when the first character is read
+		MappedInput(const std::string & fileName);
+		MappedInput(const Pointer<MappedFile> & mappedFile, const std::string & fileName);
+		virtual ~MappedInput();
+		
+		// '\0' at the end, a ParserError if the file cannot be read
+		virtual char nextChar();
+		
+		virtual std::string getInputName() const;
+		virtual unsigned int getInputLine() const;
+		virtual InputLocation getCurrentLocation() const;
+		
+		/*
+		 * The characters not read yet, in place, length is set to their
+		 * count. skip passes count of them as if nextChar read them, so
+		 * the scanners can test them in blocks.
+		 */
+		const char *peek(unsigned long & length);
+		void skip(unsigned long count);
+		
+	private:
+		void open();
+		
+		Pointer<MappedFile> file;
+		std::string name;
+		
+		// the next character to read
+		unsigned long position;
+		
+		// the location of the last character read
+		unsigned int line;
+		unsigned int column;
+		bool newLine;
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "MemReport.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <malloc.h>
+
+#if __cplusplus >= 201103L
+#define THROW_BAD_ALLOC
+#define THROW_NOTHING noexcept
+#else
+#define THROW_BAD_ALLOC throw(std::bad_alloc)
+#define THROW_NOTHING throw()
+#endif
+
+// one more for the allocations out of any phase
+#define MEM_PHASE_COUNT (TimeReport::PHASE_COUNT + 1)
+
+/*
+ * Every block starts with a header holding the bytes counted for it, 0 if it
+ * was allocated before the report was enabled. Its size keeps the blocks
+ * aligned as malloc aligns them.
+ */
+#define BLOCK_HEADER_SIZE 16
+
+/*
+ * The counters are updated with atomic builtins, operator new runs in every
+ * thread and cannot take a lock that allocates.
+ */
+static volatile bool enabled = false;
+
+static __thread int currentPhase = TimeReport::PHASE_COUNT;
+
+static volatile unsigned long long phaseAllocs[MEM_PHASE_COUNT];
+static volatile unsigned long long phaseBytes[MEM_PHASE_COUNT];
+static volatile unsigned long long phasePeak[MEM_PHASE_COUNT];
+
+static volatile long long liveBytes = 0;
+static volatile long long peakBytes = 0;
+
+static volatile unsigned long long consumerCount[MemReport::CONSUMER_COUNT];
+static volatile unsigned long long consumerBytes[MemReport::CONSUMER_COUNT];
+
+static void *allocate(size_t size);
+static void deallocate(void *ptr);
+static void updateMax(volatile unsigned long long *value, unsigned long long candidate);
+static void updateMax(volatile long long *value, long long candidate);
+
+/*****************************************************************************
+ * global operator new and delete
+ *****************************************************************************/
+void *operator new(size_t size) THROW_BAD_ALLOC {
+	void *ptr = allocate(size);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void *operator new[](size_t size) THROW_BAD_ALLOC {
+	void *ptr = allocate(size);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) THROW_NOTHING {
+	return allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) THROW_NOTHING {
+	return allocate(size);
+}
+
+void operator delete(void *ptr) THROW_NOTHING {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr) THROW_NOTHING {
+	deallocate(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) THROW_NOTHING {
+	deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) THROW_NOTHING {
+	deallocate(ptr);
+}
+
+/*****************************************************************************
+ * MemReport
+ *****************************************************************************/
+void MemReport::enable() {
+	enabled = true;
+}
+
+bool MemReport::isEnabled() {
+	return enabled;
+}
+
+TimeReport::Phase MemReport::setPhase(TimeReport::Phase phase) {
+	TimeReport::Phase previous = (TimeReport::Phase)currentPhase;
+	currentPhase = phase;
+	
+	return previous;
+}
+
+void MemReport::addConsumer(Consumer consumer, size_t bytes, unsigned int count) {
+	if (!enabled) return;
+	
+	__sync_fetch_and_add(&consumerCount[consumer], count);
+	__sync_fetch_and_add(&consumerBytes[consumer], bytes);
+}
+
+void MemReport::addParsingTree(ParsingTree::Node *root) {
+	if (!enabled) return;
+	
+	unsigned long long nodes = 0;
+	unsigned long long nodeBytes = 0;
+	unsigned long long tokens = 0;
+	unsigned long long tokenBytes = 0;
+	
+	// the trees are deep, walk them without recursion
+	std::vector<ParsingTree::Node *> stack;
+	stack.push_back(root);
+	
+	while (!stack.empty()) {
+		ParsingTree::Node *node = stack.back();
+		stack.pop_back();
+		
+		if (node->getNodeType() == ParsingTree::NODE_TOKEN) {
+			ParsingTree::Token *token = (ParsingTree::Token *)node;
+			
+			++tokens;
+			tokenBytes += getAllocationSize(token) + token->getToken().capacity();
+		}
+		else {
+			ParsingTree::NonTerminal *nt = (ParsingTree::NonTerminal *)node;
+			const ParsingTree::NodeList & nodeList = nt->getNodeList();
+			
+			++nodes;
+			nodeBytes += getAllocationSize(nt) + nodeList.size() * sizeof(ParsingTree::Node *);
+			
+			stack.insert(stack.end(), nodeList.begin(), nodeList.end());
+		}
+	}
+	
+	addConsumer(PARSING_TREE_NODES, nodeBytes, nodes);
+	addConsumer(TOKENS, tokenBytes, tokens);
+}
+
+size_t MemReport::getAllocationSize(const void *ptr) {
+	return malloc_usable_size((char *)ptr - BLOCK_HEADER_SIZE) - BLOCK_HEADER_SIZE;
+}
+
+void MemReport::showReport(std::ostream & out) {
+	static const char *consumerNames[CONSUMER_COUNT] = {
+		"parsing tree nodes",
+		"tokens",
+		"instructions",
+		"static memory",
+		"preprocessor buffers"
+	};
+	
+	char line[256];
+	
+	out << "Memory report (KB):" << std::endl;
+	sprintf(line, "  %-24s %12s %12s %12s", "phase", "allocations", "allocated", "peak live");
+	out << line << std::endl;
+	
+	for (unsigned int i = 0; i < MEM_PHASE_COUNT; ++i) {
+		if (!phaseAllocs[i]) continue;
+		
+		const char *name = i < TimeReport::PHASE_COUNT
+				? TimeReport::getPhaseName((TimeReport::Phase)i) : "other";
+				
+		sprintf(line, "  %-24s %12llu %12llu %12llu", name, phaseAllocs[i],
+				phaseBytes[i] / 1024, phasePeak[i] / 1024);
+		out << line << std::endl;
+	}
+	
+	sprintf(line, "  %-24s %12s %12s %12llu", "total", "", "",
+			(unsigned long long)peakBytes / 1024);
+	out << line << std::endl;
+	
+	out << std::endl;
+	sprintf(line, "  %-24s %12s %12s", "consumer", "count", "size");
+	out << line << std::endl;
+	
+	for (unsigned int i = 0; i < CONSUMER_COUNT; ++i) {
+		sprintf(line, "  %-24s %12llu %12llu", consumerNames[i], consumerCount[i],
+				consumerBytes[i] / 1024);
+		out << line << std::endl;
+	}
+}
+
+/*****************************************************************************
+ * Auxiliar functions
+ *****************************************************************************/
+static void *allocate(size_t size) {
+	if (size > (size_t)-1 - BLOCK_HEADER_SIZE) return NULL;
+	
+	char *block = (char *)malloc(size + BLOCK_HEADER_SIZE);
+	if (!block) return NULL;
+	
+	size_t counted = 0;
+	
+	if (enabled) {
+		counted = malloc_usable_size(block) - BLOCK_HEADER_SIZE;
+		int phase = currentPhase;
+		
+		__sync_fetch_and_add(&phaseAllocs[phase], 1);
+		__sync_fetch_and_add(&phaseBytes[phase], counted);
+		
+		long long live = __sync_add_and_fetch(&liveBytes, (long long)counted);
+		updateMax(&peakBytes, live);
+		updateMax(&phasePeak[phase], live);
+	}
+	
+	*(size_t *)block = counted;
+	
+	return block + BLOCK_HEADER_SIZE;
+}
+
+static void deallocate(void *ptr) {
+	if (!ptr) return;
+	
+	char *block = (char *)ptr - BLOCK_HEADER_SIZE;
+	
+	// only the blocks allocated while the report was enabled were counted
+	size_t counted = *(size_t *)block;
+	if (counted) __sync_fetch_and_sub(&liveBytes, (long long)counted);
+	
+	free(block);
+}
+
+static void updateMax(volatile unsigned long long *value, unsigned long long candidate) {
+	unsigned long long current = *value;
+	while (candidate > current) {
+		unsigned long long seen = __sync_val_compare_and_swap(value, current, candidate);
+		if (seen == current) break;
+		current = seen;
+	}
+}
+
+static void updateMax(volatile long long *value, long long candidate) {
+	long long current = *value;
+	while (candidate > current) {
+		long long seen = __sync_val_compare_and_swap(value, current, candidate);
+		if (seen == current) break;
+		current = seen;
+	}
+}
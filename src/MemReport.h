@@ -0,0 +1,58 @@
+#ifndef MEM_REPORT_H
+#define MEM_REPORT_H
+
+#include "TimeReport.h"
+
+#include <parser/ParsingTree.h>
+
+#include <cstddef>
+#include <iosfwd>
+
+/*
+ * Allocation accounting (--mem-report).
+ *
+ * The global operator new and delete are replaced, and while the report is
+ * enabled every allocation is counted in the phase (the same phases of the
+ * time report) of the thread doing it. For each phase the report shows the
+ * allocations, the allocated bytes and the peak of live bytes (of the whole
+ * process) while the phase was running.
+ *
+ * The big consumers are counted separately where they are created.
+ */
+class MemReport {
+	public:
+		enum Consumer {
+			PARSING_TREE_NODES = 0,
+			TOKENS,
+			INSTRUCTIONS,
+			STATIC_MEMORY,
+			PREPROCESSOR_BUFFERS,
+			CONSUMER_COUNT
+		};
+		
+		// allocations done before are not counted, nor are their deletes
+		static void enable();
+		static bool isEnabled();
+		
+		/*
+		 * The allocations of the calling thread go to phase from now on.
+		 * Return the previous phase, to be restored when this one ends.
+		 * PHASE_COUNT is used for the allocations out of any phase.
+		 */
+		static TimeReport::Phase setPhase(TimeReport::Phase phase);
+		
+		static void addConsumer(Consumer consumer, size_t bytes, unsigned int count = 1);
+		
+		// count the nodes and tokens of a parsing tree
+		static void addParsingTree(ParsingTree::Node *root);
+		
+		// the real size of a block from operator new
+		static size_t getAllocationSize(const void *ptr);
+		
+		static void showReport(std::ostream & out);
+		
+	private:
+		MemReport();
+};
+
+#endif
@@ -0,0 +1,556 @@
+#include "ObjectFile.h"
+
+#include "vm/ArithmeticInstruction.h"
+#include "vm/BranchInstruction.h"
+#include "vm/CallInstruction.h"
+#include "vm/CopyInstruction.h"
+#include "vm/Instruction.h"
+#include "vm/JumpInstruction.h"
+#include "vm/JumpRegisterInstruction.h"
+#include "vm/LabeledInstruction.h"
+#include "vm/LoadAddrInstruction.h"
+#include "vm/LoadInstruction.h"
+#include "vm/NopInstruction.h"
+#include "vm/NotInstruction.h"
+#include "vm/SetInstruction.h"
+#include "vm/StoreInstruction.h"
+#include "Number.h"
+
+#include <parser/ParserError.h>
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+
+#define OBJECT_MAGIC "UCCO"
+#define OBJECT_MAGIC_SIZE 4
+#define OBJECT_VERSION 1
+
+#define OBJECT_FLAG_RELOCABLE 0x01
+
+// the code is copied from the temporary file to the output in blocks of this size
+#define CODE_COPY_BLOCK_SIZE 65536
+
+enum Opcode {
+	OP_ADD = 0,
+	OP_SUB,
+	OP_MUL,
+	OP_DIV,
+	OP_MOD,
+	OP_AND,
+	OP_OR,
+	OP_XOR,
+	OP_SHIFT_LEFT,
+	OP_SHIFT_RIGHT,
+	OP_LESS_CMP,
+	OP_EQUAL_CMP,
+	OP_NOT_EQUAL_CMP,
+	OP_LOGICAL_AND,
+	OP_LOGICAL_OR,
+	OP_COPY,
+	OP_NOT,
+	OP_SET,
+	OP_LOAD,
+	OP_STORE,
+	OP_LOAD_ADDR,
+	OP_BRANCH,
+	OP_JUMP,
+	OP_JUMP_REGISTER,
+	OP_CALL,
+	OP_NOP,
+	OP_LABELED
+};
+
+enum NumberTag {
+	NUMBER_INT = 0,
+	NUMBER_FLOAT
+};
+
+/*****************************************************************************
+ * ObjectFile::Writer
+ *****************************************************************************/
+ObjectFile::Writer::Writer() : codeSize(0), instructionCount(0) {
+	codeFile = tmpfile();
+	if (!codeFile) throw std::runtime_error("ucc: cannot create a temporary file for the code.");
+}
+
+ObjectFile::Writer::~Writer() {
+	fclose(codeFile);
+}
+
+void ObjectFile::Writer::writeFunction(const InstructionList & instructions) {
+	functionCode.clear();
+	for (InstructionList::const_iterator it = instructions.begin(); it != instructions.end(); ++it) {
+		writeInstruction(*it);
+	}
+	
+	if (!functionCode.empty()) {
+		if (fwrite(&functionCode[0], 1, functionCode.size(), codeFile) != functionCode.size()) {
+			throw std::runtime_error("ucc: cannot write the code to a temporary file.");
+		}
+		codeSize += functionCode.size();
+	}
+	
+	instructionCount += instructions.size();
+}
+
+void ObjectFile::Writer::writeObject(std::ostream & out, const Program::Memory & memory) const {
+	Buffer buf;
+	buf.insert(buf.end(), OBJECT_MAGIC, OBJECT_MAGIC + OBJECT_MAGIC_SIZE);
+	writeInt(buf, OBJECT_VERSION);
+	writeInt(buf, memory.size());
+	writeInt(buf, symbols.size());
+	writeInt(buf, instructionCount);
+	
+	for (SymbolList::const_iterator it = symbols.begin(); it != symbols.end(); ++it) {
+		writeInt(buf, it->size());
+		buf.insert(buf.end(), it->begin(), it->end());
+	}
+	
+	buf.insert(buf.end(), memory.begin(), memory.end());
+	
+	out.write((const char *)&buf[0], buf.size());
+	
+	if (fflush(codeFile) || fseek(codeFile, 0, SEEK_SET)) {
+		throw std::runtime_error("ucc: cannot read the code from a temporary file.");
+	}
+	
+	char block[CODE_COPY_BLOCK_SIZE];
+	for (unsigned long left = codeSize; left > 0;) {
+		size_t count = fread(block, 1, left < sizeof(block) ? left : sizeof(block), codeFile);
+		if (count == 0) throw std::runtime_error("ucc: cannot read the code from a temporary file.");
+		
+		out.write(block, count);
+		left -= count;
+	}
+	
+	// the next function is added after the code
+	fseek(codeFile, 0, SEEK_END);
+}
+
+void ObjectFile::Writer::writeInstruction(const Instruction *inst) {
+	writeByte(functionCode, inst->isRelocable() ? OBJECT_FLAG_RELOCABLE : 0);
+	
+	if (writeArithmetic<AddInstruction>(inst, OP_ADD)) return;
+	if (writeArithmetic<SubInstruction>(inst, OP_SUB)) return;
+	if (writeArithmetic<MulInstruction>(inst, OP_MUL)) return;
+	if (writeArithmetic<DivInstruction>(inst, OP_DIV)) return;
+	if (writeArithmetic<ModInstruction>(inst, OP_MOD)) return;
+	if (writeArithmetic<AndInstruction>(inst, OP_AND)) return;
+	if (writeArithmetic<OrInstruction>(inst, OP_OR)) return;
+	if (writeArithmetic<XorInstruction>(inst, OP_XOR)) return;
+	if (writeArithmetic<ShiftLeftInstruction>(inst, OP_SHIFT_LEFT)) return;
+	if (writeArithmetic<ShiftRightInstruction>(inst, OP_SHIFT_RIGHT)) return;
+	if (writeArithmetic<LessCmpInstruction>(inst, OP_LESS_CMP)) return;
+	if (writeArithmetic<EqualCmpInstruction>(inst, OP_EQUAL_CMP)) return;
+	if (writeArithmetic<NotEqualCmpInstruction>(inst, OP_NOT_EQUAL_CMP)) return;
+	if (writeArithmetic<LogicalAndInstruction>(inst, OP_LOGICAL_AND)) return;
+	if (writeArithmetic<LogicalOrInstruction>(inst, OP_LOGICAL_OR)) return;
+	if (writeArithmetic<CopyInstruction>(inst, OP_COPY)) return;
+	
+	if (const NotInstruction *i = dynamic_cast<const NotInstruction *>(inst)) {
+		writeByte(functionCode, OP_NOT);
+		writeRegister(functionCode, i->getRegisterDst());
+		writeRegister(functionCode, i->getRegisterSrc());
+	}
+	else if (const SetInstruction *i = dynamic_cast<const SetInstruction *>(inst)) {
+		writeByte(functionCode, OP_SET);
+		writeRegister(functionCode, i->getRegister());
+		writeNumber(functionCode, i->getValue());
+	}
+	else if (const LoadInstruction *i = dynamic_cast<const LoadInstruction *>(inst)) {
+		writeByte(functionCode, OP_LOAD);
+		writeRegister(functionCode, i->getRegister());
+		writeRegister(functionCode, i->getBaseRegister());
+		writeInt(functionCode, i->getSize());
+		writeInt(functionCode, i->getOffset());
+	}
+	else if (const StoreInstruction *i = dynamic_cast<const StoreInstruction *>(inst)) {
+		writeByte(functionCode, OP_STORE);
+		writeRegister(functionCode, i->getRegister());
+		writeRegister(functionCode, i->getBaseRegister());
+		writeInt(functionCode, i->getSize());
+		writeInt(functionCode, i->getOffset());
+	}
+	else if (const LoadAddrInstruction *i = dynamic_cast<const LoadAddrInstruction *>(inst)) {
+		writeByte(functionCode, OP_LOAD_ADDR);
+		writeRegister(functionCode, i->getRegister());
+		writeInt(functionCode, getSymbol(i->getLabel()));
+	}
+	else if (const BranchInstruction *i = dynamic_cast<const BranchInstruction *>(inst)) {
+		writeByte(functionCode, OP_BRANCH);
+		writeRegister(functionCode, i->getRegister());
+		writeInt(functionCode, i->getTarget());
+	}
+	else if (const JumpInstruction *i = dynamic_cast<const JumpInstruction *>(inst)) {
+		writeByte(functionCode, OP_JUMP);
+		writeInt(functionCode, i->getTarget());
+	}
+	else if (const JumpRegisterInstruction *i = dynamic_cast<const JumpRegisterInstruction *>(inst)) {
+		writeByte(functionCode, OP_JUMP_REGISTER);
+		writeRegister(functionCode, i->getRegister());
+	}
+	else if (const CallInstruction *i = dynamic_cast<const CallInstruction *>(inst)) {
+		writeByte(functionCode, OP_CALL);
+		writeInt(functionCode, getSymbol(i->getLabel()));
+	}
+	else if (dynamic_cast<const NopInstruction *>(inst)) {
+		writeByte(functionCode, OP_NOP);
+	}
+	else if (const LabeledInstruction *i = dynamic_cast<const LabeledInstruction *>(inst)) {
+		writeByte(functionCode, OP_LABELED);
+		writeInt(functionCode, getSymbol(i->getLabel()));
+		writeInstruction(i->getInstruction());
+	}
+	else assert(false && "Unknown instruction");
+}
+
+template<typename _T>
+bool ObjectFile::Writer::writeArithmetic(const Instruction *inst, unsigned int op) {
+	const _T *i = dynamic_cast<const _T *>(inst);
+	if (!i) return false;
+	
+	writeByte(functionCode, op);
+	writeRegister(functionCode, i->getRegisterDst());
+	writeRegister(functionCode, i->getRegisterSrc1());
+	writeRegister(functionCode, i->getRegisterSrc2());
+	
+	return true;
+}
+
+unsigned int ObjectFile::Writer::getSymbol(const std::string & name) {
+	SymbolMap::iterator it = symbolMap.find(name);
+	if (it != symbolMap.end()) return it->second;
+	
+	unsigned int index = symbols.size();
+	symbols.push_back(name);
+	symbolMap[name] = index;
+	
+	return index;
+}
+
+void ObjectFile::Writer::writeByte(Buffer & buf, unsigned int value) {
+	assert(value <= 0xFF);
+	buf.push_back(value);
+}
+
+void ObjectFile::Writer::writeInt(Buffer & buf, unsigned int value) {
+	for (unsigned int i = 0; i < 4; ++i) buf.push_back((value >> (i * 8)) & 0xFF);
+}
+
+void ObjectFile::Writer::writeLong(Buffer & buf, unsigned long long value) {
+	for (unsigned int i = 0; i < 8; ++i) buf.push_back((value >> (i * 8)) & 0xFF);
+}
+
+void ObjectFile::Writer::writeRegister(Buffer & buf, Register reg) {
+	writeByte(buf, reg);
+}
+
+void ObjectFile::Writer::writeNumber(Buffer & buf, const Number & value) {
+	if (value.isFloat()) {
+		double d = value.floatValue();
+		unsigned long long bits;
+		memcpy(&bits, &d, sizeof(bits));
+		
+		writeByte(buf, NUMBER_FLOAT);
+		writeLong(buf, bits);
+	}
+	else {
+		writeByte(buf, NUMBER_INT);
+		writeLong(buf, value.intValue());
+	}
+}
+
+/*****************************************************************************
+ * ObjectFile::Reader
+ *****************************************************************************/
+class ObjectFile::Reader {
+	public:
+		Reader(const std::string & name, const Buffer & buf);
+		
+		bool atEnd() const;
+		
+		Program *readProgram();
+		
+	private:
+		Instruction *readInstruction();
+		
+		const std::string & readSymbol();
+		
+		unsigned int readByte();
+		unsigned int readInt();
+		unsigned long long readLong();
+		Register readRegister();
+		Number readNumber();
+		
+		void require(unsigned int size);
+		void invalid() const;
+		
+		const std::string & fileName;
+		const Buffer & buffer;
+		unsigned int position;
+		
+		SymbolList symbols;
+};
+
+ObjectFile::Reader::Reader(const std::string & name, const Buffer & buf) : fileName(name),
+		buffer(buf), position(0) {}
+
+bool ObjectFile::Reader::atEnd() const {
+	return position == buffer.size();
+}
+
+Program *ObjectFile::Reader::readProgram() {
+	require(OBJECT_MAGIC_SIZE);
+	if (memcmp(&buffer[position], OBJECT_MAGIC, OBJECT_MAGIC_SIZE)) invalid();
+	position += OBJECT_MAGIC_SIZE;
+	
+	if (readInt() != OBJECT_VERSION) {
+		throw ParserError(fileName + ": unsupported object file version.");
+	}
+	
+	unsigned int memorySize = readInt();
+	unsigned int symbolCount = readInt();
+	unsigned int instructionCount = readInt();
+	
+	symbols.clear();
+	symbols.reserve(symbolCount);
+	for (unsigned int i = 0; i < symbolCount; ++i) {
+		unsigned int len = readInt();
+		require(len);
+		symbols.push_back(std::string(buffer.begin() + position, buffer.begin() + position + len));
+		position += len;
+	}
+	
+	require(memorySize);
+	Program::Memory memory(buffer.begin() + position, buffer.begin() + position + memorySize);
+	position += memorySize;
+	
+	Program::InstructionList instructions;
+	instructions.reserve(instructionCount);
+	
+	try {
+		for (unsigned int i = 0; i < instructionCount; ++i) {
+			instructions.push_back(readInstruction());
+		}
+	}
+	catch (...) {
+		for (Program::InstructionList::iterator it = instructions.begin();
+				it != instructions.end(); ++it) {
+			delete(*it);
+		}
+		throw;
+	}
+	
+	return new Program(memory, instructions);
+}
+
+Instruction *ObjectFile::Reader::readInstruction() {
+	unsigned int flags = readByte();
+	unsigned int op = readByte();
+	
+	Instruction *inst = NULL;
+	
+	switch (op) {
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+		case OP_AND:
+		case OP_OR:
+		case OP_XOR:
+		case OP_SHIFT_LEFT:
+		case OP_SHIFT_RIGHT:
+		case OP_LESS_CMP:
+		case OP_EQUAL_CMP:
+		case OP_NOT_EQUAL_CMP:
+		case OP_LOGICAL_AND:
+		case OP_LOGICAL_OR:
+		case OP_COPY:
+		{
+			Register dst = readRegister();
+			Register src1 = readRegister();
+			Register src2 = readRegister();
+			
+			switch (op) {
+				case OP_ADD: inst = new AddInstruction(dst, src1, src2); break;
+				case OP_SUB: inst = new SubInstruction(dst, src1, src2); break;
+				case OP_MUL: inst = new MulInstruction(dst, src1, src2); break;
+				case OP_DIV: inst = new DivInstruction(dst, src1, src2); break;
+				case OP_MOD: inst = new ModInstruction(dst, src1, src2); break;
+				case OP_AND: inst = new AndInstruction(dst, src1, src2); break;
+				case OP_OR: inst = new OrInstruction(dst, src1, src2); break;
+				case OP_XOR: inst = new XorInstruction(dst, src1, src2); break;
+				case OP_SHIFT_LEFT: inst = new ShiftLeftInstruction(dst, src1, src2); break;
+				case OP_SHIFT_RIGHT: inst = new ShiftRightInstruction(dst, src1, src2); break;
+				case OP_LESS_CMP: inst = new LessCmpInstruction(dst, src1, src2); break;
+				case OP_EQUAL_CMP: inst = new EqualCmpInstruction(dst, src1, src2); break;
+				case OP_NOT_EQUAL_CMP: inst = new NotEqualCmpInstruction(dst, src1, src2); break;
+				case OP_LOGICAL_AND: inst = new LogicalAndInstruction(dst, src1, src2); break;
+				case OP_LOGICAL_OR: inst = new LogicalOrInstruction(dst, src1, src2); break;
+				default: inst = new CopyInstruction(dst, src1, src2); break;
+			}
+			break;
+		}
+		case OP_NOT:
+		{
+			Register dst = readRegister();
+			inst = new NotInstruction(dst, readRegister());
+			break;
+		}
+		case OP_SET:
+		{
+			Register reg = readRegister();
+			inst = new SetInstruction(reg, readNumber());
+			break;
+		}
+		case OP_LOAD:
+		case OP_STORE:
+		{
+			Register reg = readRegister();
+			Register base = readRegister();
+			unsigned int size = readInt();
+			int offset = readInt();
+			
+			if (op == OP_LOAD) inst = new LoadInstruction(reg, base, size, offset);
+			else inst = new StoreInstruction(reg, base, size, offset);
+			break;
+		}
+		case OP_LOAD_ADDR:
+		{
+			Register reg = readRegister();
+			inst = new LoadAddrInstruction(reg, readSymbol());
+			break;
+		}
+		case OP_BRANCH:
+		{
+			Register reg = readRegister();
+			inst = new BranchInstruction(reg, (int)readInt());
+			break;
+		}
+		case OP_JUMP:
+			inst = new JumpInstruction((int)readInt());
+			break;
+		case OP_JUMP_REGISTER:
+			inst = new JumpRegisterInstruction(readRegister());
+			break;
+		case OP_CALL:
+			inst = new CallInstruction(readSymbol());
+			break;
+		case OP_NOP:
+			inst = new NopInstruction();
+			break;
+		case OP_LABELED:
+		{
+			const std::string & label = readSymbol();
+			inst = new LabeledInstruction(label, readInstruction());
+			break;
+		}
+		default:
+			invalid();
+	}
+	
+	if (flags & OBJECT_FLAG_RELOCABLE) inst->setRelocable(true);
+	
+	return inst;
+}
+
+const std::string & ObjectFile::Reader::readSymbol() {
+	unsigned int index = readInt();
+	if (index >= symbols.size()) invalid();
+	
+	return symbols[index];
+}
+
+unsigned int ObjectFile::Reader::readByte() {
+	require(1);
+	return buffer[position++];
+}
+
+unsigned int ObjectFile::Reader::readInt() {
+	require(4);
+	
+	unsigned int value = 0;
+	for (unsigned int i = 0; i < 4; ++i) value |= (unsigned int)buffer[position++] << (i * 8);
+	
+	return value;
+}
+
+unsigned long long ObjectFile::Reader::readLong() {
+	require(8);
+	
+	unsigned long long value = 0;
+	for (unsigned int i = 0; i < 8; ++i) {
+		value |= (unsigned long long)buffer[position++] << (i * 8);
+	}
+	
+	return value;
+}
+
+Register ObjectFile::Reader::readRegister() {
+	return readByte();
+}
+
+Number ObjectFile::Reader::readNumber() {
+	unsigned int tag = readByte();
+	unsigned long long bits = readLong();
+	
+	if (tag == NUMBER_FLOAT) {
+		double d;
+		memcpy(&d, &bits, sizeof(d));
+		return Number(Number::FLOAT, d);
+	}
+	if (tag != NUMBER_INT) invalid();
+	
+	return Number(Number::INT, (RegisterInt)bits);
+}
+
+void ObjectFile::Reader::require(unsigned int size) {
+	if (buffer.size() - position < size) invalid();
+}
+
+void ObjectFile::Reader::invalid() const {
+	throw ParserError(fileName + ": invalid object file.");
+}
+
+/*****************************************************************************
+ * ObjectFile
+ *****************************************************************************/
+ObjectFile::ObjectFile() {}
+
+ObjectFile::~ObjectFile() {}
+
+void ObjectFile::writeProgram(std::ostream & out, const Program *program) {
+	Writer writer;
+	writer.writeFunction(program->getInstructions());
+	writer.writeObject(out, program->getMemory());
+}
+
+ObjectFile::ProgramList ObjectFile::readPrograms(const std::string & fileName) {
+	std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) throw ParserError(fileName + ": cannot open file.");
+	
+	// read the whole file at once, it is decoded from memory
+	in.seekg(0, std::ios::end);
+	Buffer buffer(in.tellg());
+	in.seekg(0, std::ios::beg);
+	if (!buffer.empty()) in.read((char *)&buffer[0], buffer.size());
+	if (!in) throw ParserError(fileName + ": cannot read file.");
+	
+	Reader reader(fileName, buffer);
+	ProgramList programs;
+	
+	try {
+		while (!reader.atEnd()) programs.push_back(reader.readProgram());
+	}
+	catch (...) {
+		for (ProgramList::iterator it = programs.begin(); it != programs.end(); ++it) delete(*it);
+		throw;
+	}
+	
+	return programs;
+}
@@ -0,0 +1,96 @@
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include "compiler/FunctionWriter.h"
+#include "vm/Program.h"
+#include "vm/RegisterUtils.h"
+#include "Number.h"
+
+#include <cstdio>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * Binary object file (.uo), an alternative to the .asm text between the
+ * compile and the link steps that needs no scanning to be read.
+ *
+ * A file is a sequence of objects, one for each compiled program:
+ *   header:       magic "UCCO", format version, then the memory size,
+ *                 the symbol count and the instruction count
+ *   symbols:      length and characters of every label used by the program
+ *   memory:       the static memory image
+ *   instructions: opcode, flags (relocable) and operands of every
+ *                 instruction, labels are stored as symbol indices
+ * All the numbers are little endian.
+ */
+class ObjectFile {
+	private:
+		typedef std::vector<unsigned char> Buffer;
+		typedef std::vector<std::string> SymbolList;
+		typedef std::map<std::string, unsigned int> SymbolMap;
+		
+	public:
+		typedef std::vector<Program *> ProgramList;
+		
+		/*
+		 * Encode the code of a program while it is compiled, one function at
+		 * a time, then write the object once the static memory is complete.
+		 * The code of each function goes to a temporary file as soon as it
+		 * is encoded, so only the largest function is kept in memory.
+		 * Throw a std::runtime_error if the temporary file cannot be used.
+		 */
+		class Writer : public FunctionWriter {
+			public:
+				Writer();
+				virtual ~Writer();
+				
+				virtual void writeFunction(const InstructionList & instructions);
+				
+				// write the object with all the code encoded so far, can be done many times
+				void writeObject(std::ostream & out, const Program::Memory & memory) const;
+				
+			private:
+				// not copyable, the temporary file belongs to one writer
+				Writer(const Writer & other);
+				Writer & operator=(const Writer & other);
+				
+				void writeInstruction(const Instruction *inst);
+				
+				// write the opcode if the instruction has type _T
+				template<typename _T>
+				bool writeArithmetic(const Instruction *inst, unsigned int op);
+				
+				unsigned int getSymbol(const std::string & name);
+				
+				static void writeByte(Buffer & buf, unsigned int value);
+				static void writeInt(Buffer & buf, unsigned int value);
+				static void writeLong(Buffer & buf, unsigned long long value);
+				static void writeRegister(Buffer & buf, Register reg);
+				static void writeNumber(Buffer & buf, const Number & value);
+				
+				SymbolList symbols;
+				SymbolMap symbolMap;
+				
+				// the code of the function being encoded, the buffer is reused
+				Buffer functionCode;
+				
+				FILE *codeFile;
+				unsigned long codeSize;
+				unsigned int instructionCount;
+		};
+		
+		ObjectFile();
+		~ObjectFile();
+		
+		void writeProgram(std::ostream & out, const Program *program);
+		
+		// read all the programs of a file
+		ProgramList readPrograms(const std::string & fileName);
+		
+	private:
+		class Reader;
+};
+
+#endif
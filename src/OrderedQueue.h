@@ -0,0 +1,134 @@
+#ifndef ORDERED_QUEUE_H
+#define ORDERED_QUEUE_H
+
+#include <cassert>
+#include <map>
+
+#include <pthread.h>
+
+/*
+ * Bounded queue between two pipeline stages.
+ *
+ * Every item has an index (0 to count - 1) and the items are popped in index
+ * order, whatever order they were pushed. A producer can be at most capacity
+ * items ahead of the consumer, so the memory held by the queue is bounded.
+ */
+template<typename _T>
+class OrderedQueue {
+	public:
+		OrderedQueue(unsigned int cap, unsigned int cnt);
+		~OrderedQueue();
+		
+		// block while index is too far ahead of the consumer
+		// return false if the queue was cancelled, the item was not added
+		bool push(unsigned int index, const _T & item);
+		
+		// block until the next item is available
+		// return false if the queue was cancelled or all the items were popped
+		bool pop(unsigned int & index, _T & item);
+		
+		// wake up every blocked thread, push and pop will fail from now on
+		void cancel();
+		
+		// remove the items that were pushed but not popped
+		template<typename _Out>
+		void drain(_Out out);
+		
+	private:
+		typedef std::map<unsigned int, _T> ItemMap;
+		
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		
+		ItemMap items;
+		
+		unsigned int capacity;
+		unsigned int count;
+		unsigned int nextIndex;
+		
+		bool cancelled;
+};
+
+template<typename _T>
+OrderedQueue<_T>::OrderedQueue(unsigned int cap, unsigned int cnt) : capacity(cap),
+		count(cnt), nextIndex(0), cancelled(false) {
+		
+	assert(capacity > 0);
+	
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+template<typename _T>
+OrderedQueue<_T>::~OrderedQueue() {
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+template<typename _T>
+bool OrderedQueue<_T>::push(unsigned int index, const _T & item) {
+	assert(index < count);
+	
+	pthread_mutex_lock(&mutex);
+	
+	// the producer with nextIndex is never blocked, so this cannot deadlock
+	while (!cancelled && index >= nextIndex + capacity) pthread_cond_wait(&cond, &mutex);
+	
+	bool result = !cancelled;
+	if (result) {
+		assert(items.find(index) == items.end());
+		items[index] = item;
+		pthread_cond_broadcast(&cond);
+	}
+	
+	pthread_mutex_unlock(&mutex);
+	
+	return result;
+}
+
+template<typename _T>
+bool OrderedQueue<_T>::pop(unsigned int & index, _T & item) {
+	pthread_mutex_lock(&mutex);
+	
+	while (!cancelled && nextIndex < count && items.find(nextIndex) == items.end()) {
+		pthread_cond_wait(&cond, &mutex);
+	}
+	
+	bool result = !cancelled && nextIndex < count;
+	if (result) {
+		typename ItemMap::iterator it = items.find(nextIndex);
+		index = it->first;
+		item = it->second;
+		items.erase(it);
+		
+		++nextIndex;
+		pthread_cond_broadcast(&cond);
+	}
+	
+	pthread_mutex_unlock(&mutex);
+	
+	return result;
+}
+
+template<typename _T>
+void OrderedQueue<_T>::cancel() {
+	pthread_mutex_lock(&mutex);
+	cancelled = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+template<typename _T>
+template<typename _Out>
+void OrderedQueue<_T>::drain(_Out out) {
+	pthread_mutex_lock(&mutex);
+	
+	for (typename ItemMap::iterator it = items.begin(); it != items.end(); ++it) {
+		*out++ = it->second;
+	}
+	items.clear();
+	
+	pthread_mutex_unlock(&mutex);
+}
+
+#endif
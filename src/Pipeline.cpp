@@ -0,0 +1,492 @@
+#include "Pipeline.h"
+
+#include "ArgumentOptions.h"
+#include "CompileCache.h"
+#include "ObjectFile.h"
+#include "TimeReport.h"
+#include "TokenStream.h"
+#include "UccUtils.h"
+
+#include "compiler/Compiler.h"
+#include "linker/Assembler.h"
+#include "preprocessor/PrecompiledHeader.h"
+#include "preprocessor/Preprocessor.h"
+#include "vm/Program.h"
+
+#include <parser/Input.h>
+#include <parser/ParserError.h>
+
+#include <cassert>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+
+/*****************************************************************************
+ * Pipeline::Unit
+ *****************************************************************************/
+Pipeline::Unit::Unit(Input *in) : input(in), tokens(NULL), precompiled(false), program(NULL), code(NULL),
+		name(in->getInputName()), parserError(NULL), error(false) {}
+
+Pipeline::Unit::~Unit() {
+	delete(code);
+	delete(parserError);
+}
+
+void Pipeline::Unit::rethrow() const {
+	assert(error);
+	
+	if (parserError) throw ParserError(*parserError);
+	throw std::runtime_error(errorMessage);
+}
+
+/*****************************************************************************
+ * Pipeline
+ *****************************************************************************/
+Pipeline::Pipeline(const ArgumentOptions & opt) : options(opt), inputs(NULL), nextInput(0),
+		preprocessed(NULL), compiled(NULL), preloadedPreprocessor(NULL), preloadedCompiler(NULL), timeReport(NULL),
+		cache(NULL), precompiledHeader(NULL) {
+		
+	preprocessArg.pipeline = this;
+	preprocessArg.step = PREPROCESS_STEP;
+	compileArg.pipeline = this;
+	compileArg.step = COMPILE_STEP;
+	
+	pthread_mutex_init(&mutex, NULL);
+}
+
+Pipeline::~Pipeline() {
+	pthread_mutex_destroy(&mutex);
+}
+
+Pipeline::ProgramList Pipeline::run(const InputList & inputList) {
+	unsigned int jobs = options.getJobs();
+	
+	inputs = &inputList;
+	nextInput = 0;
+	
+	// read once, all the preprocessor threads share it
+	if (options.getPchFile() && usePreprocessor()) {
+		precompiledHeader = PrecompiledHeader::read(options.getPchFile(), options.getIncludeDirs());
+	}
+	
+	// each step can be up to jobs units ahead of the next one
+	preprocessed = new UnitQueue(jobs, inputList.size());
+	compiled = new UnitQueue(jobs, inputList.size());
+	
+	if (options.getCacheDir() && options.getStep() >= ArgumentOptions::COMPILE) {
+		cache = new CompileCache(options.getCacheDir(), options.getCacheSize());
+	}
+	
+	ProgramList programs;
+	DependencyRuleList dependencies;
+	std::fstream *out = NULL;
+	
+	try {
+		// a step that only hands the units on does not need more than one thread
+		if (!startThreads(&preprocessArg, usePreprocessor() ? jobs : 1)
+				|| !startThreads(&compileArg, useCompiler() ? jobs : 1)) {
+			throw std::runtime_error("ucc: cannot create thread");
+		}
+		
+		if ((options.getStep() == ArgumentOptions::PREPROCESS && !options.isDependenciesOnly())
+				|| options.getStep() == ArgumentOptions::COMPILE) {
+			std::ios::openmode mode = std::ios::out;
+			if (isObjectOutput()) mode |= std::ios::binary;
+			
+			out = new std::fstream(options.getOutputFile(), mode);
+		}
+		
+		unsigned int index;
+		Unit *unit;
+		while (compiled->pop(index, unit)) {
+			try {
+				if (unit->error) unit->rethrow();
+				
+				if (options.isDependencies()) addDependencies(unit, dependencies);
+				output(unit, out, programs);
+			}
+			catch (...) {
+				deleteUnit(unit);
+				throw;
+			}
+			
+			delete(unit);
+		}
+		
+		stopThreads();
+		
+		if (options.isDependencies()) writeDependencies(dependencies);
+	}
+	catch (...) {
+		stopThreads();
+		
+		delete(cache);
+		cache = NULL;
+		
+		delete(precompiledHeader);
+		precompiledHeader = NULL;
+		
+		for (ProgramList::iterator it = programs.begin(); it != programs.end(); ++it) {
+			delete(*it);
+		}
+		
+		// do not leave a partial output behind
+		if (out) {
+			delete(out);
+			remove(options.getOutputFile());
+		}
+		
+		throw;
+	}
+	
+	delete(out);
+	
+	delete(precompiledHeader);
+	precompiledHeader = NULL;
+	
+	if (options.getStep() == ArgumentOptions::CHECK_SYNTAX) std::cout << "OK" << std::endl;
+	
+	if (cache) {
+		cache->flush();
+		if (options.isCacheStats()) cache->showStats(std::cerr);
+		
+		delete(cache);
+		cache = NULL;
+	}
+	else if (options.isCacheStats()) {
+		std::cerr << "ucc: the compilation cache is not enabled." << std::endl;
+	}
+	
+	return programs;
+}
+
+void Pipeline::setPreloaded(Preprocessor *preprocessor, Compiler *compiler) {
+	// it was loaded with the include dirs of another command line
+	if (preprocessor) preprocessor->setIncludeDirs(options.getIncludeDirs());
+	
+	preloadedPreprocessor = preprocessor;
+	preloadedCompiler = compiler;
+}
+
+void Pipeline::setTimeReport(TimeReport *report) {
+	timeReport = report;
+}
+
+void *Pipeline::threadMain(void *arg) {
+	ThreadArg *threadArg = (ThreadArg *)arg;
+	
+	if (threadArg->step == PREPROCESS_STEP) threadArg->pipeline->runPreprocessThread();
+	else threadArg->pipeline->runCompileThread();
+	
+	return NULL;
+}
+
+void Pipeline::runPreprocessThread() {
+	pthread_mutex_lock(&mutex);
+	Preprocessor *preprocessor = preloadedPreprocessor;
+	preloadedPreprocessor = NULL;
+	pthread_mutex_unlock(&mutex);
+	
+	bool ownPreprocessor = !preprocessor;
+	
+	for (;;) {
+		pthread_mutex_lock(&mutex);
+		unsigned int index = nextInput;
+		if (index < inputs->size()) ++nextInput;
+		pthread_mutex_unlock(&mutex);
+		
+		if (index >= inputs->size()) break;
+		
+		Unit *unit = new Unit((*inputs)[index]);
+		if (options.isDependencies()) unit->dependencies.push_back(unit->name);
+		
+		if (usePreprocessor()) {
+			if (!preprocessor) preprocessor = new Preprocessor(options.getIncludeDirs());
+			preprocessor->setTimeReport(timeReport);
+			preprocessor->setPrecompiledHeader(precompiledHeader);
+			preprocessor->setIncludeResolver(&includeResolver);
+			preprocess(*preprocessor, unit);
+		}
+		
+		if (!preprocessed->push(index, unit)) {
+			deleteUnit(unit);
+			break;
+		}
+	}
+	
+	if (ownPreprocessor) delete(preprocessor);
+	else {
+		// it outlives this pipeline
+		preprocessor->setPrecompiledHeader(NULL);
+		preprocessor->setIncludeResolver(NULL);
+	}
+}
+
+void Pipeline::runCompileThread() {
+	pthread_mutex_lock(&mutex);
+	Compiler *compiler = preloadedCompiler;
+	preloadedCompiler = NULL;
+	pthread_mutex_unlock(&mutex);
+	
+	bool ownCompiler = !compiler;
+	
+	unsigned int index;
+	Unit *unit;
+	while (preprocessed->pop(index, unit)) {
+		if (useCompiler() && !unit->error) {
+			if (!compiler) compiler = new Compiler();
+			compiler->setTimeReport(timeReport);
+			compile(*compiler, unit);
+		}
+		
+		if (!compiled->push(index, unit)) {
+			deleteUnit(unit);
+			break;
+		}
+	}
+	
+	if (ownCompiler) delete(compiler);
+}
+
+void Pipeline::preprocess(const Preprocessor & preprocessor, Unit *unit) const {
+	try {
+		FileList *dependencies = options.isDependencies() ? &unit->dependencies : NULL;
+		
+		if (useTokens()) {
+			// the input belongs to the preprocessor scanner now
+			Input *input = unit->input;
+			unit->input = NULL;
+			unit->tokens = preprocessor.preprocessTokens(input, dependencies,
+					options.isSystemDependencies(), &unit->precompiled);
+		}
+		else {
+			unit->input = preprocessor.preprocess(unit->input, dependencies,
+					options.isSystemDependencies());
+		}
+		return;
+	}
+	catch (ParserError & e) {
+		unit->parserError = new ParserError(e);
+	}
+	catch (std::exception & e) {
+		unit->errorMessage = e.what();
+	}
+	
+	// the input may have been consumed by the failed step
+	unit->input = NULL;
+	unit->error = true;
+}
+
+void Pipeline::compile(const Compiler & compiler, Unit *unit) const {
+	try {
+		if (options.getStep() >= ArgumentOptions::COMPILE) {
+			if (cache) {
+				// without the tokens the input is the source file, it is not read for the key
+				unit->key = unit->tokens ? CompileCache::getKey(*unit->tokens) : CompileCache::getFileKey(unit->name);
+				if (!unit->key.empty()) unit->program = cache->load(unit->key);
+			}
+			
+			if (unit->program) {
+				delete(unit->input);
+				delete(unit->tokens);
+			}
+			else {
+				// only the encoded code is kept, not the instructions
+				if (isObjectOutput()) unit->code = new ObjectFile::Writer();
+				
+				if (unit->precompiled && !precompiledHeader->getDeclarations().empty()) {
+					// the declarations of the header are restored instead of parsed
+					unit->program = compiler.compile(unit->tokens, precompiledHeader->getDeclarations(),
+							unit->code);
+				}
+				else if (unit->tokens) unit->program = compiler.compile(unit->tokens, unit->code);
+				else unit->program = compiler.compile(unit->input, unit->code);
+				
+				if (!unit->key.empty()) {
+					if (unit->code) cache->store(unit->key, unit->program, *unit->code);
+					else cache->store(unit->key, unit->program);
+				}
+			}
+		}
+		else if (unit->tokens) compiler.checkSyntax(unit->tokens);
+		else compiler.checkSyntax(unit->input);
+		
+		// the input belongs to the compiler scanner now
+		unit->input = NULL;
+		unit->tokens = NULL;
+		return;
+	}
+	catch (ParserError & e) {
+		unit->parserError = new ParserError(e);
+	}
+	catch (std::exception & e) {
+		unit->errorMessage = e.what();
+	}
+	
+	unit->input = NULL;
+	unit->tokens = NULL;
+	unit->error = true;
+}
+
+void Pipeline::output(Unit *unit, std::ostream *out, ProgramList & programs) const {
+	switch (options.getStep()) {
+		case ArgumentOptions::PREPROCESS:
+			// just dump the input to the output
+			if (out) unit->input->dumpInput(*out);
+			delete(unit->input);
+			unit->input = NULL;
+			break;
+		case ArgumentOptions::CHECK_SYNTAX:
+			break;
+		case ArgumentOptions::COMPILE:
+		{
+			TimeReport::Timer timer(timeReport, unit->name, TimeReport::ASSEMBLY);
+			
+			if (unit->code) unit->code->writeObject(*out, unit->program->getMemory());
+			else if (isObjectOutput()) ObjectFile().writeProgram(*out, unit->program);
+			else *out << Assembler().disassemblyProgram(unit->program);
+			delete(unit->program);
+			unit->program = NULL;
+			break;
+		}
+		default:
+			programs.push_back(unit->program);
+			unit->program = NULL;
+			break;
+	}
+}
+
+static std::string escapeMakeName(const std::string & name) {
+	std::string result;
+	
+	for (std::string::const_iterator it = name.begin(); it != name.end(); ++it) {
+		if (*it == '$') result += '$';
+		else if (*it == ' ' || *it == '#') result += '\\';
+		result += *it;
+	}
+	
+	return result;
+}
+
+void Pipeline::addDependencies(const Unit *unit, DependencyRuleList & rules) const {
+	// the units of one output file share its rule
+	if (rules.empty() || !options.outputDefined()) {
+		rules.push_back(DependencyRule(getDependencyTarget(unit->name), FileList()));
+	}
+	
+	FileList & files = rules.back().second;
+	files.insert(files.end(), unit->dependencies.begin(), unit->dependencies.end());
+}
+
+void Pipeline::writeDependencies(const DependencyRuleList & rules) const {
+	std::string fileName = options.getDependencyFile();
+	
+	std::fstream file;
+	if (!fileName.empty()) {
+		file.open(fileName.c_str(), std::ios::out);
+		if (!file) throw std::runtime_error(std::string("ucc: cannot write ") + fileName);
+	}
+	std::ostream & out = fileName.empty() ? std::cout : file;
+	
+	for (DependencyRuleList::const_iterator rule = rules.begin(); rule != rules.end(); ++rule) {
+		out << escapeMakeName(rule->first) << ":";
+		
+		// a header included by several units is written once
+		std::set<std::string> written;
+		for (FileList::const_iterator it = rule->second.begin(); it != rule->second.end(); ++it) {
+			if (written.insert(*it).second) out << " \\\n  " << escapeMakeName(*it);
+		}
+		out << std::endl;
+	}
+}
+
+std::string Pipeline::getDependencyTarget(const std::string & unitName) const {
+	if (options.outputDefined()) return options.getOutputFile();
+	
+	// without an output file each unit has a rule for its .asm, in the current folder
+	std::string target = unitName;
+	std::string::size_type slash = target.rfind('/');
+	if (slash != std::string::npos) target.erase(0, slash + 1);
+	
+	std::string::size_type dot = target.rfind('.');
+	if (dot != std::string::npos) target.erase(dot);
+	
+	return target + ".asm";
+}
+
+bool Pipeline::usePreprocessor() const {
+	return options.isPreprocess();
+}
+
+bool Pipeline::useCompiler() const {
+	return options.getStep() >= ArgumentOptions::CHECK_SYNTAX;
+}
+
+bool Pipeline::useTokens() const {
+	return useCompiler();
+}
+
+bool Pipeline::isObjectOutput() const {
+	return options.getStep() == ArgumentOptions::COMPILE
+			&& getFileUpperCaseExtension(options.getOutputFile()) == "UO";
+}
+
+bool Pipeline::startThreads(ThreadArg *arg, unsigned int count) {
+	unsigned int created = 0;
+	
+	for (unsigned int i = 0; i < count; ++i) {
+		pthread_t thread;
+		
+		// run with the threads already created
+		if (pthread_create(&thread, NULL, &Pipeline::threadMain, arg)) break;
+		
+		threads.push_back(thread);
+		++created;
+	}
+	
+	return created > 0;
+}
+
+void Pipeline::stopThreads() {
+	if (!preprocessed) return;
+	
+	// once all the units left the pipeline nothing is waiting, cancel is harmless
+	pthread_mutex_lock(&mutex);
+	nextInput = inputs->size();
+	pthread_mutex_unlock(&mutex);
+	
+	preprocessed->cancel();
+	compiled->cancel();
+	
+	for (std::vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it) {
+		pthread_join(*it, NULL);
+	}
+	threads.clear();
+	
+	// the units that were still in the queues
+	UnitList units;
+	preprocessed->drain(std::back_inserter(units));
+	compiled->drain(std::back_inserter(units));
+	
+	for (UnitList::iterator it = units.begin(); it != units.end(); ++it) {
+		deleteUnit(*it);
+	}
+	
+	delete(preprocessed);
+	delete(compiled);
+	preprocessed = NULL;
+	compiled = NULL;
+	
+	inputs = NULL;
+}
+
+void Pipeline::deleteUnit(Unit *unit) const {
+	delete(unit->input);
+	delete(unit->tokens);
+	delete(unit->program);
+	delete(unit);
+}
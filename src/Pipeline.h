@@ -0,0 +1,187 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "ObjectFile.h"
+#include "OrderedQueue.h"
+
+#include "preprocessor/IncludeResolver.h"
+
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+
+class ArgumentOptions;
+class CompileCache;
+class Compiler;
+class Input;
+class ParserError;
+class PrecompiledHeader;
+class Preprocessor;
+class Program;
+class TimeReport;
+class TokenStream;
+
+/*
+ * Take every translation unit through the preprocessor, the compiler and the
+ * output step as soon as the previous step finished with it.
+ *
+ * The preprocessor and the compiler run each in their own threads, the output
+ * (dump, disassembly or the programs to link) is done by the calling thread.
+ * The steps are connected by bounded queues, so only a few units are in
+ * memory at once, and the units leave the pipeline in the input order.
+ *
+ * Each thread loads its own Preprocessor or Compiler. The tables are held by
+ * Pointer, whose reference count is not synchronized, so they are never
+ * handed from one thread to another.
+ */
+class Pipeline {
+	public:
+		typedef std::vector<Input *> InputList;
+		typedef std::vector<Program *> ProgramList;
+		typedef std::vector<std::string> FileList;
+		
+		Pipeline(const ArgumentOptions & opt);
+		~Pipeline();
+		
+		/*
+		 * Run the inputs through the steps selected in the options.
+		 * Return the compiled programs if they are going to be linked,
+		 * otherwise the result is written as the steps finish.
+		 * If some unit fails, the error of the first one (in the input
+		 * order) is thrown, the same error a serial compilation would report.
+		 */
+		ProgramList run(const InputList & inputs);
+		
+		/*
+		 * Use tables already loaded (by ucc --server) instead of loading
+		 * them again. Each one is used by a single thread, the other threads
+		 * still load their own. The pipeline does not delete them.
+		 */
+		void setPreloaded(Preprocessor *preprocessor, Compiler *compiler);
+		
+		// time the phases of every unit
+		void setTimeReport(TimeReport *report);
+		
+	private:
+		struct Unit {
+			Unit(Input *in);
+			~Unit();
+			
+			// throw the error caught while running a step
+			void rethrow() const;
+			
+			Input *input;
+			
+			// the preprocessed code, if it is compiled from the tokens
+			TokenStream *tokens;
+			
+			// the tokens start with the code of the precompiled header
+			bool precompiled;
+			
+			Program *program;
+			
+			// the code of the program, if it was written as it was compiled
+			ObjectFile::Writer *code;
+			
+			std::string name;
+			
+			// key of the unit in the compilation cache, empty if it is not cached
+			std::string key;
+			
+			// the source and the headers it includes, if they are written
+			FileList dependencies;
+			
+			ParserError *parserError;
+			std::string errorMessage;
+			bool error;
+		};
+		typedef std::vector<Unit *> UnitList;
+		typedef OrderedQueue<Unit *> UnitQueue;
+		
+		enum StepType {
+			PREPROCESS_STEP,
+			COMPILE_STEP
+		};
+		
+		struct ThreadArg {
+			Pipeline *pipeline;
+			StepType step;
+		};
+		
+		static void *threadMain(void *arg);
+		
+		void runPreprocessThread();
+		void runCompileThread();
+		
+		// run one step of the unit, catching its errors
+		void preprocess(const Preprocessor & preprocessor, Unit *unit) const;
+		void compile(const Compiler & compiler, Unit *unit) const;
+		
+		// write the result of the unit, the calling thread is the last step
+		void output(Unit *unit, std::ostream *out, ProgramList & programs) const;
+		
+		// a make rule, its target and the files the target depends on
+		typedef std::pair<std::string, FileList> DependencyRule;
+		typedef std::vector<DependencyRule> DependencyRuleList;
+		
+		// add the dependencies of the unit to its rule
+		void addDependencies(const Unit *unit, DependencyRuleList & rules) const;
+		
+		void writeDependencies(const DependencyRuleList & rules) const;
+		
+		// the output file, or the name of the unit with a .asm extension if there is none
+		std::string getDependencyTarget(const std::string & unitName) const;
+		
+		bool usePreprocessor() const;
+		bool useCompiler() const;
+		
+		// hand the tokens of the preprocessor to the compiler, instead of text
+		bool useTokens() const;
+		
+		// with -c, write a binary object instead of assembly if the output is a .uo
+		bool isObjectOutput() const;
+		
+		// start the threads of a step, return false if none could be created
+		bool startThreads(ThreadArg *arg, unsigned int count);
+		
+		// stop all the steps and wait for their threads
+		void stopThreads();
+		
+		void deleteUnit(Unit *unit) const;
+		
+		const ArgumentOptions & options;
+		
+		// the inputs of the current run
+		const InputList *inputs;
+		
+		pthread_mutex_t mutex;
+		unsigned int nextInput;
+		
+		UnitQueue *preprocessed;
+		UnitQueue *compiled;
+		
+		// taken by the first thread of each step
+		Preprocessor *preloadedPreprocessor;
+		Compiler *preloadedCompiler;
+		
+		// NULL if the phases are not timed
+		TimeReport *timeReport;
+		
+		// NULL if the compilation cache is not used
+		CompileCache *cache;
+		
+		// NULL if the inputs do not start from a precompiled header
+		PrecompiledHeader *precompiledHeader;
+		
+		// the include directories are listed once for all the threads
+		IncludeResolver includeResolver;
+		
+		ThreadArg preprocessArg;
+		ThreadArg compileArg;
+		std::vector<pthread_t> threads;
+};
+
+#endif
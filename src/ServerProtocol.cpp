@@ -0,0 +1,253 @@
+#include "ServerProtocol.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_BACKLOG 16
+
+// upper bound of a request, anything larger is not a ucc client
+#define SERVER_MAX_REQUEST (16 * 1024 * 1024)
+
+#define SERVER_ACCEPTED 'A'
+
+static bool setAddress(struct sockaddr_un & addr, const std::string & path);
+static bool writeAll(int fd, const void *buf, size_t size);
+static bool readAll(int fd, void *buf, size_t size);
+static void appendInt(std::string & buf, unsigned int value);
+static bool extractInt(const std::string & buf, size_t & pos, unsigned int & value);
+static void appendString(std::string & buf, const std::string & str);
+static bool extractString(const std::string & buf, size_t & pos, std::string & str);
+
+int connectServer(const std::string & path) {
+	struct sockaddr_un addr;
+	if (!setAddress(addr, path)) return -1;
+	
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) return -1;
+	
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr))) {
+		close(sock);
+		return -1;
+	}
+	
+	return sock;
+}
+
+int listenServer(const std::string & path) {
+	struct sockaddr_un addr;
+	if (!setAddress(addr, path)) return -1;
+	
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) return -1;
+	
+	// a socket left by a server that did not exit cleanly, but not one in use
+	struct stat st;
+	if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+		int running = connectServer(path);
+		if (running >= 0) {
+			close(running);
+			close(sock);
+			errno = EADDRINUSE;
+			return -1;
+		}
+		
+		unlink(path.c_str());
+	}
+	
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) || listen(sock, SERVER_BACKLOG)) {
+		close(sock);
+		return -1;
+	}
+	
+	return sock;
+}
+
+bool sendServerRequest(int sock, const ServerRequest & request) {
+	std::string payload;
+	appendString(payload, request.workingDir);
+	appendInt(payload, request.fileModeMask);
+	
+	appendInt(payload, request.environment.size());
+	for (ServerRequest::EnvironmentList::const_iterator it = request.environment.begin();
+			it != request.environment.end(); ++it) {
+		appendString(payload, *it);
+	}
+	
+	for (ServerRequest::ArgumentList::const_iterator it = request.arguments.begin();
+			it != request.arguments.end(); ++it) {
+		appendString(payload, *it);
+	}
+	
+	unsigned int size = payload.size();
+	
+	// the descriptors go with the size, the payload follows
+	struct iovec iov;
+	iov.iov_base = &size;
+	iov.iov_len = sizeof(size);
+	
+	char control[CMSG_SPACE(sizeof(request.fds))];
+	memset(control, 0, sizeof(control));
+	
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+	
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(request.fds));
+	memcpy(CMSG_DATA(cmsg), request.fds, sizeof(request.fds));
+	
+	if (sendmsg(sock, &msg, MSG_NOSIGNAL) != sizeof(size)) return false;
+	
+	return writeAll(sock, payload.data(), payload.size());
+}
+
+bool receiveServerRequest(int sock, ServerRequest & request) {
+	unsigned int size;
+	
+	struct iovec iov;
+	iov.iov_base = &size;
+	iov.iov_len = sizeof(size);
+	
+	char control[CMSG_SPACE(sizeof(request.fds))];
+	
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+	
+	if (recvmsg(sock, &msg, 0) != sizeof(size)) return false;
+	
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(request.fds))) {
+		return false;
+	}
+	memcpy(request.fds, CMSG_DATA(cmsg), sizeof(request.fds));
+	
+	if (size > SERVER_MAX_REQUEST) return false;
+	
+	std::string payload(size, '\0');
+	if (size && !readAll(sock, &payload[0], size)) return false;
+	
+	size_t pos = 0;
+	if (!extractString(payload, pos, request.workingDir)) return false;
+	if (!extractInt(payload, pos, request.fileModeMask)) return false;
+	
+	unsigned int envCount;
+	if (!extractInt(payload, pos, envCount)) return false;
+	
+	request.environment.clear();
+	for (unsigned int i = 0; i < envCount; ++i) {
+		std::string var;
+		if (!extractString(payload, pos, var)) return false;
+		request.environment.push_back(var);
+	}
+	
+	request.arguments.clear();
+	while (pos < payload.size()) {
+		std::string arg;
+		if (!extractString(payload, pos, arg)) return false;
+		request.arguments.push_back(arg);
+	}
+	
+	return true;
+}
+
+bool sendServerAccepted(int sock) {
+	char accepted = SERVER_ACCEPTED;
+	return writeAll(sock, &accepted, sizeof(accepted));
+}
+
+bool receiveServerAccepted(int sock) {
+	char accepted;
+	return readAll(sock, &accepted, sizeof(accepted)) && accepted == SERVER_ACCEPTED;
+}
+
+bool sendServerStatus(int sock, int status) {
+	return writeAll(sock, &status, sizeof(status));
+}
+
+bool receiveServerStatus(int sock, int & status) {
+	return readAll(sock, &status, sizeof(status));
+}
+
+static bool setAddress(struct sockaddr_un & addr, const std::string & path) {
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	
+	if (path.size() >= sizeof(addr.sun_path)) return false;
+	strcpy(addr.sun_path, path.c_str());
+	
+	return true;
+}
+
+static bool writeAll(int fd, const void *buf, size_t size) {
+	const char *p = (const char *)buf;
+	
+	// a client that went away is an error, not a SIGPIPE
+	while (size) {
+		ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+		if (n <= 0) return false;
+		
+		p += n;
+		size -= n;
+	}
+	
+	return true;
+}
+
+static bool readAll(int fd, void *buf, size_t size) {
+	char *p = (char *)buf;
+	
+	while (size) {
+		ssize_t n = read(fd, p, size);
+		if (n <= 0) return false;
+		
+		p += n;
+		size -= n;
+	}
+	
+	return true;
+}
+
+static void appendInt(std::string & buf, unsigned int value) {
+	buf.append((const char *)&value, sizeof(value));
+}
+
+static bool extractInt(const std::string & buf, size_t & pos, unsigned int & value) {
+	if (buf.size() - pos < sizeof(value)) return false;
+	
+	memcpy(&value, buf.data() + pos, sizeof(value));
+	pos += sizeof(value);
+	
+	return true;
+}
+
+static void appendString(std::string & buf, const std::string & str) {
+	appendInt(buf, str.size());
+	buf.append(str);
+}
+
+static bool extractString(const std::string & buf, size_t & pos, std::string & str) {
+	unsigned int len;
+	if (!extractInt(buf, pos, len)) return false;
+	
+	if (buf.size() - pos < len) return false;
+	
+	str = buf.substr(pos, len);
+	pos += len;
+	
+	return true;
+}
@@ -0,0 +1,48 @@
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <string>
+#include <vector>
+
+/*
+ * Messages between ucc --server and its clients, over a Unix socket.
+ *
+ * request:  the client stdin, stdout and stderr (passed as SCM_RIGHTS), the
+ *           client working directory, umask, environment and the command
+ *           line arguments
+ * accepted: sent by the server before the compilation starts, a client that
+ *           did not get it can compile by itself
+ * response: the exit status of the compilation
+ */
+struct ServerRequest {
+	typedef std::vector<std::string> ArgumentList;
+	typedef std::vector<std::string> EnvironmentList;
+	
+	int fds[3];
+	std::string workingDir;
+	unsigned int fileModeMask;
+	
+	// NAME=VALUE, as in environ
+	EnvironmentList environment;
+	
+	ArgumentList arguments;
+};
+
+// return the connected socket, or -1 if there is no server at path
+int connectServer(const std::string & path);
+
+/*
+ * Return the listening socket, or -1 on error. If a server already
+ * answers at path, errno is EADDRINUSE.
+ */
+int listenServer(const std::string & path);
+
+// all the functions return false if the connection failed
+bool sendServerRequest(int sock, const ServerRequest & request);
+bool receiveServerRequest(int sock, ServerRequest & request);
+bool sendServerAccepted(int sock);
+bool receiveServerAccepted(int sock);
+bool sendServerStatus(int sock, int status);
+bool receiveServerStatus(int sock, int & status);
+
+#endif
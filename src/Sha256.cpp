@@ -0,0 +1,129 @@
+#include "Sha256.h"
+
+#include <cstdio>
+#include <cstring>
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const unsigned int ROUND_CONSTANTS[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+Sha256::Sha256() : bufferSize(0), totalSize(0) {
+	state[0] = 0x6a09e667;
+	state[1] = 0xbb67ae85;
+	state[2] = 0x3c6ef372;
+	state[3] = 0xa54ff53a;
+	state[4] = 0x510e527f;
+	state[5] = 0x9b05688c;
+	state[6] = 0x1f83d9ab;
+	state[7] = 0x5be0cd19;
+}
+
+void Sha256::update(const char *data, unsigned long size) {
+	const unsigned char *bytes = (const unsigned char *)data;
+	totalSize += size;
+	
+	if (bufferSize > 0) {
+		unsigned long count = 64 - bufferSize < size ? 64 - bufferSize : size;
+		memcpy(buffer + bufferSize, bytes, count);
+		bufferSize += count;
+		bytes += count;
+		size -= count;
+		
+		if (bufferSize < 64) return;
+		
+		processBlock(buffer);
+		bufferSize = 0;
+	}
+	
+	// the whole blocks are read from data, without copying them
+	for (; size >= 64; bytes += 64, size -= 64) processBlock(bytes);
+	
+	memcpy(buffer, bytes, size);
+	bufferSize = size;
+}
+
+void Sha256::update(const std::string & data) {
+	update(data.data(), data.size());
+}
+
+std::string Sha256::getHexDigest() {
+	unsigned long long bits = totalSize * 8;
+	
+	// a 1 bit, zeros up to 56 bytes in the last block and the size in bits
+	unsigned char padding[72];
+	unsigned int padSize = (bufferSize < 56 ? 56 : 120) - bufferSize;
+	memset(padding, 0, sizeof(padding));
+	padding[0] = 0x80;
+	for (unsigned int i = 0; i < 8; ++i) padding[padSize + i] = (bits >> (56 - i * 8)) & 0xFF;
+	
+	update((const char *)padding, padSize + 8);
+	
+	std::string result;
+	for (unsigned int i = 0; i < 8; ++i) {
+		char hex[9];
+		sprintf(hex, "%08x", state[i]);
+		result += hex;
+	}
+	
+	return result;
+}
+
+void Sha256::processBlock(const unsigned char *block) {
+	unsigned int w[64];
+	
+	for (unsigned int i = 0; i < 16; ++i) {
+		w[i] = (unsigned int)block[i * 4] << 24 | (unsigned int)block[i * 4 + 1] << 16
+				| (unsigned int)block[i * 4 + 2] << 8 | (unsigned int)block[i * 4 + 3];
+	}
+	
+	for (unsigned int i = 16; i < 64; ++i) {
+		unsigned int s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		unsigned int s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+	
+	unsigned int a = state[0];
+	unsigned int b = state[1];
+	unsigned int c = state[2];
+	unsigned int d = state[3];
+	unsigned int e = state[4];
+	unsigned int f = state[5];
+	unsigned int g = state[6];
+	unsigned int h = state[7];
+	
+	for (unsigned int i = 0; i < 64; ++i) {
+		unsigned int s1 = ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25);
+		unsigned int ch = (e & f) ^ (~e & g);
+		unsigned int t1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+		unsigned int s0 = ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22);
+		unsigned int maj = (a & b) ^ (a & c) ^ (b & c);
+		unsigned int t2 = s0 + maj;
+		
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
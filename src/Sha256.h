@@ -0,0 +1,32 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <string>
+
+/*
+ * SHA-256 digest (FIPS 180-4) of the data given to update, in as many parts
+ * as wanted.
+ */
+class Sha256 {
+	public:
+		Sha256();
+		
+		void update(const char *data, unsigned long size);
+		void update(const std::string & data);
+		
+		// the digest in hexadecimal, no more data can be added after it
+		std::string getHexDigest();
+		
+	private:
+		void processBlock(const unsigned char *block);
+		
+		unsigned int state[8];
+		
+		// the data that did not fill a block yet
+		unsigned char buffer[64];
+		unsigned int bufferSize;
+		
+		unsigned long long totalSize;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "TimeReport.h"
+
+#include "MemReport.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include <time.h>
+
+/*****************************************************************************
+ * TimeReport::Timer
+ *****************************************************************************/
+TimeReport::Timer::Timer(TimeReport *rep, const std::string & fileName, Phase ph) : report(rep),
+		phase(ph), wallStart(0.0), cpuStart(0.0) {
+	
+	previousMemPhase = MemReport::setPhase(phase);
+	
+	if (report) {
+		file = fileName;
+		wallStart = getWallTime();
+		cpuStart = getCpuTime();
+	}
+}
+
+TimeReport::Timer::~Timer() {
+	if (report) report->add(file, phase, getWallTime() - wallStart, getCpuTime() - cpuStart);
+	
+	MemReport::setPhase(previousMemPhase);
+}
+
+/*****************************************************************************
+ * TimeReport::Times
+ *****************************************************************************/
+TimeReport::Times::Times() {
+	for (unsigned int i = 0; i < PHASE_COUNT; ++i) {
+		wall[i] = 0.0;
+		cpu[i] = 0.0;
+		used[i] = false;
+	}
+}
+
+/*****************************************************************************
+ * TimeReport
+ *****************************************************************************/
+TimeReport::TimeReport() {
+	pthread_mutex_init(&mutex, NULL);
+}
+
+TimeReport::~TimeReport() {
+	pthread_mutex_destroy(&mutex);
+}
+
+void TimeReport::add(const std::string & file, Phase phase, double wall, double cpu) {
+	pthread_mutex_lock(&mutex);
+	
+	TimesMap::iterator it = times.find(file);
+	if (it == times.end()) {
+		files.push_back(file);
+		it = times.insert(std::make_pair(file, Times())).first;
+	}
+	
+	// a phase can run more than once for a file (e.g. the assembly of each program)
+	it->second.wall[phase] += wall;
+	it->second.cpu[phase] += cpu;
+	it->second.used[phase] = true;
+	
+	pthread_mutex_unlock(&mutex);
+}
+
+void TimeReport::showReport(std::ostream & out) const {
+	char line[256];
+	
+	Times total;
+	
+	out << "Time report (ms):" << std::endl;
+	sprintf(line, "  %-32s %-20s %10s %10s", "file", "phase", "wall", "cpu");
+	out << line << std::endl;
+	
+	for (FileList::const_iterator it = files.begin(); it != files.end(); ++it) {
+		const Times & t = times.find(*it)->second;
+		
+		for (unsigned int i = 0; i < PHASE_COUNT; ++i) {
+			if (!t.used[i]) continue;
+			
+			sprintf(line, "  %-32s %-20s %10.3f %10.3f", it->c_str(), getPhaseName((Phase)i),
+					t.wall[i] * 1000.0, t.cpu[i] * 1000.0);
+			out << line << std::endl;
+			
+			total.wall[i] += t.wall[i];
+			total.cpu[i] += t.cpu[i];
+			total.used[i] = true;
+		}
+	}
+	
+	for (unsigned int i = 0; i < PHASE_COUNT; ++i) {
+		if (!total.used[i]) continue;
+		
+		sprintf(line, "  %-32s %-20s %10.3f %10.3f", "total", getPhaseName((Phase)i),
+				total.wall[i] * 1000.0, total.cpu[i] * 1000.0);
+		out << line << std::endl;
+	}
+}
+
+void TimeReport::showJsonReport(std::ostream & out) const {
+	char value[64];
+	
+	// times in seconds
+	out << "{\"files\": [";
+	for (FileList::const_iterator it = files.begin(); it != files.end(); ++it) {
+		const Times & t = times.find(*it)->second;
+		
+		if (it != files.begin()) out << ", ";
+		out << "{\"file\": \"";
+		
+		for (std::string::const_iterator c = it->begin(); c != it->end(); ++c) {
+			if (*c == '"' || *c == '\\') out << '\\' << *c;
+			else if ((unsigned char)*c < 0x20) {
+				sprintf(value, "\\u%04x", (unsigned char)*c);
+				out << value;
+			}
+			else out << *c;
+		}
+		
+		out << "\", \"phases\": {";
+		
+		bool first = true;
+		for (unsigned int i = 0; i < PHASE_COUNT; ++i) {
+			if (!t.used[i]) continue;
+			
+			if (!first) out << ", ";
+			first = false;
+			
+			sprintf(value, "{\"wall\": %.6f, \"cpu\": %.6f}", t.wall[i], t.cpu[i]);
+			out << "\"" << getPhaseKey((Phase)i) << "\": " << value;
+		}
+		
+		out << "}}";
+	}
+	out << "]}" << std::endl;
+}
+
+const char *TimeReport::getPhaseName(Phase phase) {
+	switch (phase) {
+		case PREPROCESS: return "preprocess";
+		case PARSE: return "parse";
+		case CODE_GENERATION: return "code generation";
+		case ASSEMBLY: return "assembly";
+		case LINK: return "link";
+		case EXECUTION: return "execution";
+		default: return "";
+	}
+}
+
+const char *TimeReport::getPhaseKey(Phase phase) {
+	switch (phase) {
+		case PREPROCESS: return "preprocess";
+		case PARSE: return "parse";
+		case CODE_GENERATION: return "codeGeneration";
+		case ASSEMBLY: return "assembly";
+		case LINK: return "link";
+		case EXECUTION: return "execution";
+		default: return "";
+	}
+}
+
+double TimeReport::getWallTime() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+double TimeReport::getCpuTime() {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,82 @@
+#ifndef TIME_REPORT_H
+#define TIME_REPORT_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+/*
+ * Wall and CPU time of each phase, for each input file (--time-report).
+ *
+ * The CPU time is the one of the thread running the phase, so phases running
+ * in parallel in the pipeline are not counted twice.
+ */
+class TimeReport {
+	public:
+		enum Phase {
+			PREPROCESS = 0,
+			PARSE,
+			CODE_GENERATION,
+			ASSEMBLY,
+			LINK,
+			EXECUTION,
+			PHASE_COUNT
+		};
+		
+		/*
+		 * Measure the phase from the construction to the destruction.
+		 * The time is not measured if the report is NULL, but the
+		 * allocations still go to the phase for the memory report.
+		 */
+		class Timer {
+			public:
+				Timer(TimeReport *rep, const std::string & fileName, Phase ph);
+				~Timer();
+				
+			private:
+				TimeReport *report;
+				std::string file;
+				Phase phase;
+				Phase previousMemPhase;
+				
+				double wallStart;
+				double cpuStart;
+		};
+		
+		TimeReport();
+		~TimeReport();
+		
+		void add(const std::string & file, Phase phase, double wall, double cpu);
+		
+		void showReport(std::ostream & out) const;
+		void showJsonReport(std::ostream & out) const;
+		
+		static const char *getPhaseName(Phase phase);
+		
+	private:
+		struct Times {
+			Times();
+			
+			double wall[PHASE_COUNT];
+			double cpu[PHASE_COUNT];
+			bool used[PHASE_COUNT];
+		};
+		typedef std::map<std::string, Times> TimesMap;
+		typedef std::vector<std::string> FileList;
+		
+		static const char *getPhaseKey(Phase phase);
+		
+		static double getWallTime();
+		static double getCpuTime();
+		
+		// in the order they were first reported
+		FileList files;
+		TimesMap times;
+		
+		pthread_mutex_t mutex;
+};
+
+#endif
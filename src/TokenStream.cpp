@@ -0,0 +1,76 @@
+#include "TokenStream.h"
+
+#include "UccDefs.h"
+
+#include <cassert>
+#include <ostream>
+#include <utility>
+
+TokenStream::TokenStream(const std::string & n) : name(n) {}
+
+TokenStream::~TokenStream() {}
+
+const std::string & TokenStream::getName() const {
+	return name;
+}
+
+void TokenStream::addToken(const std::string & tok, const std::string & fileName,
+		unsigned int line, unsigned int column) {
+		
+	Token token;
+	token.offset = text.size();
+	token.length = tok.size();
+	token.line = line;
+	token.column = column;
+	
+	// the tokens come in long runs of the same file
+	if (!tokens.empty() && files[tokens.back().file] == fileName) token.file = tokens.back().file;
+	else {
+		FileIndex::iterator it = fileIndex.find(fileName);
+		if (it == fileIndex.end()) {
+			it = fileIndex.insert(std::make_pair(fileName, (unsigned int)files.size())).first;
+			files.push_back(fileName);
+		}
+		token.file = it->second;
+	}
+	
+	text += tok;
+	tokens.push_back(token);
+}
+
+void TokenStream::append(const TokenStream & other) {
+	text.reserve(text.size() + other.text.size());
+	tokens.reserve(tokens.size() + other.tokens.size());
+	
+	for (TokenList::const_iterator it = other.tokens.begin(); it != other.tokens.end(); ++it) {
+		addToken(other.getText(*it), other.getFileName(*it), it->line, it->column);
+	}
+}
+
+unsigned int TokenStream::size() const {
+	return tokens.size();
+}
+
+const TokenStream::Token & TokenStream::getToken(unsigned int index) const {
+	assert(index < tokens.size());
+	return tokens[index];
+}
+
+std::string TokenStream::getText(const Token & token) const {
+	return text.substr(token.offset, token.length);
+}
+
+const std::string & TokenStream::getFileName(const Token & token) const {
+	return files[token.file];
+}
+
+void TokenStream::dump(std::ostream & out) const {
+	for (TokenList::const_iterator it = tokens.begin(); it != tokens.end(); ++it) {
+		if (it != tokens.begin()) {
+			TokenList::const_iterator prev = it - 1;
+			out << (prev->file != it->file || prev->line != it->line ? '\n' : DELIMITER);
+		}
+		out.write(text.data() + it->offset, it->length);
+	}
+	out << '\n';
+}
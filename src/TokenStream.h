@@ -0,0 +1,62 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * The code of a preprocessed translation unit as its list of tokens, each
+ * with the file and line it came from. The compiler scanner reads it instead
+ * of lexing the code again (see CScanner).
+ */
+class TokenStream {
+	public:
+		struct Token {
+			// the text of the token is at offset in the text of the stream
+			unsigned int offset;
+			unsigned int length;
+			
+			unsigned int file;
+			unsigned int line;
+			unsigned int column;
+		};
+		
+		TokenStream(const std::string & n);
+		~TokenStream();
+		
+		// the translation unit
+		const std::string & getName() const;
+		
+		void addToken(const std::string & tok, const std::string & fileName,
+				unsigned int line, unsigned int column);
+				
+		// add all the tokens of other after the tokens of this stream
+		void append(const TokenStream & other);
+				
+		unsigned int size() const;
+		const Token & getToken(unsigned int index) const;
+		
+		std::string getText(const Token & token) const;
+		const std::string & getFileName(const Token & token) const;
+		
+		// write the code as text, a line for each line the tokens came from
+		void dump(std::ostream & out) const;
+		
+	private:
+		typedef std::vector<Token> TokenList;
+		typedef std::vector<std::string> FileList;
+		typedef std::map<std::string, unsigned int> FileIndex;
+		
+		std::string name;
+		
+		// the text of all the tokens, one after the other
+		std::string text;
+		TokenList tokens;
+		
+		FileList files;
+		FileIndex fileIndex;
+};
+
+#endif
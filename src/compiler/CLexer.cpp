@@ -0,0 +1,427 @@
+#include "compiler/CLexer.h"
+
+#include "CharClass.h"
+#include "CParserBuffer.h"
+#include "MappedInput.h"
+
+#include <parser/Input.h>
+#include <parser/ParserError.h>
+
+#include <algorithm>
+#include <cstring>
+
+struct TokenKind {
+	const char *text;
+	unsigned int id;
+};
+
+// the keywords and the punctuators, sorted by text
+static const TokenKind tokenKinds[] = {
+	{"!", CPARSERBUFFER_TOKEN_NOT},
+	{"!=", CPARSERBUFFER_TOKEN_NE_OP},
+	{"%", CPARSERBUFFER_TOKEN_MOD},
+	{"%=", CPARSERBUFFER_TOKEN_MOD_ASSIGN},
+	{"&", CPARSERBUFFER_TOKEN_AND},
+	{"&&", CPARSERBUFFER_TOKEN_AND_OP},
+	{"&=", CPARSERBUFFER_TOKEN_AND_ASSIGN},
+	{"(", CPARSERBUFFER_TOKEN_P_OPEN},
+	{")", CPARSERBUFFER_TOKEN_P_CLOSE},
+	{"*", CPARSERBUFFER_TOKEN_MUL},
+	{"*=", CPARSERBUFFER_TOKEN_MUL_ASSIGN},
+	{"+", CPARSERBUFFER_TOKEN_PLUS_SIG},
+	{"++", CPARSERBUFFER_TOKEN_INC_OP},
+	{"+=", CPARSERBUFFER_TOKEN_ADD_ASSIGN},
+	{",", CPARSERBUFFER_TOKEN_COMMA},
+	{"-", CPARSERBUFFER_TOKEN_LESS_SIG},
+	{"--", CPARSERBUFFER_TOKEN_DEC_OP},
+	{"-=", CPARSERBUFFER_TOKEN_SUB_ASSIGN},
+	{"->", CPARSERBUFFER_TOKEN_PTR_OP},
+	{".", CPARSERBUFFER_TOKEN_DOT},
+	{"...", CPARSERBUFFER_TOKEN_ELLIPSIS},
+	{"/", CPARSERBUFFER_TOKEN_DIV},
+	{"/=", CPARSERBUFFER_TOKEN_DIV_ASSIGN},
+	{":", CPARSERBUFFER_TOKEN_COLUMN},
+	{":>", CPARSERBUFFER_TOKEN_B_CLOSE},
+	{";", CPARSERBUFFER_TOKEN_INST_END},
+	{"<", CPARSERBUFFER_TOKEN_LESS},
+	{"<:", CPARSERBUFFER_TOKEN_B_OPEN},
+	{"<<", CPARSERBUFFER_TOKEN_LEFT_OP},
+	{"<<=", CPARSERBUFFER_TOKEN_LEFT_ASSIGN},
+	{"<=", CPARSERBUFFER_TOKEN_LE_OP},
+	{"=", CPARSERBUFFER_TOKEN_EQ},
+	{"==", CPARSERBUFFER_TOKEN_EQ_OP},
+	{">", CPARSERBUFFER_TOKEN_GREATER},
+	{">=", CPARSERBUFFER_TOKEN_GE_OP},
+	{">>", CPARSERBUFFER_TOKEN_RIGHT_OP},
+	{">>=", CPARSERBUFFER_TOKEN_RIGHT_ASSIGN},
+	{"?", CPARSERBUFFER_TOKEN_QUESTION},
+	{"[", CPARSERBUFFER_TOKEN_B_OPEN},
+	{"]", CPARSERBUFFER_TOKEN_B_CLOSE},
+	{"^", CPARSERBUFFER_TOKEN_XOR},
+	{"^=", CPARSERBUFFER_TOKEN_XOR_ASSIGN},
+	{"auto", CPARSERBUFFER_TOKEN_AUTO},
+	{"break", CPARSERBUFFER_TOKEN_BREAK},
+	{"case", CPARSERBUFFER_TOKEN_CASE},
+	{"char", CPARSERBUFFER_TOKEN_CHAR},
+	{"const", CPARSERBUFFER_TOKEN_CONST},
+	{"continue", CPARSERBUFFER_TOKEN_CONTINUE},
+	{"default", CPARSERBUFFER_TOKEN_DEFAULT},
+	{"do", CPARSERBUFFER_TOKEN_DO},
+	{"double", CPARSERBUFFER_TOKEN_DOUBLE},
+	{"else", CPARSERBUFFER_TOKEN_ELSE},
+	{"enum", CPARSERBUFFER_TOKEN_ENUM},
+	{"extern", CPARSERBUFFER_TOKEN_EXTERN},
+	{"float", CPARSERBUFFER_TOKEN_FLOAT},
+	{"for", CPARSERBUFFER_TOKEN_FOR},
+	{"goto", CPARSERBUFFER_TOKEN_GOTO},
+	{"if", CPARSERBUFFER_TOKEN_IF},
+	{"int", CPARSERBUFFER_TOKEN_INT},
+	{"long", CPARSERBUFFER_TOKEN_LONG},
+	{"register", CPARSERBUFFER_TOKEN_REGISTER},
+	{"return", CPARSERBUFFER_TOKEN_RETURN},
+	{"short", CPARSERBUFFER_TOKEN_SHORT},
+	{"signed", CPARSERBUFFER_TOKEN_SIGNED},
+	{"sizeof", CPARSERBUFFER_TOKEN_SIZEOF},
+	{"static", CPARSERBUFFER_TOKEN_STATIC},
+	{"struct", CPARSERBUFFER_TOKEN_STRUCT},
+	{"switch", CPARSERBUFFER_TOKEN_SWITCH},
+	{"typedef", CPARSERBUFFER_TOKEN_TYPEDEF},
+	{"union", CPARSERBUFFER_TOKEN_UNION},
+	{"unsigned", CPARSERBUFFER_TOKEN_UNSIGNED},
+	{"void", CPARSERBUFFER_TOKEN_VOID},
+	{"volatile", CPARSERBUFFER_TOKEN_VOLATILE},
+	{"while", CPARSERBUFFER_TOKEN_WHILE},
+	{"{", CPARSERBUFFER_TOKEN_BEGIN},
+	{"|", CPARSERBUFFER_TOKEN_OR},
+	{"|=", CPARSERBUFFER_TOKEN_OR_ASSIGN},
+	{"||", CPARSERBUFFER_TOKEN_OR_OP},
+	{"}", CPARSERBUFFER_TOKEN_END},
+	{"~", CPARSERBUFFER_TOKEN_NEG},
+};
+
+static bool compareTokenKind(const TokenKind & kind, const char *text);
+
+// the first '*' from begin on, end if there is none
+static const char *skipToStar(const char *begin, const char *end);
+
+// the entry of the first token not less than tok
+static const TokenKind *findTokenKind(const std::string & tok);
+
+// the length of the longest constant at the start of tok, 0 if there is none
+static unsigned int matchConstant(const std::string & tok);
+static unsigned int matchExponent(const std::string & tok, unsigned int pos);
+static unsigned int matchSuffix(const std::string & tok, unsigned int pos, const char *suffixes);
+static unsigned int skipDigits(const std::string & tok, unsigned int pos);
+
+CLexer::CLexer(Input *in) : input(in), mappedInput(dynamic_cast<MappedInput *>(in)),
+		inputLine(0), inputColumn(0), newLine(true), charLine(0), charColumn(0) {}
+
+CLexer::~CLexer() {}
+
+bool CLexer::nextToken(unsigned int & kind, std::string & tok, InputLocation & loc) {
+	char c = skipIgnored();
+	if (!c) return false;
+	
+	loc = InputLocation(inputName, charLine, charColumn);
+	tok.assign(1, c);
+	
+	if (CharClass::isIdentifierStart(c)) kind = readIdentifier(tok, loc);
+	else if (CharClass::isDigit(c) || c == '.') kind = readConstant(tok, loc);
+	else if (c == '"' || c == '\'') kind = readLiteral(tok, loc);
+	else kind = readPunctuator(tok, loc);
+	
+	return true;
+}
+
+unsigned int CLexer::getTokenKind(const std::string & tok, const InputLocation & loc) {
+	const TokenKind *kind = findTokenKind(tok);
+	if (kind && tok == kind->text) return kind->id;
+	
+	char c = tok.empty() ? 0 : tok[0];
+	if (CharClass::isIdentifierStart(c)) return CPARSERBUFFER_TOKEN_IDENTIFIER;
+	if (CharClass::isDigit(c) || c == '\'' || (c == '.' && tok.size() > 1)) return CPARSERBUFFER_TOKEN_CONSTANT;
+	if (c == '"') return CPARSERBUFFER_TOKEN_STRING_LITERAL;
+	
+	throw ParserError(loc, std::string("Unexpected \"") + tok + "\".");
+}
+
+char CLexer::readChar() {
+	if (!pending.empty()) {
+		const PendingChar & p = pending.back();
+		char c = p.c;
+		charLine = p.line;
+		charColumn = p.column;
+		pending.pop_back();
+		
+		return c;
+	}
+	
+	char c = input->nextChar();
+	
+	// the input may be a list of chunks, each with its own name and lines
+	if (newLine) {
+		inputName = input->getInputName();
+		inputLine = input->getInputLine();
+		inputColumn = 0;
+		newLine = false;
+	}
+	
+	charLine = inputLine;
+	charColumn = ++inputColumn;
+	if (c == '\n') newLine = true;
+	
+	return c;
+}
+
+void CLexer::skipMapped(const char *(*skip)(const char *begin, const char *end)) {
+	if (!mappedInput || !pending.empty()) return;
+	
+	unsigned long length;
+	const char *data = mappedInput->peek(length);
+	unsigned long count = skip(data, data + length) - data;
+	if (!count) return;
+	
+	mappedInput->skip(count);
+	
+	// the location is taken again from the input, as readChar would leave it
+	InputLocation loc = mappedInput->getCurrentLocation();
+	inputName = loc.getName();
+	inputLine = loc.getLine();
+	inputColumn = loc.getColumn();
+	newLine = data[count - 1] == '\n';
+}
+
+void CLexer::unreadChars(const std::string & text, unsigned int from, unsigned int line,
+		unsigned int column) {
+	
+	for (unsigned int i = text.size(); i > from; --i) {
+		PendingChar p;
+		p.c = text[i - 1];
+		p.line = line;
+		p.column = column + i - 1;
+		pending.push_back(p);
+	}
+}
+
+char CLexer::skipIgnored() {
+	for (;;) {
+		skipMapped(&CharClass::skipSpaces);
+		
+		char c = readChar();
+		if (CharClass::isSpace(c)) continue;
+		if (c != '/') return c;
+		
+		InputLocation loc(inputName, charLine, charColumn);
+		
+		char next = readChar();
+		if (next == '*') {
+			char prev = 0;
+			for (;;) {
+				// the comment can only end after a '*'
+				if (prev != '*') skipMapped(&skipToStar);
+				
+				next = readChar();
+				if (!next) throw ParserError(loc, "Unterminated comment.");
+				if (prev == '*' && next == '/') break;
+				prev = next;
+			}
+		}
+		else if (next == '/') {
+			while (next && next != '\n') next = readChar();
+		}
+		else {
+			// just a '/', the next character is read again
+			std::string text(1, c);
+			text.push_back(next);
+			unreadChars(text, 1, loc.getLine(), loc.getColumn());
+			
+			charLine = loc.getLine();
+			charColumn = loc.getColumn();
+			return c;
+		}
+	}
+}
+
+/*
+ * <IDENTIFIER> ::= "\w(\w|\d)*";
+ * and the keywords, that have the same form
+ */
+unsigned int CLexer::readIdentifier(std::string & tok, const InputLocation & loc) {
+	char c = readChar();
+	while (CharClass::isIdentifier(c)) {
+		tok.push_back(c);
+		c = readChar();
+	}
+	
+	tok.push_back(c);
+	unreadChars(tok, tok.size() - 1, loc.getLine(), loc.getColumn());
+	tok.resize(tok.size() - 1);
+	
+	const TokenKind *kind = findTokenKind(tok);
+	if (kind && tok == kind->text) return kind->id;
+	
+	return CPARSERBUFFER_TOKEN_IDENTIFIER;
+}
+
+/*
+ * <CONSTANT> ::= "0[xX](\h|\H)+(u|U|l|L)?";
+ * <CONSTANT> ::= "\d+(u|U|l|L)?";
+ * <CONSTANT> ::= "\d+[eE][\+-]?\d+(f|F|l|L)?";
+ * <CONSTANT> ::= "\d+\.\d*([eE][\+-]?)?\d+(f|F|l|L)?";
+ * <CONSTANT> ::= "\d*\.\d+([eE][\+-]?)?\d+(f|F|l|L)?";
+ */
+unsigned int CLexer::readConstant(std::string & tok, const InputLocation & loc) {
+	// every character a constant can have, the longest constant in them is the token
+	char c = readChar();
+	for (;;) {
+		char last = tok[tok.size() - 1];
+		bool sign = (c == '+' || c == '-') && (last == 'e' || last == 'E');
+		if (!CharClass::isIdentifier(c) && c != '.' && !sign) break;
+		
+		tok.push_back(c);
+		c = readChar();
+	}
+	
+	unsigned int length = matchConstant(tok);
+	
+	tok.push_back(c);
+	unreadChars(tok, length ? length : 1, loc.getLine(), loc.getColumn());
+	tok.resize(length ? length : 1);
+	
+	// a '.' that does not start a constant
+	if (!length) return readPunctuator(tok, loc);
+	
+	return CPARSERBUFFER_TOKEN_CONSTANT;
+}
+
+/*
+ * <CONSTANT> ::= "\'([^\\\']|\\.)+\'";
+ * <STRING_LITERAL> ::= "\"([^\\\"]|\\.)*\"";
+ */
+unsigned int CLexer::readLiteral(std::string & tok, const InputLocation & loc) {
+	char quote = tok[0];
+	
+	for (;;) {
+		char c = readChar();
+		if (c == '\\') {
+			tok.push_back(c);
+			c = readChar();
+		}
+		else if (c == quote) break;
+		
+		if (!c) throw ParserError(loc, quote == '"' ? "Missing \'\"\'." : "Missing \'\\\'\'.");
+		tok.push_back(c);
+	}
+	tok.push_back(quote);
+	
+	if (quote == '"') return CPARSERBUFFER_TOKEN_STRING_LITERAL;
+	
+	if (tok.size() == 2) throw ParserError(loc, "Empty character constant.");
+	return CPARSERBUFFER_TOKEN_CONSTANT;
+}
+
+unsigned int CLexer::readPunctuator(std::string & tok, const InputLocation & loc) {
+	// read while the text can still be the start of a punctuator
+	char c = readChar();
+	for (;;) {
+		if (!c) break;
+		
+		std::string next = tok + c;
+		const TokenKind *kind = findTokenKind(next);
+		if (!kind || strncmp(kind->text, next.c_str(), next.size())) break;
+		
+		tok = next;
+		c = readChar();
+	}
+	
+	// then back to the longest punctuator
+	tok.push_back(c);
+	
+	unsigned int length = tok.size() - 1;
+	const TokenKind *kind = NULL;
+	for (; length > 0; --length) {
+		kind = findTokenKind(tok.substr(0, length));
+		if (kind && tok.compare(0, length, kind->text) == 0) break;
+	}
+	
+	if (!length) throw ParserError(loc, std::string("Unexpected \'") + tok[0] + "\'.");
+	
+	unreadChars(tok, length, loc.getLine(), loc.getColumn());
+	tok.resize(length);
+	
+	return kind->id;
+}
+
+static bool compareTokenKind(const TokenKind & kind, const char *text) {
+	return strcmp(kind.text, text) < 0;
+}
+
+static const TokenKind *findTokenKind(const std::string & tok) {
+	const TokenKind *end = tokenKinds + sizeof(tokenKinds) / sizeof(TokenKind);
+	const TokenKind *kind = std::lower_bound(tokenKinds, end, tok.c_str(), compareTokenKind);
+	
+	return kind == end ? NULL : kind;
+}
+
+static unsigned int matchConstant(const std::string & tok) {
+	unsigned int best = 0;
+	
+	// 0[xX](\h|\H)+(u|U|l|L)?
+	if (tok.size() > 2 && tok[0] == '0' && (tok[1] == 'x' || tok[1] == 'X') && CharClass::isHexDigit(tok[2])) {
+		unsigned int end = 2;
+		while (end < tok.size() && CharClass::isHexDigit(tok[end])) ++end;
+		best = end + matchSuffix(tok, end, "uUlL");
+	}
+	
+	unsigned int digits = skipDigits(tok, 0);
+	if (digits > 0) {
+		// \d+(u|U|l|L)?
+		best = std::max(best, digits + matchSuffix(tok, digits, "uUlL"));
+		
+		// \d+[eE][\+-]?\d+(f|F|l|L)?
+		unsigned int end = matchExponent(tok, digits);
+		if (end) best = std::max(best, end + matchSuffix(tok, end, "fFlL"));
+	}
+	
+	// \d+\.\d*([eE][\+-]?)?\d+(f|F|l|L)?
+	// \d*\.\d+([eE][\+-]?)?\d+(f|F|l|L)?
+	if (digits < tok.size() && tok[digits] == '.') {
+		unsigned int fraction = skipDigits(tok, digits + 1);
+		unsigned int fractionDigits = fraction - digits - 1;
+		unsigned int exponent = matchExponent(tok, fraction);
+		
+		// without the exponent the digits after the '.' are split in two \d
+		unsigned int end = 0;
+		if (exponent && fractionDigits >= (digits > 0 ? 0 : 1)) end = exponent;
+		else if (fractionDigits >= (digits > 0 ? 1 : 2)) end = fraction;
+		
+		if (end) best = std::max(best, end + matchSuffix(tok, end, "fFlL"));
+	}
+	
+	return best;
+}
+
+// the end of [eE][\+-]?\d+ at pos, 0 if it is not there
+static unsigned int matchExponent(const std::string & tok, unsigned int pos) {
+	if (pos >= tok.size() || (tok[pos] != 'e' && tok[pos] != 'E')) return 0;
+	
+	unsigned int start = pos + 1;
+	if (start < tok.size() && (tok[start] == '+' || tok[start] == '-')) ++start;
+	
+	unsigned int end = skipDigits(tok, start);
+	return end > start ? end : 0;
+}
+
+static unsigned int matchSuffix(const std::string & tok, unsigned int pos, const char *suffixes) {
+	return pos < tok.size() && strchr(suffixes, tok[pos]) ? 1 : 0;
+}
+
+static unsigned int skipDigits(const std::string & tok, unsigned int pos) {
+	while (pos < tok.size() && CharClass::isDigit(tok[pos])) ++pos;
+	return pos;
+}
+
+static const char *skipToStar(const char *begin, const char *end) {
+	const char *star = (const char *)memchr(begin, '*', end - begin);
+	return star ? star : end;
+}
@@ -0,0 +1,74 @@
+#ifndef CLEXER_H
+#define CLEXER_H
+
+#include <parser/InputLocation.h>
+
+#include <string>
+#include <vector>
+
+class Input;
+class MappedInput;
+
+/*
+ * The scanner of c_scanner.bnf written as code: each token is read by the
+ * loop for its first character, instead of walking the automaton one
+ * character at a time. It gives the same tokens as the automaton.
+ */
+class CLexer {
+	public:
+		// the input is not deleted by the lexer
+		CLexer(Input *in);
+		~CLexer();
+		
+		// read the kind, the text and the location of a token, false at the end of the input
+		bool nextToken(unsigned int & kind, std::string & tok, InputLocation & loc);
+		
+		// the kind of a whole token, a ParserError if it is not a C token
+		static unsigned int getTokenKind(const std::string & tok, const InputLocation & loc);
+		
+	private:
+		struct PendingChar {
+			char c;
+			unsigned int line;
+			unsigned int column;
+		};
+		typedef std::vector<PendingChar> PendingList;
+		
+		// '\0' at the end of the input
+		char readChar();
+		
+		// read text[from] and the characters after it again, text is in a single line
+		void unreadChars(const std::string & text, unsigned int from, unsigned int line, unsigned int column);
+		
+		// skip the white spaces and the comments, return the next character
+		char skipIgnored();
+		
+		// pass in place the characters up to the one skip returns, only on a mapped input
+		void skipMapped(const char *(*skip)(const char *begin, const char *end));
+		
+		// the kind of the token started by tok, its text is read to tok
+		unsigned int readIdentifier(std::string & tok, const InputLocation & loc);
+		unsigned int readConstant(std::string & tok, const InputLocation & loc);
+		unsigned int readLiteral(std::string & tok, const InputLocation & loc);
+		unsigned int readPunctuator(std::string & tok, const InputLocation & loc);
+		
+		Input *input;
+		
+		// the input if it is a MappedInput, its spaces and comments are read in blocks
+		MappedInput *mappedInput;
+		
+		// the characters read ahead, the last one is read first
+		PendingList pending;
+		
+		// the location of the input, updated at each new line
+		std::string inputName;
+		unsigned int inputLine;
+		unsigned int inputColumn;
+		bool newLine;
+		
+		// the location of the last character read
+		unsigned int charLine;
+		unsigned int charColumn;
+};
+
+#endif
@@ -5,11 +5,13 @@
 #include "compiler/CompilerContext.h"
 #include "compiler/CScanner.h"
 #include "compiler/Declaration.h"
+#include "compiler/DeclarationSnapshot.h"
 #include "compiler/FunctionDeclarator.h"
 #include "compiler/FunctionType.h"
 #include "compiler/GlobalSymbolTable.h"
 #include "compiler/PointerType.h"
 #include "compiler/PrimitiveType.h"
+#include "compiler/TokenArena.h"
 #include "vm/ArithmeticInstruction.h"
 #include "vm/LabeledInstruction.h"
 #include "vm/LoadInstruction.h"
@@ -18,6 +20,9 @@
 #include "vm/SetInstruction.h"
 #include "vm/StoreInstruction.h"
 #include "CParserBuffer.h"
+#include "MemReport.h"
+#include "TimeReport.h"
+#include "TokenStream.h"
 
 #include <parser/Input.h>
 #include <parser/Parser.h>
@@ -28,27 +33,113 @@
 #include <cstdlib>
 #include <list>
 
-CParser::CParser(CompilerContext & ctx) : context(ctx) {}
+CParser::CParser(CompilerContext & ctx) : context(ctx), scanner(NULL), snapshot(NULL) {}
 
 Program *CParser::parse(Input *input) {
+	std::string fileName = input->getInputName();
+	
+	return parse(new CScanner(input, context.getIdentifierTable()), fileName);
+}
+
+Program *CParser::parse(TokenStream *tokens) {
+	std::string fileName = tokens->getName();
+	
+	return parse(new CScanner(tokens, context.getIdentifierTable()), fileName);
+}
+
+std::string CParser::parseDeclarations(TokenStream *tokens) {
+	unsigned int tokenCount = tokens->size();
+	
+	DeclarationSnapshot declarations;
+	snapshot = &declarations;
+	
+	Program *program;
+	try {
+		program = parse(tokens);
+	}
+	catch (...) {
+		snapshot = NULL;
+		throw;
+	}
+	snapshot = NULL;
+	
+	// the code would have to run before the unit
+	bool onlyDeclarations = program->getInstructions().empty();
+	delete(program);
+	
+	if (!onlyDeclarations) return "";
+	return declarations.write(*context.getStaticMemory(), tokenCount);
+}
+
+Program *CParser::parse(TokenStream *tokens, const std::string & declarations) {
+	std::string fileName = tokens->getName();
+	
+	CScanner *scan = new CScanner(tokens, context.getIdentifierTable());
+	
+	unsigned int tokenCount;
+	try {
+		tokenCount = DeclarationSnapshot::restore(declarations, context, scan->getTypedefManager());
+		if (tokenCount > tokens->size()) throw ParserError("invalid declarations in the precompiled header.");
+	}
+	catch (...) {
+		delete(scan);
+		throw;
+	}
+	
+	// only the header, there is nothing else to parse
+	if (tokenCount == tokens->size()) {
+		delete(scan);
+		return getProgram();
+	}
+	
+	scan->setTokenIndex(tokenCount);
+	
+	return parse(scan, fileName);
+}
+
+Program *CParser::parse(CScanner *scan, const std::string & fileName) {
 	const Compiler *compiler = context.getCompiler();
-	scanner = new CScanner(compiler->getScannerAutomata(), input);
+	
+	// the tokens of the tree, freed at once after it
+	TokenArena arena;
+	TokenArena::Scope arenaScope(&arena);
+	
+	scanner = scan;
 	Parser *parser = new Parser(compiler->getParserTable(), scanner);
 	
 	parser->setParserAction(this);
 	
-	Node *root = parser->parse();
-	parseTranslationUnit((NonTerminal *)root);
+	Node *root;
+	{
+		TimeReport::Timer timer(compiler->getTimeReport(), fileName, TimeReport::PARSE);
+		root = parser->parse();
+	}
+	MemReport::addParsingTree(root);
+	
+	{
+		TimeReport::Timer timer(compiler->getTimeReport(), fileName, TimeReport::CODE_GENERATION);
+		parseTranslationUnit((NonTerminal *)root);
+	}
 	
 	delete(parser);
 	delete(root);
 	
 	assert(context.getStartFunction() == context.getCurrentFunction());
 	
+	return getProgram();
+}
+
+Program *CParser::getProgram() {
+	// the initializations after the last function
+	context.flushInstructions();
+	
 	CompilerContext::InstructionList instructions = context.getInstructions();
 	context.consumeInstructions();
 	
-	return new Program(context.getStaticMemory()->getMemory(), instructions);
+	const StaticMemory::Memory & memory = context.getStaticMemory()->getMemory();
+	MemReport::addConsumer(MemReport::STATIC_MEMORY, memory.capacity());
+	
+	return new Program(memory, instructions);
 }
 
 /*
@@ -66,6 +157,7 @@ void CParser::recognized(NonTerminal *nt) {
 			for (DeclaratorList::const_iterator it = declarators.begin();
 					it != declarators.end(); ++it) {
 				typeManager.typeDef((*it)->getName(), (*it)->getType());
+				if (snapshot) snapshot->addTypedef((*it)->getName(), (*it)->getType());
 			}
 		}
 	}
@@ -213,10 +305,13 @@ void CParser::parseFunctionDefinition(NonTerminal *nt) {
 		throw ParserError(nt->getInputLocation(), "Invalid function definition.");
 	}
 	
-	GlobalSymbolTable *globalSyms = context.getSymbolManager().getGlobalSymbolTable();
-	if (!globalSyms->hasFunction(declarator->getName())) declareFunction(funcDecl);
+	const SymbolManager & sManager = context.getSymbolManager();
+	GlobalSymbolTable *globalSyms = sManager.getGlobalSymbolTable();
+	SymbolManager::Id id = sManager.getId(declarator->getName());
+	
+	if (!globalSyms->hasFunction(id)) declareFunction(funcDecl);
 	else {
-		const Pointer<Function> & func = globalSyms->getFunction(declarator->getName());
+		const Pointer<Function> & func = globalSyms->getFunction(id);
 		
 		assert(funcDecl->getType().instanceOf<FunctionType>());
 		
@@ -340,7 +435,8 @@ void CParser::allocateParameter(const Declarator & decl, int & baseOffset) {
 	int pos = func->getStackBaseOffset();
 	
 	Pointer<Variable> var = new Variable(type, Variable::LOCAL, pos);
-	context.getSymbolManager().addVariable(decl.getName(), var);
+	SymbolManager & sManager = context.getSymbolManager();
+	sManager.addVariable(sManager.getId(decl.getName()), var);
 	
 	// copy the value to the parameter
 	int baseOff = func->getStackBaseOffset();
@@ -491,7 +587,8 @@ void CParser::declareLocalVariable(const Pointer<Declaration> & decl) {
 		unsigned int pos = func->getStackBaseOffset();
 		
 		Pointer<Variable> var = new Variable(type, Variable::LOCAL, pos);
-		context.getSymbolManager().addVariable((*it)->getName(), var);
+		SymbolManager & sManager = context.getSymbolManager();
+		sManager.addVariable(sManager.getId((*it)->getName()), var);
 		
 		if ((*it)->hasInitializer()) parseInitializer((*it)->getInitializer(), var);
 	}
@@ -510,7 +607,9 @@ void CParser::declareGlobalVariable(const Pointer<Declarator> & decl) {
 	unsigned int pos = context.getStaticMemory()->allocate(typeSize);
 	
 	Pointer<Variable> var = new Variable(type, Variable::GLOBAL, pos);
-	context.getSymbolManager().getGlobalSymbolTable()->addVariable(decl->getName(), var);
+	SymbolManager & sManager = context.getSymbolManager();
+	sManager.getGlobalSymbolTable()->addVariable(sManager.getId(decl->getName()), var);
+	if (snapshot) snapshot->addVariable(decl->getName(), var);
 	
 	if (decl->hasInitializer()) parseInitializer(decl->getInitializer(), var);
 }
@@ -522,8 +621,9 @@ void CParser::declareFunction(const Pointer<FunctionDeclarator> & decl) {
 	
 	function->setType(decl->getType().staticCast<FunctionType>());
 	
-	context.getSymbolManager().getGlobalSymbolTable()->addFunction(decl->getName(), function);
-	
+	SymbolManager & sManager = context.getSymbolManager();
+	sManager.getGlobalSymbolTable()->addFunction(sManager.getId(decl->getName()), function);
+	if (snapshot) snapshot->addFunction(decl->getName(), function->getType());
 }
 
 void CParser::declareGlobal(const Pointer<Declaration> & decl) {
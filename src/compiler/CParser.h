@@ -20,10 +20,12 @@
 
 class CompilerContext;
 class CScanner;
+class DeclarationSnapshot;
 class Declarator;
 class Input;
 class Instruction;
 class Program;
+class TokenStream;
 
 typedef std::vector<std::string> IdentifierList;
 
@@ -37,8 +39,24 @@ class CParser : private ParserAction {
 		CParser(CompilerContext & ctx);
 		
 		Program *parse(Input *input);
+		Program *parse(TokenStream *tokens);
+		
+		/*
+		 * Parse the code of a precompiled header, return its declarations
+		 * (see DeclarationSnapshot). Empty if the code is more than
+		 * declarations, such as a function or an initialization.
+		 */
+		std::string parseDeclarations(TokenStream *tokens);
+		
+		// parse the tokens after the ones the declarations were made from
+		Program *parse(TokenStream *tokens, const std::string & declarations);
 		
 	private:
+		Program *parse(CScanner *scan, const std::string & fileName);
+		
+		// the program of what was parsed
+		Program *getProgram();
+		
 		void recognized(NonTerminal *nt);
 		
 		// add an instruction to the current scope
@@ -159,6 +177,9 @@ class CParser : private ParserAction {
 		CompilerContext & context;
 		
 		CScanner *scanner;
+		
+		// the declarations at file scope are recorded to it, if it is not NULL
+		DeclarationSnapshot *snapshot;
 };
 
 #endif
@@ -12,6 +12,8 @@
 #include "compiler/TypeToken.h"
 #include "CParserBuffer.h"
 
+#include <parser/ParserError.h>
+
 #include <cstdlib>
 
 /*
@@ -647,12 +649,10 @@ Pointer<Type> CParser::parseTypeSpecifier(NonTerminal *nt) {
 			break;
 		case 9: // <TYPE_SPECIFIER> ::= <STRUCT_OR_UNION_SPECIFIER>
 			// TODO
-			abort();
-			break;
+			throw ParserError(nt->getInputLocation(), "Structures and unions are not supported yet.");
 		case 10: // <TYPE_SPECIFIER> ::= <ENUM_SPECIFIER>
 			// TODO
-			abort();
-			break;
+			throw ParserError(nt->getInputLocation(), "Enumerations are not supported yet.");
 		case 11: // <TYPE_SPECIFIER> ::= TYPE_NAME
 			assert(dynamic_cast<TypeToken *>(nt->getTokenAt(0)));
 			type = static_cast<TypeToken *>(nt->getTokenAt(0))->getType();
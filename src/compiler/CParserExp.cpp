@@ -89,8 +89,11 @@ ExpResult CParser::parsePrimaryExpIdentifier(Token *token) {
 	const SymbolManager & sManager = context.getSymbolManager();
 	GlobalSymbolTable *globalSyms = sManager.getGlobalSymbolTable();
 	
-	if (sManager.hasVariable(name)) {
-		const Pointer<Variable> & var = sManager.getVariable(name);
+	// hashed once, every scope is searched by the id
+	SymbolManager::Id id = sManager.getId(name);
+	
+	if (sManager.hasVariable(id)) {
+		const Pointer<Variable> & var = sManager.getVariable(id);
 		
 		Register reg = getVariableAddr(var);
 		stackPush(reg);
@@ -104,8 +107,8 @@ ExpResult CParser::parsePrimaryExpIdentifier(Token *token) {
 		// so it's not dynamic
 		result.setDynamic(!var->getType().instanceOf<ArrayType>());
 	}
-	else if (globalSyms->hasFunction(name)) {
-		const Pointer<Function> & func = globalSyms->getFunction(name);
+	else if (globalSyms->hasFunction(id)) {
+		const Pointer<Function> & func = globalSyms->getFunction(id);
 		
 		Register addr = allocatePRRegister();
 		addInstruction(new LoadAddrInstruction(addr, func->getName()));
@@ -1,42 +1,73 @@
 #include "compiler/CScanner.h"
 
+#include "compiler/CLexer.h"
+#include "compiler/CToken.h"
 #include "compiler/TypeToken.h"
 #include "compiler/TypedefManager.h"
 #include "CParserBuffer.h"
+#include "TokenStream.h"
 
-CScanner::CScanner(const Pointer<ScannerAutomata> & a, Input *in) : Scanner(a, in) {}
+#include <parser/MemoryInput.h>
 
-CScanner::~CScanner() {}
+#include <cassert>
+
+CScanner::CScanner(Input *in, IdentifierTable & ids) : Scanner(Pointer<ScannerAutomata>(), in),
+		typedefManager(ids), lexer(new CLexer(in)), tokenStream(NULL), tokenIndex(0) {}
+		
+CScanner::CScanner(TokenStream *tokens, IdentifierTable & ids) :
+		Scanner(Pointer<ScannerAutomata>(), new MemoryInput("", tokens->getName())), typedefManager(ids),
+		lexer(NULL), tokenStream(tokens), tokenIndex(0) {}
+		
+CScanner::~CScanner() {
+	delete(lexer);
+	delete(tokenStream);
+}
 
 ParsingTree::Token *CScanner::nextToken() {
-	Token *token = Scanner::nextToken();
+	unsigned int kind;
+	std::string tok;
+	InputLocation loc;
+	
+	bool read = tokenStream ? readStreamToken(kind, tok, loc) : lexer->nextToken(kind, tok, loc);
+	if (!read) return NULL;
 	
-	if (token) {
-		switch (token->getTokenTypeId()) {
-			case CPARSERBUFFER_TOKEN_BEGIN:
-				typedefManager.scopeBegin();
-				break;
-			case CPARSERBUFFER_TOKEN_END:
-				typedefManager.scopeEnd();
-				break;
-			case CPARSERBUFFER_TOKEN_IDENTIFIER:
-				if (typedefManager.isType(token->getToken())) {
-					// save the type with the token
-					Token *typeToken = new TypeToken(
-							typedefManager.getType(token->getToken()),
-							token->getToken(),
-							token->getInputLocation());
-					
-					delete(token);
-					token = typeToken;
-				}
-				break;
+	// the token is made once its kind is known, a type name is not made twice
+	switch (kind) {
+		case CPARSERBUFFER_TOKEN_BEGIN:
+			typedefManager.scopeBegin();
+			break;
+		case CPARSERBUFFER_TOKEN_END:
+			typedefManager.scopeEnd();
+			break;
+		case CPARSERBUFFER_TOKEN_IDENTIFIER:
+		{
+			TypedefManager::Id id = typedefManager.getId(tok);
+			
+			// save the type with the token
+			if (typedefManager.isType(id)) return new TypeToken(typedefManager.getType(id), tok, loc);
+			break;
 		}
 	}
 	
-	return token;
+	return new CToken(kind, tok, loc);
 }
 
 TypedefManager & CScanner::getTypedefManager() {
 	return typedefManager;
 }
+
+void CScanner::setTokenIndex(unsigned int index) {
+	assert(tokenStream && index <= tokenStream->size());
+	tokenIndex = index;
+}
+
+bool CScanner::readStreamToken(unsigned int & kind, std::string & tok, InputLocation & loc) {
+	if (tokenIndex == tokenStream->size()) return false;
+	
+	const TokenStream::Token & token = tokenStream->getToken(tokenIndex++);
+	tok = tokenStream->getText(token);
+	loc = InputLocation(tokenStream->getFileName(token), token.line, token.column);
+	kind = CLexer::getTokenKind(tok, loc);
+	
+	return true;
+}
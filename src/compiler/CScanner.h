@@ -2,22 +2,45 @@
 #define CSCANNER_H
 
 #include "compiler/TypedefManager.h"
+#include "IdentifierTable.h"
 
 #include <parser/Scanner.h>
 
+class CLexer;
+class TokenStream;
+
+/*
+ * The tokens are lexed by CLexer or read from the preprocessor, so the
+ * automaton of the base Scanner is never loaded.
+ */
 class CScanner : public Scanner {
 	public:
 		typedef ParsingTree::Token Token;
 		
-		CScanner(const Pointer<ScannerAutomata> & a, Input *in);
+		CScanner(Input *in, IdentifierTable & ids);
+		
+		// read the tokens of the preprocessor instead of lexing an input
+		CScanner(TokenStream *tokens, IdentifierTable & ids);
 		virtual ~CScanner();
 		
 		virtual Token *nextToken();
 		
 		TypedefManager & getTypedefManager();
 		
+		// read the tokens of the preprocessor from index on
+		void setTokenIndex(unsigned int index);
+		
 	private:
+		bool readStreamToken(unsigned int & kind, std::string & tok, InputLocation & loc);
+		
 		TypedefManager typedefManager;
+		
+		// NULL if the tokens are read from the preprocessor
+		CLexer *lexer;
+		
+		// NULL if the tokens are lexed from the input
+		TokenStream *tokenStream;
+		unsigned int tokenIndex;
 };
 
 #endif
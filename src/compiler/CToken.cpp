@@ -0,0 +1,18 @@
+#include "compiler/CToken.h"
+
+#include "compiler/TokenArena.h"
+
+CToken::CToken(unsigned int id) : ParsingTree::Token(id) {}
+
+CToken::CToken(unsigned int id, const std::string & tok, const InputLocation & location) :
+		ParsingTree::Token(id, tok, location) {}
+
+CToken::~CToken() {}
+
+void *CToken::operator new(size_t size) {
+	return TokenArena::allocateToken(size);
+}
+
+void CToken::operator delete(void *ptr) {
+	TokenArena::deallocateToken(ptr);
+}
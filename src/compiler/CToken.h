@@ -0,0 +1,24 @@
+#ifndef CTOKEN_H
+#define CTOKEN_H
+
+#include <parser/ParsingTree.h>
+
+#include <cstddef>
+#include <string>
+
+/*
+ * A token of the C code, made by CScanner. It is allocated in the
+ * TokenArena of the unit being parsed, the tree deletes it as any other
+ * node and the deletes reach the operator delete of its class.
+ */
+class CToken : public ParsingTree::Token {
+	public:
+		CToken(unsigned int id);
+		CToken(unsigned int id, const std::string & tok, const InputLocation & location);
+		virtual ~CToken();
+		
+		static void *operator new(size_t size);
+		static void operator delete(void *ptr);
+};
+
+#endif
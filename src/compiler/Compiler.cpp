@@ -3,43 +3,96 @@
 #include "compiler/CompilerContext.h"
 #include "compiler/CParser.h"
 #include "compiler/CScanner.h"
+#include "compiler/TokenArena.h"
 #include "CParserBuffer.h"
+#include "IdentifierTable.h"
+#include "TokenStream.h"
 
 #include <parser/Parser.h>
 #include <parser/ParserLoader.h>
 #include <parser/Scanner.h>
 
-Compiler::Compiler() {
-	scannerAutomata = ParserLoader::bufferToAutomata(c_parser_buffer_scanner);
-	parserTable = ParserLoader::bufferToTable(c_parser_buffer_parser);
-}
+Compiler::Compiler() : timeReport(NULL) {}
 
 Compiler::~Compiler() {}
 
-Program *Compiler::compile(Input *input) const {
+Program *Compiler::compile(Input *input, FunctionWriter *writer) const {
 	CompilerContext context(this);
+	context.setFunctionWriter(writer);
 	
 	CParser parser(context);
 	
 	return parser.parse(input);
 }
 
+Program *Compiler::compile(TokenStream *tokens, FunctionWriter *writer) const {
+	CompilerContext context(this);
+	context.setFunctionWriter(writer);
+	
+	CParser parser(context);
+	
+	return parser.parse(tokens);
+}
+
+std::string Compiler::compileDeclarations(const TokenStream & tokens) const {
+	CompilerContext context(this);
+	CParser parser(context);
+	
+	// the scanner takes the tokens it reads
+	TokenStream *copy = new TokenStream(tokens.getName());
+	copy->append(tokens);
+	
+	return parser.parseDeclarations(copy);
+}
+
+Program *Compiler::compile(TokenStream *tokens, const std::string & declarations,
+		FunctionWriter *writer) const {
+	
+	CompilerContext context(this);
+	context.setFunctionWriter(writer);
+	
+	CParser parser(context);
+	
+	return parser.parse(tokens, declarations);
+}
+
 void Compiler::checkSyntax(Input *input) const {
-	Scanner *scan = new CScanner(scannerAutomata, input);
-	Parser *parser = new Parser(parserTable, scan);
+	IdentifierTable identifiers;
+	checkSyntax(new CScanner(input, identifiers));
+}
+
+void Compiler::checkSyntax(TokenStream *tokens) const {
+	IdentifierTable identifiers;
+	checkSyntax(new CScanner(tokens, identifiers));
+}
+
+void Compiler::checkSyntax(Scanner *scan) const {
+	TokenArena arena;
+	TokenArena::Scope arenaScope(&arena);
+	
+	Parser *parser = new Parser(getParserTable(), scan);
 	
 	delete(parser->parse());
 	delete(parser);
 }
 
-const Pointer<ScannerAutomata> & Compiler::getScannerAutomata() const {
-	return scannerAutomata;
-}
-
 const Pointer<ParserTable> & Compiler::getParserTable() const {
+	if (!parserTable) parserTable = ParserLoader::bufferToTable(c_parser_buffer_parser);
 	return parserTable;
 }
 
+void Compiler::loadTables() const {
+	getParserTable();
+}
+
 const StaticMemoryList & Compiler::getStaticMemoryList() const {
 	return staticMemoryList;
 }
+
+TimeReport *Compiler::getTimeReport() const {
+	return timeReport;
+}
+
+void Compiler::setTimeReport(TimeReport *report) {
+	timeReport = report;
+}
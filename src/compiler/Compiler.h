@@ -5,30 +5,73 @@
 
 #include <parser/ParserTable.h>
 #include <parser/Pointer.h>
-#include <parser/ScannerAutomata.h>
 
+#include <string>
+
+class FunctionWriter;
 class Input;
 class Program;
+class Scanner;
+class TimeReport;
+class TokenStream;
 
 class Compiler {
 	public:
 		Compiler();
 		~Compiler();
 		
-		Program *compile(Input *input) const;
+		/*
+		 * If writer is not NULL the code is written to it as each function
+		 * is compiled, and the program returned has only the static memory.
+		 */
+		Program *compile(Input *input, FunctionWriter *writer = NULL) const;
+		
+		// compile the tokens of the preprocessor, without lexing the code again
+		Program *compile(TokenStream *tokens, FunctionWriter *writer = NULL) const;
+		
+		/*
+		 * Compile the code of a precompiled header, return the declarations
+		 * it makes. Empty if it has other code, which then has to be compiled
+		 * with each unit.
+		 */
+		std::string compileDeclarations(const TokenStream & tokens) const;
+		
+		/*
+		 * Compile the tokens of a unit that start with the code the
+		 * declarations were made from. Only the tokens after that code are
+		 * parsed, the program is the same as if all of them were.
+		 */
+		Program *compile(TokenStream *tokens, const std::string & declarations,
+				FunctionWriter *writer = NULL) const;
 		
 		void checkSyntax(Input *input) const;
+		void checkSyntax(TokenStream *tokens) const;
 		
-		const Pointer<ScannerAutomata> & getScannerAutomata() const;
 		const Pointer<ParserTable> & getParserTable() const;
 		
+		// the parser table is loaded the first time a unit is parsed, this loads it now
+		void loadTables() const;
+		
 		const StaticMemoryList & getStaticMemoryList() const;
 		
+		// NULL if the phases are not timed
+		TimeReport *getTimeReport() const;
+		void setTimeReport(TimeReport *report);
+		
 	private:
-		Pointer<ScannerAutomata> scannerAutomata;
-		Pointer<ParserTable> parserTable;
+		void checkSyntax(Scanner *scan) const;
+		
+		/*
+		 * libparser decodes the table from the generated buffer, it has no
+		 * layout that can be used in place. A unit found in the cache is
+		 * not parsed, so a run with only cache hits never decodes it.
+		 * The scanner automaton is not loaded, CLexer lexes the code.
+		 */
+		mutable Pointer<ParserTable> parserTable;
 		
 		StaticMemoryList staticMemoryList;
+		
+		TimeReport *timeReport;
 };
 
 #endif
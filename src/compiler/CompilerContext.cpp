@@ -1,10 +1,12 @@
 #include "compiler/CompilerContext.h"
 
+#include "compiler/FunctionWriter.h"
 #include "compiler/GlobalSymbolTable.h"
 #include "vm/ArithmeticInstruction.h"
 #include "vm/LoadInstruction.h"
 #include "vm/SetInstruction.h"
 #include "vm/StoreInstruction.h"
+#include "MemReport.h"
 
 //#define SHOW_ALLOCS
 
@@ -14,7 +16,9 @@
 static int allocBytes = 0;
 #endif
 
-CompilerContext::CompilerContext(const Compiler *comp) : compiler(comp) {
+CompilerContext::CompilerContext(const Compiler *comp) : compiler(comp),
+		symbolManager(identifierTable), functionWriter(NULL) {
+	
 	startFunction = new Function("_start");
 	
 	staticMemory = new StaticMemory();
@@ -31,6 +35,10 @@ const Compiler *CompilerContext::getCompiler() const {
 	return compiler;
 }
 
+IdentifierTable & CompilerContext::getIdentifierTable() {
+	return identifierTable;
+}
+
 SymbolManager & CompilerContext::getSymbolManager() {
 	return symbolManager;
 }
@@ -44,6 +52,10 @@ const Pointer<StaticMemory> & CompilerContext::getStaticMemory() const {
 }
 
 void CompilerContext::addInstruction(Instruction *inst) {
+	if (MemReport::isEnabled()) {
+		MemReport::addConsumer(MemReport::INSTRUCTIONS, MemReport::getAllocationSize(inst));
+	}
+	
 	instructions.push_back(inst);
 }
 
@@ -55,6 +67,21 @@ void CompilerContext::consumeInstructions() {
 	instructions.clear();
 }
 
+void CompilerContext::setFunctionWriter(FunctionWriter *writer) {
+	functionWriter = writer;
+}
+
+void CompilerContext::flushInstructions() {
+	if (!functionWriter) return;
+	
+	functionWriter->writeFunction(instructions);
+	
+	for (InstructionList::iterator it = instructions.begin(); it != instructions.end(); ++it) {
+		delete(*it);
+	}
+	instructions.clear();
+}
+
 const Pointer<Scope> & CompilerContext::beginScope() {
 	symbolManager.scopeBegin();
 	
@@ -109,11 +136,12 @@ const Pointer<Function> & CompilerContext::beginFunction(const std::string & nam
 	assert(!currentFunction);
 	
 	GlobalSymbolTable *globalSym = symbolManager.getGlobalSymbolTable();
+	SymbolManager::Id id = symbolManager.getId(name);
 	
-	if (globalSym->hasFunction(name)) currentFunction = globalSym->getFunction(name);
+	if (globalSym->hasFunction(id)) currentFunction = globalSym->getFunction(id);
 	else {
 		currentFunction = new Function(name);
-		globalSym->addFunction(name, currentFunction);
+		globalSym->addFunction(id, currentFunction);
 	}
 	
 	return currentFunction;
@@ -126,6 +154,10 @@ void CompilerContext::endFunction() {
 	
 	functions.push_back(currentFunction);
 	currentFunction = NULL;
+	
+	// the jumps are relative and no scope is open, the code can leave now
+	assert(scopeStack.empty());
+	flushInstructions();
 }
 
 const Pointer<Function> & CompilerContext::getCurrentFunction() const {
@@ -6,6 +6,7 @@
 #include "compiler/StaticMemory.h"
 #include "compiler/SymbolManager.h"
 #include "vm/Instruction.h"
+#include "IdentifierTable.h"
 #include "Number.h"
 
 #include <parser/Pointer.h>
@@ -16,6 +17,7 @@ typedef std::vector<Pointer<Function> > FunctionList;
 typedef std::vector<Pointer<Scope> > ScopeStack;
 
 class Compiler;
+class FunctionWriter;
 
 class CompilerContext {
 	public:
@@ -26,6 +28,9 @@ class CompilerContext {
 		
 		const Compiler *getCompiler() const;
 		
+		// the names of the symbols and typedefs of the compilation
+		IdentifierTable & getIdentifierTable();
+		
 		SymbolManager & getSymbolManager();
 		const SymbolManager & getSymbolManager() const;
 		
@@ -35,6 +40,13 @@ class CompilerContext {
 		const InstructionList & getInstructions() const;
 		void consumeInstructions();
 		
+		/*
+		 * If a writer is set, the instructions are handed to it and deleted
+		 * at the end of each function, and by flushInstructions.
+		 */
+		void setFunctionWriter(FunctionWriter *writer);
+		void flushInstructions();
+		
 		const Pointer<Scope> & beginScope();
 		void endScope();
 		const Pointer<Scope> & getCurrentScope() const;
@@ -73,6 +85,7 @@ class CompilerContext {
 	private:
 		const Compiler *compiler;
 		
+		IdentifierTable identifierTable;
 		SymbolManager symbolManager;
 		
 		// the current defining function
@@ -89,6 +102,8 @@ class CompilerContext {
 		Pointer<StaticMemory> staticMemory;
 		
 		InstructionList instructions;
+		
+		FunctionWriter *functionWriter;
 };
 
 #endif
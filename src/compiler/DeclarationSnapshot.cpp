@@ -0,0 +1,373 @@
+#include "compiler/DeclarationSnapshot.h"
+
+#include "compiler/ArrayType.h"
+#include "compiler/CompilerContext.h"
+#include "compiler/Function.h"
+#include "compiler/GlobalSymbolTable.h"
+#include "compiler/PointerType.h"
+#include "compiler/PrimitiveType.h"
+#include "compiler/TypedefManager.h"
+
+#include <parser/ParserError.h>
+
+#include <cstdlib>
+
+enum TypeKind {
+	TYPE_PRIMITIVE = 0,
+	TYPE_POINTER,
+	TYPE_ARRAY,
+	TYPE_FUNCTION
+};
+
+template<typename _T>
+static Type *newPrimitive() {
+	return new PrimitiveType<_T>();
+}
+
+template<typename _T>
+static bool isPrimitive(const Type & type) {
+	return dynamic_cast<const PrimitiveType<_T> *>(&type);
+}
+
+// the instances of PrimitiveType, a primitive type is written as its index here
+struct Primitive {
+	Type *(*make)();
+	bool (*is)(const Type & type);
+};
+
+static const Primitive primitives[] = {
+	{&newPrimitive<void>, &isPrimitive<void>},
+	{&newPrimitive<bool>, &isPrimitive<bool>},
+	{&newPrimitive<char>, &isPrimitive<char>},
+	{&newPrimitive<unsigned char>, &isPrimitive<unsigned char>},
+	{&newPrimitive<int>, &isPrimitive<int>},
+	{&newPrimitive<short int>, &isPrimitive<short int>},
+	{&newPrimitive<long int>, &isPrimitive<long int>},
+	{&newPrimitive<long long int>, &isPrimitive<long long int>},
+	{&newPrimitive<unsigned int>, &isPrimitive<unsigned int>},
+	{&newPrimitive<unsigned short int>, &isPrimitive<unsigned short int>},
+	{&newPrimitive<unsigned long int>, &isPrimitive<unsigned long int>},
+	{&newPrimitive<unsigned long long int>, &isPrimitive<unsigned long long int>},
+	{&newPrimitive<float>, &isPrimitive<float>},
+	{&newPrimitive<double>, &isPrimitive<double>},
+	{&newPrimitive<long double>, &isPrimitive<long double>}
+};
+
+#define PRIMITIVE_COUNT (sizeof(primitives) / sizeof(primitives[0]))
+
+static void writeInt(std::string & buf, unsigned int value);
+static void writeString(std::string & buf, const std::string & str);
+
+/*****************************************************************************
+ * DeclarationSnapshot::Reader
+ *****************************************************************************/
+class DeclarationSnapshot::Reader {
+	public:
+		Reader(const std::string & buf);
+		
+		unsigned int readByte();
+		unsigned int readInt();
+		std::string readString();
+		
+		// a number of items of at least itemSize bytes each, that the bytes left can hold
+		unsigned int readCount(unsigned int itemSize);
+		
+		// the index of one of types
+		const Pointer<Type> & readTypeIndex(const TypeList & types);
+		
+		// a type made of the types already read
+		Pointer<Type> readType(const TypeList & types);
+		
+		bool atEnd() const;
+		
+		void invalid() const;
+		
+	private:
+		void require(unsigned int size);
+		
+		const std::string & buffer;
+		unsigned int position;
+};
+
+DeclarationSnapshot::Reader::Reader(const std::string & buf) : buffer(buf), position(0) {}
+
+unsigned int DeclarationSnapshot::Reader::readByte() {
+	require(1);
+	return (unsigned char)buffer[position++];
+}
+
+unsigned int DeclarationSnapshot::Reader::readInt() {
+	require(4);
+	
+	unsigned int value = 0;
+	for (unsigned int i = 0; i < 4; ++i) value |= (unsigned int)(unsigned char)buffer[position++] << (i * 8);
+	
+	return value;
+}
+
+std::string DeclarationSnapshot::Reader::readString() {
+	unsigned int len = readInt();
+	require(len);
+	
+	std::string str = buffer.substr(position, len);
+	position += len;
+	
+	return str;
+}
+
+unsigned int DeclarationSnapshot::Reader::readCount(unsigned int itemSize) {
+	unsigned int count = readInt();
+	if (count > (buffer.size() - position) / itemSize) invalid();
+	
+	return count;
+}
+
+const Pointer<Type> & DeclarationSnapshot::Reader::readTypeIndex(const TypeList & types) {
+	unsigned int index = readInt();
+	if (index >= types.size()) invalid();
+	
+	return types[index];
+}
+
+Pointer<Type> DeclarationSnapshot::Reader::readType(const TypeList & types) {
+	unsigned int kind = readByte();
+	bool constant = readByte();
+	bool volatileType = readByte();
+	
+	Pointer<Type> type;
+	
+	switch (kind) {
+		case TYPE_PRIMITIVE:
+		{
+			unsigned int primitive = readByte();
+			if (primitive >= PRIMITIVE_COUNT) invalid();
+			type = primitives[primitive].make();
+			break;
+		}
+		case TYPE_POINTER:
+			type = new PointerType(readTypeIndex(types));
+			break;
+		case TYPE_ARRAY:
+		{
+			Pointer<Type> baseType = readTypeIndex(types);
+			type = new ArrayType(baseType, (int)readInt());
+			break;
+		}
+		case TYPE_FUNCTION:
+		{
+			Pointer<Type> returnType = readTypeIndex(types);
+			
+			TypeList typeList(readCount(4));
+			for (TypeList::iterator it = typeList.begin(); it != typeList.end(); ++it) {
+				*it = readTypeIndex(types);
+			}
+			
+			bool ellipsis = readByte();
+			Pointer<FunctionType> functionType = new FunctionType(returnType, typeList, ellipsis);
+			functionType->setUndefined(readByte());
+			type = functionType;
+			break;
+		}
+		default:
+			invalid();
+	}
+	
+	type->setConstant(constant);
+	type->setVolatile(volatileType);
+	
+	return type;
+}
+
+bool DeclarationSnapshot::Reader::atEnd() const {
+	return position == buffer.size();
+}
+
+void DeclarationSnapshot::Reader::invalid() const {
+	throw ParserError("invalid declarations in the precompiled header.");
+}
+
+void DeclarationSnapshot::Reader::require(unsigned int size) {
+	if (buffer.size() - position < size) invalid();
+}
+
+/*****************************************************************************
+ * DeclarationSnapshot
+ *****************************************************************************/
+DeclarationSnapshot::DeclarationSnapshot() {}
+
+DeclarationSnapshot::~DeclarationSnapshot() {}
+
+void DeclarationSnapshot::addTypedef(const std::string & name, const Pointer<Type> & type) {
+	addEntry(TYPEDEF, name, type, 0);
+}
+
+void DeclarationSnapshot::addFunction(const std::string & name, const Pointer<FunctionType> & type) {
+	addEntry(FUNCTION, name, type, 0);
+}
+
+void DeclarationSnapshot::addVariable(const std::string & name, const Pointer<Variable> & var) {
+	addEntry(VARIABLE, name, var->getType(), var->getPosition());
+}
+
+std::string DeclarationSnapshot::write(const StaticMemory & memory, unsigned int tokenCount) const {
+	std::string buf;
+	writeInt(buf, tokenCount);
+	
+	const StaticMemory::Memory & bytes = memory.getMemory();
+	writeString(buf, std::string(bytes.begin(), bytes.end()));
+	
+	// the types are written as they are changed by the end of the code, not as declared
+	TypeIndex typeIndex;
+	std::string types;
+	
+	std::string declarations;
+	writeInt(declarations, entries.size());
+	
+	for (EntryList::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+		declarations.push_back(it->kind);
+		writeString(declarations, it->name);
+		writeInt(declarations, writeType(it->type, typeIndex, types));
+		if (it->kind == VARIABLE) writeInt(declarations, it->position);
+	}
+	
+	writeInt(buf, typeIndex.size());
+	buf += types;
+	buf += declarations;
+	
+	return buf;
+}
+
+unsigned int DeclarationSnapshot::restore(const std::string & buffer, CompilerContext & context,
+		TypedefManager & typedefs) {
+	
+	Reader reader(buffer);
+	
+	unsigned int tokenCount = reader.readInt();
+	
+	std::string memory = reader.readString();
+	if (!memory.empty()) {
+		StaticMemory & staticMemory = *context.getStaticMemory();
+		staticMemory.initialize(staticMemory.allocate(memory.size()), memory.data(), memory.size());
+	}
+	
+	// each type only refers to the ones before it
+	unsigned int typeCount = reader.readCount(3);
+	TypeList types;
+	types.reserve(typeCount);
+	for (unsigned int i = 0; i < typeCount; ++i) types.push_back(reader.readType(types));
+	
+	SymbolManager & sManager = context.getSymbolManager();
+	GlobalSymbolTable *globalSyms = sManager.getGlobalSymbolTable();
+	
+	unsigned int count = reader.readCount(9);
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned int kind = reader.readByte();
+		std::string name = reader.readString();
+		const Pointer<Type> & type = reader.readTypeIndex(types);
+		
+		switch (kind) {
+			case TYPEDEF:
+				typedefs.typeDef(name, type);
+				break;
+			case FUNCTION:
+			{
+				if (!type.instanceOf<FunctionType>()) reader.invalid();
+				
+				Pointer<Function> function = new Function(name);
+				function->setType(type.staticCast<FunctionType>());
+				globalSyms->addFunction(sManager.getId(name), function);
+				break;
+			}
+			case VARIABLE:
+			{
+				unsigned int position = reader.readInt();
+				if (position > memory.size() || type->getSize() > memory.size() - position) reader.invalid();
+				
+				Pointer<Variable> var = new Variable(type, Variable::GLOBAL, position);
+				globalSyms->addVariable(sManager.getId(name), var);
+				break;
+			}
+			default:
+				reader.invalid();
+		}
+	}
+	
+	if (!reader.atEnd()) reader.invalid();
+	
+	return tokenCount;
+}
+
+unsigned int DeclarationSnapshot::writeType(const Pointer<Type> & type, TypeIndex & index, std::string & buf) {
+	TypeIndex::const_iterator found = index.find(&*type);
+	if (found != index.end()) return found->second;
+	
+	std::string fields;
+	unsigned int kind;
+	
+	if (type.instanceOf<PointerType>()) {
+		kind = TYPE_POINTER;
+		writeInt(fields, writeType(type.staticCast<PointerType>()->dereference(), index, buf));
+	}
+	else if (type.instanceOf<ArrayType>()) {
+		Pointer<ArrayType> arrayType = type.staticCast<ArrayType>();
+		
+		kind = TYPE_ARRAY;
+		writeInt(fields, writeType(arrayType->dereference(), index, buf));
+		writeInt(fields, arrayType->getCount());
+	}
+	else if (type.instanceOf<FunctionType>()) {
+		Pointer<FunctionType> functionType = type.staticCast<FunctionType>();
+		
+		kind = TYPE_FUNCTION;
+		writeInt(fields, writeType(functionType->getReturnType(), index, buf));
+		
+		const TypeList & typeList = functionType->getTypeList();
+		writeInt(fields, typeList.size());
+		for (TypeList::const_iterator it = typeList.begin(); it != typeList.end(); ++it) {
+			writeInt(fields, writeType(*it, index, buf));
+		}
+		
+		fields.push_back(functionType->hasEllipsis());
+		fields.push_back(functionType->isUndefined());
+	}
+	else {
+		unsigned int primitive = 0;
+		while (primitive < PRIMITIVE_COUNT && !primitives[primitive].is(*type)) ++primitive;
+		
+		// structures and unions are not parsed yet
+		if (primitive == PRIMITIVE_COUNT) abort();
+		
+		kind = TYPE_PRIMITIVE;
+		fields.push_back(primitive);
+	}
+	
+	buf.push_back(kind);
+	buf.push_back(type->isConstant());
+	buf.push_back(type->isVolatile());
+	buf += fields;
+	
+	unsigned int result = index.size();
+	index[&*type] = result;
+	
+	return result;
+}
+
+void DeclarationSnapshot::addEntry(EntryKind kind, const std::string & name, const Pointer<Type> & type,
+		unsigned int position) {
+	
+	Entry entry;
+	entry.kind = kind;
+	entry.name = name;
+	entry.type = type;
+	entry.position = position;
+	entries.push_back(entry);
+}
+
+static void writeInt(std::string & buf, unsigned int value) {
+	for (unsigned int i = 0; i < 4; ++i) buf.push_back((value >> (i * 8)) & 0xFF);
+}
+
+static void writeString(std::string & buf, const std::string & str) {
+	writeInt(buf, str.size());
+	buf += str;
+}
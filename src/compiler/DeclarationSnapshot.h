@@ -0,0 +1,79 @@
+#ifndef DECLARATION_SNAPSHOT_H
+#define DECLARATION_SNAPSHOT_H
+
+#include "compiler/FunctionType.h"
+#include "compiler/StaticMemory.h"
+#include "compiler/Type.h"
+#include "compiler/Variable.h"
+
+#include <parser/Pointer.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class CompilerContext;
+class TypedefManager;
+
+/*
+ * The declarations at file scope of the code of a precompiled header: its
+ * typedefs, functions and global variables, and the static memory they
+ * take. A unit that starts with that code declares them again from here
+ * instead of parsing it.
+ *
+ * Each type is written once, the declarations that shared a type share it
+ * again once restored.
+ */
+class DeclarationSnapshot {
+	public:
+		DeclarationSnapshot();
+		~DeclarationSnapshot();
+		
+		// recorded in the order they are declared
+		void addTypedef(const std::string & name, const Pointer<Type> & type);
+		void addFunction(const std::string & name, const Pointer<FunctionType> & type);
+		void addVariable(const std::string & name, const Pointer<Variable> & var);
+		
+		// the declarations made by the first tokenCount tokens of a unit
+		std::string write(const StaticMemory & memory, unsigned int tokenCount) const;
+		
+		/*
+		 * Declare again in context and typedefs what buffer has, return the
+		 * number of tokens the declarations were made from. Throw a
+		 * ParserError if buffer is not valid.
+		 */
+		static unsigned int restore(const std::string & buffer, CompilerContext & context,
+				TypedefManager & typedefs);
+		
+	private:
+		class Reader;
+		
+		enum EntryKind {
+			TYPEDEF = 0,
+			FUNCTION,
+			VARIABLE
+		};
+		
+		struct Entry {
+			EntryKind kind;
+			std::string name;
+			Pointer<Type> type;
+			
+			// in the static memory, only for a variable
+			unsigned int position;
+		};
+		typedef std::vector<Entry> EntryList;
+		
+		// the index of each type already written
+		typedef std::map<const Type *, unsigned int> TypeIndex;
+		
+		// write the types type is made of and then type, return its index
+		static unsigned int writeType(const Pointer<Type> & type, TypeIndex & index, std::string & buf);
+		
+		void addEntry(EntryKind kind, const std::string & name, const Pointer<Type> & type,
+				unsigned int position);
+		
+		EntryList entries;
+};
+
+#endif
@@ -0,0 +1,5 @@
+#include "compiler/FunctionWriter.h"
+
+FunctionWriter::FunctionWriter() {}
+
+FunctionWriter::~FunctionWriter() {}
@@ -0,0 +1,23 @@
+#ifndef FUNCTION_WRITER_H
+#define FUNCTION_WRITER_H
+
+#include <vector>
+
+class Instruction;
+
+/*
+ * Receives the code of each function as soon as it is compiled, so the
+ * compiler does not keep the instructions of the whole translation unit.
+ * The instructions are deleted by the compiler after writeFunction.
+ */
+class FunctionWriter {
+	public:
+		typedef std::vector<Instruction *> InstructionList;
+		
+		FunctionWriter();
+		virtual ~FunctionWriter();
+		
+		virtual void writeFunction(const InstructionList & instructions) = 0;
+};
+
+#endif
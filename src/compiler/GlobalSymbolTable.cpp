@@ -6,17 +6,17 @@ GlobalSymbolTable::GlobalSymbolTable() {}
 
 GlobalSymbolTable::~GlobalSymbolTable() {}
 
-bool GlobalSymbolTable::hasFunction(const std::string & func) const {
-	return functions.find(func) != functions.end();
+bool GlobalSymbolTable::hasFunction(Id func) const {
+	return functions.find(func) != NULL;
 }
 
-Pointer<Function> GlobalSymbolTable::getFunction(const std::string & func) const {
-	FunctionMap::const_iterator it = functions.find(func);
-	if (it != functions.end()) return it->second;
+Pointer<Function> GlobalSymbolTable::getFunction(Id func) const {
+	const Pointer<Function> *f = functions.find(func);
+	if (f) return *f;
 	return NULL;
 }
 
-void GlobalSymbolTable::addFunction(const std::string & name, const Pointer<Function> & func) {
+void GlobalSymbolTable::addFunction(Id name, const Pointer<Function> & func) {
 	assert(!hasFunction(name));
 	
 	functions[name] = func;
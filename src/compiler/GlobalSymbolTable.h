@@ -9,12 +9,12 @@ class GlobalSymbolTable : public SymbolTable {
 		GlobalSymbolTable();
 		virtual ~GlobalSymbolTable();
 		
-		bool hasFunction(const std::string & func) const;
-		Pointer<Function> getFunction(const std::string & func) const;
-		void addFunction(const std::string & name, const Pointer<Function> & func);
+		bool hasFunction(Id func) const;
+		Pointer<Function> getFunction(Id func) const;
+		void addFunction(Id name, const Pointer<Function> & func);
 		
 	private:
-		typedef std::map<std::string, Pointer<Function> > FunctionMap;
+		typedef IdentifierMap<Pointer<Function> > FunctionMap;
 		
 		FunctionMap functions;
 		
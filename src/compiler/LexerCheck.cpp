@@ -0,0 +1,100 @@
+#include "compiler/LexerCheck.h"
+
+#include "compiler/CLexer.h"
+#include "CParserBuffer.h"
+#include "MappedInput.h"
+
+#include <parser/ParserError.h>
+#include <parser/ParserLoader.h>
+#include <parser/ParsingTree.h>
+#include <parser/Scanner.h>
+
+#include <ostream>
+
+bool LexerCheck::check(const std::string & fileName, std::ostream & err) {
+	Pointer<ScannerAutomata> automata = ParserLoader::bufferToAutomata(c_parser_buffer_scanner);
+	
+	// the scanner deletes its input, the lexer does not
+	Scanner scanner(automata, new MappedInput(fileName));
+	MappedInput lexerInput(fileName);
+	CLexer lexer(&lexerInput);
+	
+	for (unsigned int count = 1;; ++count) {
+		LexedToken expected;
+		LexedToken found;
+		
+		readScanner(scanner, expected);
+		readLexer(lexer, found);
+		
+		if (!equals(expected, found)) {
+			err << fileName << ": token " << count << " differs, the scanner read ";
+			write(err, expected);
+			err << " and the lexer read ";
+			write(err, found);
+			err << "." << std::endl;
+			
+			return false;
+		}
+		
+		if (expected.end) return true;
+	}
+}
+
+void LexerCheck::readScanner(Scanner & scanner, LexedToken & token) {
+	token.end = true;
+	token.error = false;
+	
+	try {
+		ParsingTree::Token *tok = scanner.nextToken();
+		if (!tok) return;
+		
+		InputLocation loc = tok->getInputLocation();
+		
+		token.end = false;
+		token.kind = tok->getTokenTypeId();
+		token.text = tok->getToken();
+		token.name = loc.getName();
+		token.line = loc.getLine();
+		token.column = loc.getColumn();
+		
+		delete(tok);
+	}
+	catch (ParserError &) {
+		token.error = true;
+	}
+}
+
+void LexerCheck::readLexer(CLexer & lexer, LexedToken & token) {
+	token.end = true;
+	token.error = false;
+	
+	try {
+		InputLocation loc;
+		if (!lexer.nextToken(token.kind, token.text, loc)) return;
+		
+		token.end = false;
+		token.name = loc.getName();
+		token.line = loc.getLine();
+		token.column = loc.getColumn();
+	}
+	catch (ParserError &) {
+		token.error = true;
+	}
+}
+
+bool LexerCheck::equals(const LexedToken & a, const LexedToken & b) {
+	// both give up on a bad input, their messages are not compared
+	if (a.end || b.end) return a.end == b.end && a.error == b.error;
+	
+	return a.kind == b.kind && a.text == b.text && a.name == b.name
+			&& a.line == b.line && a.column == b.column;
+}
+
+void LexerCheck::write(std::ostream & out, const LexedToken & token) {
+	if (token.error) out << "an error";
+	else if (token.end) out << "the end of the input";
+	else {
+		out << "\"" << token.text << "\" (kind " << token.kind << ") at " << token.name << ":"
+				<< token.line << ":" << token.column;
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef LEXER_CHECK_H
+#define LEXER_CHECK_H
+
+#include <iosfwd>
+#include <string>
+
+class CLexer;
+class Scanner;
+
+/*
+ * Lex a file with CLexer and with the automaton of c_scanner.bnf that it
+ * replaced, and compare the kind, the text and the location of each token.
+ * Only the tests use it (--check-lexer), the compiler does not load the
+ * automaton.
+ */
+class LexerCheck {
+	public:
+		// false if the tokens differ, where they differ is written to err
+		static bool check(const std::string & fileName, std::ostream & err);
+		
+	private:
+		struct LexedToken {
+			// no more tokens, or an error, ending the input
+			bool end;
+			bool error;
+			
+			unsigned int kind;
+			std::string text;
+			std::string name;
+			unsigned int line;
+			unsigned int column;
+		};
+		
+		// the next token of each side, an error is a token too
+		static void readScanner(Scanner & scanner, LexedToken & token);
+		static void readLexer(CLexer & lexer, LexedToken & token);
+		
+		static bool equals(const LexedToken & a, const LexedToken & b);
+		static void write(std::ostream & out, const LexedToken & token);
+		
+		LexerCheck();
+};
+
+#endif
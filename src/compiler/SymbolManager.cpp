@@ -5,7 +5,7 @@
 
 #include <cassert>
 
-SymbolManager::SymbolManager() {
+SymbolManager::SymbolManager(IdentifierTable & ids) : identifiers(ids) {
 	globalSymbols = new GlobalSymbolTable();
 	symbolTables.push_back(globalSymbols);
 }
@@ -31,7 +31,11 @@ GlobalSymbolTable *SymbolManager::getGlobalSymbolTable() const {
 	return globalSymbols;
 }
 
-bool SymbolManager::hasVariable(const std::string & var) const {
+SymbolManager::Id SymbolManager::getId(const std::string & name) const {
+	return identifiers.intern(name);
+}
+
+bool SymbolManager::hasVariable(Id var) const {
 	for (SymbolTableList::const_reverse_iterator it = symbolTables.rbegin(); it != symbolTables.rend(); ++it) {
 		if ((*it)->hasVariable(var)) return true;
 	}
@@ -39,7 +43,7 @@ bool SymbolManager::hasVariable(const std::string & var) const {
 	return false;
 }
 
-Pointer<Variable> SymbolManager::getVariable(const std::string & var) const {
+Pointer<Variable> SymbolManager::getVariable(Id var) const {
 	for (SymbolTableList::const_reverse_iterator it = symbolTables.rbegin(); it != symbolTables.rend(); ++it) {
 		if ((*it)->hasVariable(var)) return (*it)->getVariable(var);
 	}
@@ -47,7 +51,7 @@ Pointer<Variable> SymbolManager::getVariable(const std::string & var) const {
 	return NULL;
 }
 
-void SymbolManager::addVariable(const std::string & name, const Pointer<Variable> & var) {
+void SymbolManager::addVariable(Id name, const Pointer<Variable> & var) {
 	assert(!hasVariable(name));
 	
 	symbolTables.back()->addVariable(name, var);
@@ -2,6 +2,7 @@
 #define SYMBOL_MANAGER_H
 
 #include "compiler/Variable.h"
+#include "IdentifierTable.h"
 
 #include <parser/Pointer.h>
 
@@ -13,7 +14,9 @@ class SymbolTable;
 
 class SymbolManager {
 	public:
-		SymbolManager();
+		typedef IdentifierTable::Id Id;
+		
+		SymbolManager(IdentifierTable & ids);
 		~SymbolManager();
 		
 		void scopeBegin();
@@ -21,13 +24,18 @@ class SymbolManager {
 		
 		GlobalSymbolTable *getGlobalSymbolTable() const;
 		
-		bool hasVariable(const std::string & var) const;
-		Pointer<Variable> getVariable(const std::string & var) const;
-		void addVariable(const std::string & name, const Pointer<Variable> & var);
+		// the id of a name in the symbol tables, the name is hashed only here
+		Id getId(const std::string & name) const;
+		
+		bool hasVariable(Id var) const;
+		Pointer<Variable> getVariable(Id var) const;
+		void addVariable(Id name, const Pointer<Variable> & var);
 		
 	private:
 		typedef std::vector<SymbolTable *> SymbolTableList;
 		
+		IdentifierTable & identifiers;
+		
 		GlobalSymbolTable *globalSymbols;
 		SymbolTableList symbolTables;
 		
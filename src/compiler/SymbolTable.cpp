@@ -6,17 +6,17 @@ SymbolTable::SymbolTable() {}
 
 SymbolTable::~SymbolTable() {}
 
-bool SymbolTable::hasVariable(const std::string & var) const {
-	return variables.find(var) != variables.end();
+bool SymbolTable::hasVariable(Id var) const {
+	return variables.find(var) != NULL;
 }
 
-Pointer<Variable> SymbolTable::getVariable(const std::string & var) const {
-	VariableMap::const_iterator it = variables.find(var);
-	if (it != variables.end()) return it->second;
+Pointer<Variable> SymbolTable::getVariable(Id var) const {
+	const Pointer<Variable> *v = variables.find(var);
+	if (v) return *v;
 	return NULL;
 }
 
-void SymbolTable::addVariable(const std::string & name, const Pointer<Variable> & var) {
+void SymbolTable::addVariable(Id name, const Pointer<Variable> & var) {
 	assert(!hasVariable(name));
 	
 	variables[name] = var;
@@ -3,23 +3,25 @@
 
 #include "compiler/Type.h"
 #include "compiler/Variable.h"
+#include "IdentifierMap.h"
+#include "IdentifierTable.h"
 
 #include <parser/Pointer.h>
 
-#include <map>
-#include <string>
-
+// the names are ids of the IdentifierTable of the compilation
 class SymbolTable {
 	public:
+		typedef IdentifierTable::Id Id;
+		
 		SymbolTable();
 		virtual ~SymbolTable();
 		
-		bool hasVariable(const std::string & var) const;
-		Pointer<Variable> getVariable(const std::string & var) const;
-		void addVariable(const std::string & name, const Pointer<Variable> & var);
+		bool hasVariable(Id var) const;
+		Pointer<Variable> getVariable(Id var) const;
+		void addVariable(Id name, const Pointer<Variable> & var);
 		
 	private:
-		typedef std::map<std::string, Pointer<Variable> > VariableMap;
+		typedef IdentifierMap<Pointer<Variable> > VariableMap;
 		
 		VariableMap variables;
 };
@@ -0,0 +1,73 @@
+#include "compiler/TokenArena.h"
+
+#include <new>
+
+// a block holds a few hundred tokens
+#define ARENA_BLOCK_SIZE 65536
+
+// each token is preceded by where it comes from, the token keeps this alignment
+#define TOKEN_HEADER_SIZE 16
+
+enum TokenOrigin {
+	FROM_HEAP = 0,
+	FROM_ARENA
+};
+
+static __thread TokenArena *currentArena = NULL;
+
+TokenArena::TokenArena() : next(NULL), left(0) {}
+
+TokenArena::~TokenArena() {
+	for (BlockList::iterator it = blocks.begin(); it != blocks.end(); ++it) delete[](*it);
+}
+
+TokenArena::Scope::Scope(TokenArena *arena) : previous(currentArena) {
+	currentArena = arena;
+}
+
+TokenArena::Scope::~Scope() {
+	currentArena = previous;
+}
+
+void *TokenArena::allocateToken(size_t size) {
+	size += TOKEN_HEADER_SIZE;
+	
+	char *ptr;
+	if (currentArena) {
+		ptr = (char *)currentArena->allocate(size);
+		*(int *)ptr = FROM_ARENA;
+	}
+	else {
+		ptr = (char *)::operator new(size);
+		*(int *)ptr = FROM_HEAP;
+	}
+	
+	return ptr + TOKEN_HEADER_SIZE;
+}
+
+void TokenArena::deallocateToken(void *ptr) {
+	if (!ptr) return;
+	
+	// the token goes with its arena
+	char *start = (char *)ptr - TOKEN_HEADER_SIZE;
+	if (*(int *)start == FROM_HEAP) ::operator delete(start);
+}
+
+void *TokenArena::allocate(size_t size) {
+	size = (size + TOKEN_HEADER_SIZE - 1) / TOKEN_HEADER_SIZE * TOKEN_HEADER_SIZE;
+	
+	if (size > left) {
+		// a token bigger than a block gets its own
+		size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+		
+		next = new char[blockSize];
+		left = blockSize;
+		blocks.push_back(next);
+	}
+	
+	void *result = next;
+	next += size;
+	left -= size;
+	
+	return result;
+}
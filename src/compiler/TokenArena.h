@@ -0,0 +1,52 @@
+#ifndef TOKEN_ARENA_H
+#define TOKEN_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * The tokens of a translation unit (CToken and TypeToken), allocated one
+ * after the other in big blocks. Deleting a token runs its destructor but
+ * frees nothing, the blocks are freed at once with the arena, after the
+ * parsing tree.
+ *
+ * The tokens are made by the scanner, deep in libparser's Parser, so the
+ * arena is found through the thread: it is the current one while a Scope
+ * is alive. A token made with no current arena comes from the heap.
+ */
+class TokenArena {
+	public:
+		TokenArena();
+		~TokenArena();
+		
+		// the arena of the thread while it exists
+		class Scope {
+			public:
+				Scope(TokenArena *arena);
+				~Scope();
+				
+			private:
+				TokenArena *previous;
+		};
+		
+		// for the operators new and delete of the tokens
+		static void *allocateToken(size_t size);
+		static void deallocateToken(void *ptr);
+		
+	private:
+		typedef std::vector<char *> BlockList;
+		
+		// not copyable, the tokens point to the blocks
+		TokenArena(const TokenArena & other);
+		TokenArena & operator=(const TokenArena & other);
+		
+		void *allocate(size_t size);
+		
+		BlockList blocks;
+		
+		// the free space of the last block
+		char *next;
+		size_t left;
+};
+
+#endif
@@ -2,10 +2,10 @@
 
 #include "CParserBuffer.h"
 
-TypeToken::TypeToken(const Pointer<Type> & t) : ParsingTree::Token(CPARSERBUFFER_TOKEN_TYPE_NAME), type(t) {}
+TypeToken::TypeToken(const Pointer<Type> & t) : CToken(CPARSERBUFFER_TOKEN_TYPE_NAME), type(t) {}
 
 TypeToken::TypeToken(const Pointer<Type> & t, const std::string & tok, const InputLocation & location) :
-		ParsingTree::Token(CPARSERBUFFER_TOKEN_TYPE_NAME, tok, location), type(t) {}
+		CToken(CPARSERBUFFER_TOKEN_TYPE_NAME, tok, location), type(t) {}
 
 TypeToken::~TypeToken() {}
 
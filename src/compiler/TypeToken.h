@@ -1,15 +1,15 @@
 #ifndef TYPE_TOKEN_H
 #define TYPE_TOKEN_H
 
+#include "compiler/CToken.h"
 #include "compiler/Type.h"
 
-#include <parser/ParsingTree.h>
 #include <parser/Pointer.h>
 
 class Type;
 
-// a TYPE_NAME token
-class TypeToken : public ParsingTree::Token {
+// a TYPE_NAME token, allocated as the other tokens of the C code
+class TypeToken : public CToken {
 	public:
 		TypeToken(const Pointer<Type> & t);
 		TypeToken(const Pointer<Type> & t, const std::string & tok, const InputLocation & location);
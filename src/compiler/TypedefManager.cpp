@@ -3,7 +3,7 @@
 #include <cassert>
 #include <cstdlib>
 
-TypedefManager::TypedefManager() {
+TypedefManager::TypedefManager(IdentifierTable & ids) : identifiers(ids) {
 	// insert the root TypedefTable (global scope)
 	scopeBegin();
 }
@@ -25,7 +25,11 @@ void TypedefManager::scopeEnd() {
 	}
 }
 
-bool TypedefManager::isType(const std::string & name) const {
+TypedefManager::Id TypedefManager::getId(const std::string & name) const {
+	return identifiers.intern(name);
+}
+
+bool TypedefManager::isType(Id name) const {
 	for (TypedefTableList::const_reverse_iterator it = typedefs.rbegin(); it != typedefs.rend(); ++it) {
 		if (it->isType(name)) return true;
 	}
@@ -33,7 +37,7 @@ bool TypedefManager::isType(const std::string & name) const {
 	return false;
 }
 
-const Pointer<Type> & TypedefManager::getType(const std::string & name) const {
+const Pointer<Type> & TypedefManager::getType(Id name) const {
 	assert(isType(name));
 	
 	for (TypedefTableList::const_reverse_iterator it = typedefs.rbegin(); it != typedefs.rend(); ++it) {
@@ -45,7 +49,8 @@ const Pointer<Type> & TypedefManager::getType(const std::string & name) const {
 }
 
 void TypedefManager::typeDef(const std::string & name, const Pointer<Type> & t) {
-	assert(!isType(name));
+	Id id = getId(name);
+	assert(!isType(id));
 	
-	typedefs.back().typeDef(name, t);
+	typedefs.back().typeDef(id, t);
 }
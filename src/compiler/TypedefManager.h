@@ -3,29 +3,38 @@
 
 #include "compiler/Type.h"
 #include "compiler/TypedefTable.h"
+#include "IdentifierTable.h"
 
 #include <parser/Pointer.h>
 
+#include <string>
 #include <vector>
 
 class Type;
 
 class TypedefManager {
 	public:
-		TypedefManager();
+		typedef IdentifierTable::Id Id;
+		
+		TypedefManager(IdentifierTable & ids);
 		~TypedefManager();
 		
 		void scopeBegin();
 		void scopeEnd();
 		
-		bool isType(const std::string & name) const;
+		// the id of a name in the typedef tables, the name is hashed only here
+		Id getId(const std::string & name) const;
+		
+		bool isType(Id name) const;
 		
-		const Pointer<Type> & getType(const std::string & name) const;
+		const Pointer<Type> & getType(Id name) const;
 		void typeDef(const std::string & name, const Pointer<Type> & t);
 		
 	private:
 		typedef std::vector<TypedefTable> TypedefTableList;
 		
+		IdentifierTable & identifiers;
+		
 		TypedefTableList typedefs;
 		
 };
@@ -6,17 +6,17 @@ TypedefTable::TypedefTable() {}
 
 TypedefTable::~TypedefTable() {}
 
-bool TypedefTable::isType(const std::string & name) const {
-	return typeMap.find(name) != typeMap.end();
+bool TypedefTable::isType(Id name) const {
+	return typeMap.find(name) != NULL;
 }
 
-const Pointer<Type> & TypedefTable::getType(const std::string & name) const {
+const Pointer<Type> & TypedefTable::getType(Id name) const {
 	assert(isType(name));
 	
-	return typeMap.find(name)->second;
+	return *typeMap.find(name);
 }
 
-void TypedefTable::typeDef(const std::string & name, const Pointer<Type> & t) {
+void TypedefTable::typeDef(Id name, const Pointer<Type> & t) {
 	assert(!isType(name));
 	
 	typeMap[name] = t;
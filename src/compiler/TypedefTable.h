@@ -2,24 +2,26 @@
 #define TYPEDEF_TABLE_H
 
 #include "compiler/Type.h"
+#include "IdentifierMap.h"
+#include "IdentifierTable.h"
 
 #include <parser/Pointer.h>
 
-#include <map>
-#include <string>
-
+// the names are ids of the IdentifierTable of the compilation
 class TypedefTable {
 	public:
+		typedef IdentifierTable::Id Id;
+		
 		TypedefTable();
 		~TypedefTable();
 		
-		bool isType(const std::string & name) const;
+		bool isType(Id name) const;
 		
-		const Pointer<Type> & getType(const std::string & name) const;
-		void typeDef(const std::string & name, const Pointer<Type> & t);
+		const Pointer<Type> & getType(Id name) const;
+		void typeDef(Id name, const Pointer<Type> & t);
 		
 	private:
-		typedef std::map<std::string, Pointer<Type> > TypeMap;
+		typedef IdentifierMap<Pointer<Type> > TypeMap;
 		
 		TypeMap typeMap;
 };
@@ -1,11 +1,19 @@
 #include "ArgumentOptions.h"
 
 #include "compiler/Compiler.h"
+#include "compiler/LexerCheck.h"
 #include "linker/Assembler.h"
 #include "linker/Linker.h"
-#include "preprocessor/Preprocessor.h"
 #include "vm/Program.h"
+#include "preprocessor/PrecompiledHeader.h"
+#include "preprocessor/Preprocessor.h"
 #include "vm/VirtualMachine.h"
+#include "CompileServer.h"
+#include "MappedInput.h"
+#include "MemReport.h"
+#include "ObjectFile.h"
+#include "Pipeline.h"
+#include "TimeReport.h"
 #include "UccUtils.h"
 
 #include <parser/Input.h>
@@ -13,6 +21,7 @@
 #include <parser/ParserError.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -20,47 +29,89 @@
 typedef std::vector<Input *> InputList;
 typedef std::vector<Program *> ProgramList;
 
+static int compile(int argc, char *argv[], Preprocessor *preprocessor, Compiler *compiler);
+static bool isServerCommand(int argc, char *argv[]);
+
 static InputList getInputsToCompile(const ArgumentOptions & options);
 static InputList getInputsToLink(const ArgumentOptions & options);
+static ArgumentOptions::FileList getObjectsToLink(const ArgumentOptions & options);
 static Input *getInputToRun(const ArgumentOptions & options);
 
-static InputList runPreprocessor(const ArgumentOptions & options, const InputList & inputList);
-static ProgramList runCompiler(const ArgumentOptions & options, const InputList & inputList);
+static void precompileHeader(const ArgumentOptions & options, Preprocessor *preprocessor,
+		Compiler *compiler, TimeReport *timeReport);
+static bool checkLexer(const InputList & inputList);
 static void runAssembler(ProgramList & programs, const ArgumentOptions & options,
-		const InputList & inputList);
-static Program *runLinker(const ArgumentOptions & options, ProgramList & programList);
-static void runProgram(const ArgumentOptions & options, Program *program, bool force);
+		const InputList & inputList, TimeReport *timeReport);
+static void readObjects(ProgramList & programs, const ArgumentOptions::FileList & files,
+		TimeReport *timeReport);
+static Program *runLinker(const ArgumentOptions & options, ProgramList & programList,
+		TimeReport *timeReport);
+static void runProgram(const ArgumentOptions & options, Program *program, bool force,
+		const std::string & name, TimeReport *timeReport);
 
 int main(int argc, char *argv[]) {
+	// let a running server do the work, it has the tables loaded
+	const char *server = getenv("UCC_SERVER");
+	if (server && *server && !isServerCommand(argc, argv)) {
+		int status;
+		if (CompileServer::runClient(server, argc, argv, status)) return status;
+	}
+	
+	return compile(argc, argv, NULL, NULL);
+}
+
+static int compile(int argc, char *argv[], Preprocessor *preprocessor, Compiler *compiler) {
 	ArgumentOptions options(argc, argv);
 	
+	if (options.isServer()) return CompileServer(options, &compile).run();
+	
+	TimeReport report;
+	TimeReport *timeReport = options.isTimeReport() ? &report : NULL;
+	
+	if (options.isMemReport()) MemReport::enable();
+	
 	try {
 		InputList toCompile = getInputsToCompile(options);
 		InputList toLink = getInputsToLink(options);
+		ArgumentOptions::FileList objects = getObjectsToLink(options);
 		Input *executable = getInputToRun(options);
 		
 		Program *program = NULL;
 		
 		bool forceExecution = false;
+		std::string programName = options.getOutputFile();
 		
 		if (executable) {
-			if (!toCompile.empty() || !toLink.empty()) {
+			if (!toCompile.empty() || !toLink.empty() || !objects.empty()) {
 				std::cerr << "Cannot compile one file and run a precompiled one." << std::endl;
 				return -1;
 			}
 			
+			programName = executable->getInputName();
+			
+			TimeReport::Timer timer(timeReport, programName, TimeReport::ASSEMBLY);
 			program = Assembler().assemblyProgram(executable);
 			forceExecution = true;
 		}
+		else if (options.isPrecompileHeader()) {
+			precompileHeader(options, preprocessor, compiler, timeReport);
+		}
+		else if (options.isCheckLexer()) {
+			if (!checkLexer(toCompile)) return -1;
+		}
 		else {
-			InputList inputList = runPreprocessor(options, toCompile);
-			ProgramList programs = runCompiler(options, inputList);
-			runAssembler(programs, options, toLink);
+			Pipeline pipeline(options);
+			pipeline.setPreloaded(preprocessor, compiler);
+			pipeline.setTimeReport(timeReport);
 			
-			program = runLinker(options, programs);
+			ProgramList programs = pipeline.run(toCompile);
+			runAssembler(programs, options, toLink, timeReport);
+			readObjects(programs, objects, timeReport);
+			
+			program = runLinker(options, programs, timeReport);
 		}
 		
-		runProgram(options, program, forceExecution);
+		runProgram(options, program, forceExecution, programName, timeReport);
 	}
 	catch (ParserError & error) {
 		std::cerr << error.getMessage() << std::endl;
@@ -71,15 +122,36 @@ int main(int argc, char *argv[]) {
 		return -1;
 	}
 	
+	if (timeReport) {
+		if (options.isJsonTimeReport()) timeReport->showJsonReport(std::cerr);
+		else timeReport->showReport(std::cerr);
+	}
+	
+	if (options.isMemReport()) MemReport::showReport(std::cerr);
+	
 	return 0;
 }
 
+static bool isServerCommand(int argc, char *argv[]) {
+	for (int i = 1; i < argc; ++i) {
+		// the arguments after "--" are files
+		if (!strcmp(argv[i], "--")) break;
+		
+		// getopt_long takes both "--server <socket>" and "--server=<socket>"
+		if (!strcmp(argv[i], "--server") || !strncmp(argv[i], "--server=", strlen("--server="))) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
 static InputList getInputsToCompile(const ArgumentOptions & options) {
 	const ArgumentOptions::FileList & files = options.getFiles();
 	InputList result;
 	
 	for (ArgumentOptions::FileList::const_iterator it = files.begin(); it != files.end(); ++it) {
-		if (getFileUpperCaseExtension(*it) == "C") result.push_back(new FileInput(*it));
+		if (getFileUpperCaseExtension(*it) == "C") result.push_back(new MappedInput(*it));
 	}
 	
 	return result;
@@ -96,6 +168,17 @@ static InputList getInputsToLink(const ArgumentOptions & options) {
 	return result;
 }
 
+static ArgumentOptions::FileList getObjectsToLink(const ArgumentOptions & options) {
+	const ArgumentOptions::FileList & files = options.getFiles();
+	ArgumentOptions::FileList result;
+	
+	for (ArgumentOptions::FileList::const_iterator it = files.begin(); it != files.end(); ++it) {
+		if (getFileUpperCaseExtension(*it) == "UO") result.push_back(*it);
+	}
+	
+	return result;
+}
+
 static Input *getInputToRun(const ArgumentOptions & options) {
 	const ArgumentOptions::FileList & files = options.getFiles();
 	
@@ -107,91 +190,96 @@ static Input *getInputToRun(const ArgumentOptions & options) {
 	return NULL;
 }
 
-static InputList runPreprocessor(const ArgumentOptions & options, const InputList & inputList) {
-	InputList result;
+static void precompileHeader(const ArgumentOptions & options, Preprocessor *preprocessor,
+		Compiler *compiler, TimeReport *timeReport) {
 	
-	if (options.isPreprocess()) {
-		Preprocessor preprocessor(options.getIncludeDirs());
-		
-		for (InputList::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
-			result.push_back(preprocessor.preprocess(*it));
-		}
-	}
-	else result = inputList;
+	// the preloaded one was loaded with the include dirs of another command line
+	Preprocessor *ownPreprocessor = NULL;
+	if (preprocessor) preprocessor->setIncludeDirs(options.getIncludeDirs());
+	else preprocessor = ownPreprocessor = new Preprocessor(options.getIncludeDirs());
 	
-	return result;
-}
-
-static ProgramList runCompiler(const ArgumentOptions & options, const InputList & inputList) {
-	ProgramList programs;
+	Compiler *ownCompiler = NULL;
+	if (!compiler) compiler = ownCompiler = new Compiler();
 	
-	if (options.getStep() >= ArgumentOptions::COMPILE) {
-		Compiler compiler;
-		
-		programs.reserve(inputList.size());
-		
-		for (InputList::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
-			programs.push_back(compiler.compile(*it));
-		}
-	}
-	else if (options.getStep() >= ArgumentOptions::CHECK_SYNTAX) {
-		Compiler compiler;
+	preprocessor->setTimeReport(timeReport);
+	compiler->setTimeReport(timeReport);
+	
+	PrecompiledHeader *pch = NULL;
+	try {
+		pch = preprocessor->precompileHeader(options.getFiles().front());
 		
-		for (InputList::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
-			compiler.checkSyntax(*it);
+		// a header the compiler does not take is still precompiled for the preprocessor,
+		// the units compile its code themselves
+		try {
+			pch->setDeclarations(compiler->compileDeclarations(pch->getTokens()));
 		}
+		catch (ParserError &) {}
 		
-		std::cout << "OK" << std::endl;
+		pch->write(options.getPchFile());
 	}
-	else {
-		std::fstream output(options.getOutputFile(), std::ios::out);
-		
-		// just dump the inputs to the output
-		for (InputList::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
-			(*it)->dumpInput(output);
-			delete(*it);
-		}
-		
-		output.close();
+	catch (...) {
+		delete(pch);
+		delete(ownPreprocessor);
+		delete(ownCompiler);
+		throw;
 	}
 	
-	if (options.getStep() == ArgumentOptions::COMPILE) {
-		Assembler assembler;
-		
-		std::fstream output(options.getOutputFile(), std::ios::out);
-		
-		for (ProgramList::const_iterator it = programs.begin(); it != programs.end(); ++it) {
-			output << assembler.disassemblyProgram(*it);
-			delete(*it);
-		}
-		
-		output.close();
-		
-		programs.clear();
+	delete(pch);
+	delete(ownPreprocessor);
+	delete(ownCompiler);
+}
+
+static bool checkLexer(const InputList & inputList) {
+	bool result = true;
+	
+	// each file is read again by both sides, the inputs are only used for their names
+	for (InputList::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
+		if (!LexerCheck::check((*it)->getInputName(), std::cerr)) result = false;
+		delete(*it);
 	}
 	
-	return programs;
+	return result;
 }
 
 static void runAssembler(ProgramList & programs, const ArgumentOptions & options,
-		const InputList & inputList) {
+		const InputList & inputList, TimeReport *timeReport) {
 	
 	Assembler assembler;
 	
 	for (InputList::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
+		TimeReport::Timer timer(timeReport, (*it)->getInputName(), TimeReport::ASSEMBLY);
 		programs.push_back(assembler.assemblyProgram(*it));
 	}
 }
 
-static Program *runLinker(const ArgumentOptions & options, ProgramList & programList) {
+static void readObjects(ProgramList & programs, const ArgumentOptions::FileList & files,
+		TimeReport *timeReport) {
+	
+	ObjectFile objectFile;
+	
+	for (ArgumentOptions::FileList::const_iterator it = files.begin(); it != files.end(); ++it) {
+		TimeReport::Timer timer(timeReport, *it, TimeReport::ASSEMBLY);
+		ProgramList objects = objectFile.readPrograms(*it);
+		programs.insert(programs.end(), objects.begin(), objects.end());
+	}
+}
+
+static Program *runLinker(const ArgumentOptions & options, ProgramList & programList,
+		TimeReport *timeReport) {
+	
 	Program *program = NULL;
 	
 	if (options.getStep() >= ArgumentOptions::LINK) {
 		Linker linker;
 		
-		program = linker.linkProgram(programList);
+		{
+			TimeReport::Timer timer(timeReport, options.getOutputFile(), TimeReport::LINK);
+			program = linker.linkProgram(programList);
+		}
 		
 		if (options.getStep() == ArgumentOptions::LINK || options.outputDefined()) {
+			TimeReport::Timer timer(timeReport, options.getOutputFile(), TimeReport::ASSEMBLY);
+			
 			std::fstream output(options.getOutputFile(), std::ios::out);
 			
 			output << Assembler().disassemblyProgram(program);
@@ -203,8 +291,12 @@ static Program *runLinker(const ArgumentOptions & options, ProgramList & program
 	return program;
 }
 
-static void runProgram(const ArgumentOptions & options, Program *program, bool force) {
+static void runProgram(const ArgumentOptions & options, Program *program, bool force,
+		const std::string & name, TimeReport *timeReport) {
+	
 	if (options.getStep() >= ArgumentOptions::EXECUTE || force) {
+		TimeReport::Timer timer(timeReport, name, TimeReport::EXECUTION);
+		
 		VirtualMachine vm(program);
 		vm.setVerbose(options.isVerbose());
 		vm.run();
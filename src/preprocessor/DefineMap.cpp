@@ -1,10 +1,13 @@
 #include "preprocessor/DefineMap.h"
 
 #include "preprocessor/PreprocessorContext.h"
+#include "PreprocessorParserBuffer.h"
+#include "UccDefs.h"
 
 #include <parser/ParserError.h>
 
 #include <cassert>
+#include <cctype>
 
 // check if a macro name is valid
 inline static void checkMacroName(const std::string & name);
@@ -12,98 +15,104 @@ inline static void checkMacroName(const std::string & name);
 /*****************************************************************************
  * DefineMap::MacroToken
  *****************************************************************************/
-DefineMap::MacroToken::MacroToken() {}
+DefineMap::MacroToken::MacroToken(const std::string & t, Id id) : text(t), identifier(id),
+		parameter(false), parameterIndex(0) {}
 
-DefineMap::MacroToken::~MacroToken() {}
+DefineMap::MacroToken::MacroToken(unsigned int paramIndex) : identifier(IdentifierTable::NONE),
+		parameter(true), parameterIndex(paramIndex) {}
 
-/*****************************************************************************
- * DefineMap::MacroVariable
- *****************************************************************************/
-DefineMap::MacroVariable::MacroVariable(unsigned int varIndex) : variableIndex(varIndex) {}
-
-DefineMap::MacroVariable::~MacroVariable() {}
-
-std::string DefineMap::MacroVariable::expandToken(const ArgumentList & args) const {
-	assert(variableIndex < args.size());
-	return args[variableIndex];
+const std::string & DefineMap::MacroToken::getText() const {
+	return text;
 }
 
-/*****************************************************************************
- * DefineMap::MacroConstant
- *****************************************************************************/
-DefineMap::MacroConstant::MacroConstant(const std::string & c) : constant(c) {}
+bool DefineMap::MacroToken::isIdentifier() const {
+	return identifier != IdentifierTable::NONE;
+}
 
-DefineMap::MacroConstant::~MacroConstant() {}
+DefineMap::Id DefineMap::MacroToken::getIdentifier() const {
+	return identifier;
+}
 
-std::string DefineMap::MacroConstant::expandToken(const ArgumentList & args) const {
-	return constant;
+bool DefineMap::MacroToken::isParameter() const {
+	return parameter;
 }
 
+unsigned int DefineMap::MacroToken::getParameterIndex() const {
+	assert(parameter);
+	return parameterIndex;
+}
 
 /*****************************************************************************
  * DefineMap::Macro
  *****************************************************************************/
 DefineMap::Macro::Macro(unsigned int numVars) : numVariables(numVars) {}
 
-DefineMap::Macro::~Macro() {
-	for (MacroTokenList::iterator it = tokens.begin(); it != tokens.end(); ++it) {
-		delete(*it);
-	}
-}
+DefineMap::Macro::~Macro() {}
 
 void DefineMap::Macro::addVariable(unsigned int varIndex) {
 	assert(varIndex < numVariables);
-	tokens.push_back(new MacroVariable(varIndex));
+	tokens.push_back(MacroToken(varIndex));
 }
 
-void DefineMap::Macro::addConstant(const std::string & c) {
-	tokens.push_back(new MacroConstant(c));
+void DefineMap::Macro::addToken(const MacroToken & token) {
+	tokens.push_back(token);
 }
 
 unsigned int DefineMap::Macro::getVariablesCount() const {
 	return numVariables;
 }
 
+const DefineMap::MacroTokenList & DefineMap::Macro::getTokens() const {
+	return tokens;
+}
+
 std::string DefineMap::Macro::expandMacro(const ArgumentList & args) const {
 	std::string result;
 	
 	if (args.size() != numVariables) throw ParserError("Wrong number of arguments to macro");
 	
 	for (MacroTokenList::const_iterator it = tokens.begin(); it != tokens.end(); ++it) {
-		 result += (*it)->expandToken(args);
+		if (it->isParameter()) result += args[it->getParameterIndex()];
+		else result += it->getText();
+		result.push_back(DELIMITER);
 	}
 	
 	return result;
 }
 
+/*****************************************************************************
+ * DefineMap::Definition
+ *****************************************************************************/
+DefineMap::Definition::Definition() : stdDefine(NULL) {}
+
 /*****************************************************************************
  * DefineMap
  *****************************************************************************/
 DefineMap::DefineMap(const PreprocessorContext & pc) : preprocessorContext(pc) {
-	stdDefMap["__FILE__"] = &PreprocessorContext::define__FILE__;
-	stdDefMap["__LINE__"] = &PreprocessorContext::define__LINE__;
-	stdDefMap["__INCLUDE_LEVEL__"] = &PreprocessorContext::define__INCLUDE_LEVEL__;
-	stdDefMap["__DATE__"] = &PreprocessorContext::define__DATE__;
-	stdDefMap["__TIME__"] = &PreprocessorContext::define__TIME__;
-	stdDefMap["__STDC__"] = &PreprocessorContext::define__STDC__;
-	stdDefMap["__BASE_FILE__"] = &PreprocessorContext::define__BASE_FILE__;
-	stdDefMap["__VERSION__"] = &PreprocessorContext::define__VERSION__;
+	defineStd("__FILE__", &PreprocessorContext::define__FILE__);
+	defineStd("__LINE__", &PreprocessorContext::define__LINE__);
+	defineStd("__INCLUDE_LEVEL__", &PreprocessorContext::define__INCLUDE_LEVEL__);
+	defineStd("__DATE__", &PreprocessorContext::define__DATE__);
+	defineStd("__TIME__", &PreprocessorContext::define__TIME__);
+	defineStd("__STDC__", &PreprocessorContext::define__STDC__);
+	defineStd("__BASE_FILE__", &PreprocessorContext::define__BASE_FILE__);
+	defineStd("__VERSION__", &PreprocessorContext::define__VERSION__);
 	
 #ifdef __x86__
-	stdDefMap["__x86__"] = &PreprocessorContext::define__x86__;
+	defineStd("__x86__", &PreprocessorContext::define__x86__);
 #endif
 #ifdef __x86_64__
-	stdDefMap["__x86_64__"] = &PreprocessorContext::define__x86_64__;
+	defineStd("__x86_64__", &PreprocessorContext::define__x86_64__);
 #endif
 #ifdef __linux__
-	stdDefMap["__linux__"] = &PreprocessorContext::define__linux__;
+	defineStd("__linux__", &PreprocessorContext::define__linux__);
 #endif
 #ifdef __WIN32
-	stdDefMap["__WIN32"] = &PreprocessorContext::define__WIN32;
+	defineStd("__WIN32", &PreprocessorContext::define__WIN32);
 #endif
 	
 	// compatibility with libc
-	stdDefMap["__GNUC__"] = &PreprocessorContext::define__GNUC__;
+	defineStd("__GNUC__", &PreprocessorContext::define__GNUC__);
 	
 	// these are not hard defined, they exists only for compatibility with libc
 	define("__inline", "");
@@ -117,84 +126,162 @@ DefineMap::DefineMap(const PreprocessorContext & pc) : preprocessorContext(pc) {
 	defineMacro("__NTH", macroNTH);
 }
 
-DefineMap::~DefineMap() {
-	for (MacroMap::iterator it = macroMap.begin(); it != macroMap.end(); ++it) {
-		delete(it->second);
-	}
+DefineMap::~DefineMap() {}
+
+DefineMap::Id DefineMap::getId(const std::string & name) const {
+	return identifiers.intern(name);
 }
 
 std::string DefineMap::getDefine(const std::string & name) const {
-	checkMacroName(name);
+	return getDefine(getId(name));
+}
+
+std::string DefineMap::getDefine(Id name) const {
+	const Definition *def = definitions.find(name);
+	assert(def && !def->macro);
+	
+	if (def->stdDefine) return ((&preprocessorContext)->*def->stdDefine)();
 	
-	StdDefMap::const_iterator stdIt = stdDefMap.find(name);
-	if (stdIt != stdDefMap.end()) return ((&preprocessorContext)->*stdIt->second)();
+	std::string result;
+	for (MacroTokenList::const_iterator it = def->tokens.begin(); it != def->tokens.end(); ++it) {
+		if (it != def->tokens.begin()) result.push_back(DELIMITER);
+		result += it->getText();
+	}
 	
-	DefMap::const_iterator it = defMap.find(name);
-	assert(it != defMap.end());
-	return it->second;
+	return result;
+}
+
+const DefineMap::MacroTokenList *DefineMap::getDefineTokens(Id name) const {
+	const Definition *def = definitions.find(name);
+	if (!def || def->stdDefine || def->macro) return NULL;
+	return &def->tokens;
 }
 
 DefineMap::Macro *DefineMap::getMacro(const std::string & name) const {
-	MacroMap::const_iterator it = macroMap.find(name);
-	assert(it != macroMap.end());
-	return it->second;
+	return getMacro(getId(name));
 }
 
-bool DefineMap::isDefined(const std::string & name) const {
-	checkMacroName(name);
+DefineMap::Macro *DefineMap::getMacro(Id name) const {
+	const Definition *def = definitions.find(name);
+	assert(def && def->macro);
+	return def->macro.get();
+}
+
+DefineMap::NameList DefineMap::getDefinedNames() const {
+	NameList names;
 	
-	return defineDefined(name) || macroDefined(name);
+	// the ids are given in order, so this finds every name
+	for (Id id = 1; id <= identifiers.size(); ++id) {
+		const Definition *def = definitions.find(id);
+		if (def && !def->stdDefine) names.push_back(identifiers.getName(id));
+	}
+	
+	return names;
+}
+
+bool DefineMap::isDefined(const std::string & name) const {
+	return isDefined(getId(name));
 }
 
 bool DefineMap::stdDefDefined(const std::string & name) const {
-	checkMacroName(name);
-	
-	return stdDefMap.find(name) != stdDefMap.end();
+	const Definition *def = definitions.find(getId(name));
+	return def && def->stdDefine;
 }
 
 bool DefineMap::defineDefined(const std::string & name) const {
-	checkMacroName(name);
-	
-	StdDefMap::const_iterator stdIt = stdDefMap.find(name);
-	DefMap::const_iterator it = defMap.find(name);
-	
-	return stdIt != stdDefMap.end() || it != defMap.end();
+	return defineDefined(getId(name));
 }
 
 bool DefineMap::macroDefined(const std::string & name) const {
-	checkMacroName(name);
-	
-	MacroMap::const_iterator it = macroMap.find(name);
-	return it != macroMap.end();
+	return macroDefined(getId(name));
+}
+
+bool DefineMap::isDefined(Id name) const {
+	return definitions.find(name) != NULL;
+}
+
+bool DefineMap::defineDefined(Id name) const {
+	const Definition *def = definitions.find(name);
+	return def && !def->macro;
+}
+
+bool DefineMap::macroDefined(Id name) const {
+	const Definition *def = definitions.find(name);
+	return def && def->macro;
 }
 
 void DefineMap::define(const std::string & name, const std::string & value) {
+	MacroTokenList tokens;
+	
+	std::string::size_type end = 0;
+	for (;;) {
+		std::string::size_type begin = value.find_first_not_of(" \t", end);
+		if (begin == std::string::npos) break;
+		
+		end = value.find_first_of(" \t", begin);
+		std::string token = value.substr(begin, end - begin);
+		bool identifier = isalpha(token[0]) || token[0] == '_';
+		tokens.push_back(MacroToken(token, identifier ? getId(token) : IdentifierTable::NONE));
+	}
+	
+	define(name, tokens);
+}
+
+void DefineMap::define(const std::string & name, const MacroTokenList & value) {
 	checkMacroName(name);
 	
 	if (stdDefDefined(name)) return;
 	
-	if (isDefined(name)) undef(name);
-	defMap[name] = value;
+	Definition & def = definitions[getId(name)];
+	def.macro = NULL;
+	def.tokens = value;
 }
 
 void DefineMap::defineMacro(const std::string & name, Macro *macro) {
 	checkMacroName(name);
 	
-	if (stdDefDefined(name)) return;
+	if (stdDefDefined(name)) {
+		delete(macro);
+		return;
+	}
 	
-	if (isDefined(name)) undef(name);
-	macroMap[name] = macro;
+	Definition & def = definitions[getId(name)];
+	def.macro = macro;
+	def.tokens.clear();
 }
 
 void DefineMap::undef(const std::string & name) {
 	checkMacroName(name);
 	assert(isDefined(name));
 	
-	DefMap::iterator it = defMap.find(name);
-	if (it != defMap.end()) defMap.erase(it);
-	else {
-		MacroMap::iterator mIt = macroMap.find(name);
-		macroMap.erase(mIt);
+	definitions.erase(getId(name));
+}
+
+void DefineMap::defineStd(const std::string & name, StdDefine stdDefine) {
+	definitions[getId(name)].stdDefine = stdDefine;
+}
+
+void DefineMap::appendToken(MacroTokenList & tokens, ParsingTree::Token *token) const {
+	const std::string & tok = token->getToken();
+	
+	switch (token->getTokenTypeId()) {
+		case PREPROCESSORPARSERBUFFER_TOKEN_IDENTIFIER:
+			tokens.push_back(MacroToken(tok, getId(tok)));
+			break;
+		case PREPROCESSORPARSERBUFFER_TOKEN_MACRO:
+		{
+			std::string name = tok.substr(0, tok.size() - 1);
+			tokens.push_back(MacroToken(name, getId(name)));
+			tokens.push_back(MacroToken("("));
+			break;
+		}
+		case PREPROCESSORPARSERBUFFER_TOKEN_DEFINED_M:
+			tokens.push_back(MacroToken(tok.substr(0, tok.size() - 1)));
+			tokens.push_back(MacroToken("("));
+			break;
+		default:
+			tokens.push_back(MacroToken(tok));
+			break;
 	}
 }
 
@@ -1,7 +1,12 @@
 #ifndef DEFINE_MAP_H
 #define DEFINE_MAP_H
 
-#include <map>
+#include "IdentifierMap.h"
+#include "IdentifierTable.h"
+
+#include <parser/ParsingTree.h>
+#include <parser/Pointer.h>
+
 #include <string>
 #include <vector>
 
@@ -10,37 +15,34 @@ class PreprocessorContext;
 class DefineMap {
 	public:
 		typedef std::vector<std::string> ArgumentList;
+		typedef std::vector<std::string> NameList;
+		typedef IdentifierTable::Id Id;
 		
+		// a token of the value of a define or macro, lexed when it is defined
 		class MacroToken {
 			public:
-				MacroToken();
-				virtual ~MacroToken();
+				// id is NONE if the token is not an identifier
+				MacroToken(const std::string & t, Id id = IdentifierTable::NONE);
 				
-				virtual std::string expandToken(const ArgumentList & args) const = 0;
-		};
-		typedef std::vector<MacroToken *> MacroTokenList;
-		
-		class MacroVariable : public MacroToken {
-			public:
-				MacroVariable(unsigned int varIndex);
-				virtual ~MacroVariable();
+				// a parameter of the macro, replaced by its argument
+				MacroToken(unsigned int paramIndex);
 				
-				virtual std::string expandToken(const ArgumentList & args) const;
+				const std::string & getText() const;
 				
-			private:
-				unsigned int variableIndex;
-		};
-		
-		class MacroConstant : public MacroToken {
-			public:
-				MacroConstant(const std::string & c);
-				virtual ~MacroConstant();
+				// only identifiers can be expanded
+				bool isIdentifier() const;
+				Id getIdentifier() const;
 				
-				virtual std::string expandToken(const ArgumentList & args) const;
+				bool isParameter() const;
+				unsigned int getParameterIndex() const;
 				
 			private:
-				std::string constant;
+				std::string text;
+				Id identifier;
+				bool parameter;
+				unsigned int parameterIndex;
 		};
+		typedef std::vector<MacroToken> MacroTokenList;
 		
 		class Macro {
 			public:
@@ -48,10 +50,12 @@ class DefineMap {
 				~Macro();
 				
 				void addVariable(unsigned int varIndex);
-				void addConstant(const std::string & c);
+				void addToken(const MacroToken & token);
 				
 				unsigned int getVariablesCount() const;
+				const MacroTokenList & getTokens() const;
 				
+				// the value with the arguments replaced, as text
 				std::string expandMacro(const ArgumentList & args) const;
 				
 			private:
@@ -59,35 +63,74 @@ class DefineMap {
 				
 				MacroTokenList tokens;
 		};
-		typedef std::map<std::string, Macro *> MacroMap;
 		
 		DefineMap(const PreprocessorContext & pc);
 		~DefineMap();
 		
+		// the id of a name, the tokens of the macros have it already
+		Id getId(const std::string & name) const;
+		
 		bool isDefined(const std::string & name) const;
 		bool stdDefDefined(const std::string & name) const;
 		bool defineDefined(const std::string & name) const;
 		bool macroDefined(const std::string & name) const;
 		
+		bool isDefined(Id name) const;
+		bool defineDefined(Id name) const;
+		bool macroDefined(Id name) const;
+		
 		std::string getDefine(const std::string & name) const;
+		std::string getDefine(Id name) const;
+		
+		// NULL for the standard defines, their value is computed when used
+		const MacroTokenList *getDefineTokens(Id name) const;
+		
 		Macro *getMacro(const std::string & name) const;
+		Macro *getMacro(Id name) const;
+		
+		// the defines and macros, without the standard defines
+		NameList getDefinedNames() const;
 		
+		// the value is split at the white spaces
 		void define(const std::string & name, const std::string & value);
+		void define(const std::string & name, const MacroTokenList & value);
 		void defineMacro(const std::string & name, Macro *macro);
 		
 		void undef(const std::string & name);
 		
+		/*
+		 * Append a token read by the preprocessor scanner, a MACRO token
+		 * ("name(") is split in the identifier and the '('.
+		 */
+		void appendToken(MacroTokenList & tokens, ParsingTree::Token *token) const;
+		
 	private:
-		typedef std::map<std::string, std::string> DefMap;
+		// Madness? THIS IS MEMBER FUNCTION POINTER!!!
+		typedef std::string (PreprocessorContext::*StdDefine)() const;
+		
+		// a standard define, a define or a macro, in a single lookup
+		struct Definition {
+			Definition();
+			
+			// NULL if it is not a standard define
+			StdDefine stdDefine;
+			
+			// NULL if it is not a macro
+			Pointer<Macro> macro;
+			
+			// the value of a define
+			MacroTokenList tokens;
+		};
+		typedef IdentifierMap<Definition> DefinitionMap;
 		
-		// Madness? THIS IS MEMBER FUNCTION POINTER MAP!!!
-		typedef std::map<std::string, std::string (PreprocessorContext::*)() const> StdDefMap;
+		void defineStd(const std::string & name, StdDefine stdDefine);
 		
 		const PreprocessorContext & preprocessorContext;
 		
-		StdDefMap stdDefMap;
-		DefMap defMap;
-		MacroMap macroMap;
+		// interned as the tokens are lexed, so it changes in const methods
+		mutable IdentifierTable identifiers;
+		
+		DefinitionMap definitions;
 };
 
 #endif
@@ -0,0 +1,80 @@
+#include "preprocessor/IncludeResolver.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+IncludeResolver::IncludeResolver() {
+	pthread_mutex_init(&mutex, NULL);
+}
+
+IncludeResolver::~IncludeResolver() {
+	pthread_mutex_destroy(&mutex);
+}
+
+std::string IncludeResolver::find(const FileList & dirs, const std::string & name) {
+	std::string result;
+	
+	pthread_mutex_lock(&mutex);
+	
+	for (FileList::const_iterator it = dirs.begin(); it != dirs.end(); ++it) {
+		if (exists(*it + name)) {
+			result = *it + name;
+			break;
+		}
+	}
+	
+	pthread_mutex_unlock(&mutex);
+	
+	return result;
+}
+
+void IncludeResolver::clear() {
+	pthread_mutex_lock(&mutex);
+	directories.clear();
+	paths.clear();
+	pthread_mutex_unlock(&mutex);
+}
+
+bool IncludeResolver::exists(const std::string & path) {
+	PathMap::const_iterator it = paths.find(path);
+	if (it != paths.end()) return it->second;
+	
+	// the name may have directories too (like sys/types.h)
+	std::string::size_type slash = path.rfind('/');
+	std::string dir = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+	std::string file = path.substr(dir.size());
+	
+	bool found = getDirectory(dir).count(file) > 0;
+	paths[path] = found;
+	
+	return found;
+}
+
+const IncludeResolver::FileSet & IncludeResolver::getDirectory(const std::string & dir) {
+	DirectoryMap::const_iterator it = directories.find(dir);
+	if (it != directories.end()) return it->second;
+	
+	FileSet & files = directories[dir];
+	
+	DIR *d = opendir(dir.empty() ? "." : dir.c_str());
+	if (!d) return files;
+	
+	struct dirent *ent;
+	while ((ent = readdir(d))) {
+		bool regular = ent->d_type == DT_REG;
+		
+		// a link (or a file system without the type) needs a stat
+		if (ent->d_type != DT_REG && ent->d_type != DT_DIR) {
+			struct stat st;
+			std::string file = dir + ent->d_name;
+			regular = stat(file.c_str(), &st) == 0 && !S_ISDIR(st.st_mode);
+		}
+		
+		if (regular) files.insert(ent->d_name);
+	}
+	
+	closedir(d);
+	
+	return files;
+}
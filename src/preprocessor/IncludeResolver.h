@@ -0,0 +1,50 @@
+#ifndef INCLUDE_RESOLVER_H
+#define INCLUDE_RESOLVER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+/*
+ * Find the included files by listing each directory once, instead of
+ * trying to open the file in every include directory. The answer for each
+ * path is kept, found or not, so an include seen before is a lookup.
+ *
+ * The preprocessors of all the threads can share one.
+ */
+class IncludeResolver {
+	public:
+		typedef std::vector<std::string> FileList;
+		
+		IncludeResolver();
+		~IncludeResolver();
+		
+		// the path of name in the first of dirs that has it, empty if none has it
+		std::string find(const FileList & dirs, const std::string & name);
+		
+		// forget the directories listed, their files may have changed
+		void clear();
+		
+	private:
+		typedef std::set<std::string> FileSet;
+		typedef std::map<std::string, FileSet> DirectoryMap;
+		typedef std::map<std::string, bool> PathMap;
+		
+		// the mutex must be locked
+		bool exists(const std::string & path);
+		const FileSet & getDirectory(const std::string & dir);
+		
+		pthread_mutex_t mutex;
+		
+		// the files (not the subdirectories) of each directory listed,
+		// none if it cannot be opened
+		DirectoryMap directories;
+		
+		// every path looked up
+		PathMap paths;
+};
+
+#endif
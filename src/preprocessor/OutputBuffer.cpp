@@ -0,0 +1,78 @@
+#include "preprocessor/OutputBuffer.h"
+
+#include "MemReport.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#define OUTPUT_BLOCK_SIZE 16384
+
+OutputBuffer::OutputBuffer() : length(0), next(NULL), left(0) {}
+
+OutputBuffer::~OutputBuffer() {
+	for (BlockList::iterator it = blocks.begin(); it != blocks.end(); ++it) delete[](*it);
+}
+
+void OutputBuffer::append(const std::string & text) {
+	const char *data = text.data();
+	unsigned long count = text.size();
+	
+	while (count > 0) {
+		if (!left) addBlock();
+		
+		unsigned long n = std::min(count, left);
+		memcpy(next, data, n);
+		
+		next += n;
+		left -= n;
+		length += n;
+		data += n;
+		count -= n;
+	}
+}
+
+void OutputBuffer::push_back(char c) {
+	if (!left) addBlock();
+	
+	*next++ = c;
+	--left;
+	++length;
+}
+
+unsigned long OutputBuffer::size() const {
+	return length;
+}
+
+const char *OutputBuffer::getData(unsigned long position, unsigned long & len) const {
+	assert(position < length);
+	
+	unsigned long offset = position % OUTPUT_BLOCK_SIZE;
+	len = std::min(length - position, OUTPUT_BLOCK_SIZE - offset);
+	
+	return blocks[position / OUTPUT_BLOCK_SIZE] + offset;
+}
+
+std::string OutputBuffer::getText(unsigned long begin, unsigned long end) const {
+	std::string result;
+	result.reserve(end - begin);
+	
+	while (begin < end) {
+		unsigned long len;
+		const char *data = getData(begin, len);
+		
+		len = std::min(len, end - begin);
+		result.append(data, len);
+		begin += len;
+	}
+	
+	return result;
+}
+
+void OutputBuffer::addBlock() {
+	next = new char[OUTPUT_BLOCK_SIZE];
+	left = OUTPUT_BLOCK_SIZE;
+	blocks.push_back(next);
+	
+	MemReport::addConsumer(MemReport::PREPROCESSOR_BUFFERS, OUTPUT_BLOCK_SIZE);
+}
@@ -0,0 +1,46 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <string>
+#include <vector>
+
+/*
+ * The preprocessed code of an input, written in blocks of a fixed size. The
+ * blocks are never moved or reallocated, the text is only appended, so the
+ * chunks of the output read it in place (see OutputBufferInput).
+ */
+class OutputBuffer {
+	public:
+		OutputBuffer();
+		~OutputBuffer();
+		
+		void append(const std::string & text);
+		void push_back(char c);
+		
+		unsigned long size() const;
+		
+		// the text from position to the end of its block, len is set to its size
+		const char *getData(unsigned long position, unsigned long & len) const;
+		
+		// a copy of the text in [begin, end)
+		std::string getText(unsigned long begin, unsigned long end) const;
+		
+	private:
+		typedef std::vector<char *> BlockList;
+		
+		// not copyable, the inputs point to the blocks
+		OutputBuffer(const OutputBuffer & other);
+		OutputBuffer & operator=(const OutputBuffer & other);
+		
+		void addBlock();
+		
+		BlockList blocks;
+		
+		unsigned long length;
+		
+		// the free space of the last block
+		char *next;
+		unsigned long left;
+};
+
+#endif
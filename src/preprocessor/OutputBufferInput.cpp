@@ -0,0 +1,40 @@
+#include "preprocessor/OutputBufferInput.h"
+
+#include <algorithm>
+
+OutputBufferInput::OutputBufferInput(const Pointer<OutputBuffer> & buffer, unsigned long begin,
+		unsigned long e) : outputBuffer(buffer), position(begin), end(e), data(NULL), left(0),
+		line(0), column(0), newLine(true) {}
+
+OutputBufferInput::~OutputBufferInput() {}
+
+char OutputBufferInput::nextChar() {
+	if (!left) {
+		if (position >= end) return 0;
+		
+		// the next block of the chunk
+		data = outputBuffer->getData(position, left);
+		left = std::min(left, end - position);
+		position += left;
+	}
+	
+	char c = *data++;
+	--left;
+	
+	if (newLine) {
+		++line;
+		column = 0;
+	}
+	++column;
+	newLine = c == '\n';
+	
+	return c;
+}
+
+unsigned int OutputBufferInput::getInputLine() const {
+	return line;
+}
+
+InputLocation OutputBufferInput::getCurrentLocation() const {
+	return InputLocation(getInputName(), line, column);
+}
@@ -0,0 +1,42 @@
+#ifndef OUTPUT_BUFFER_INPUT_H
+#define OUTPUT_BUFFER_INPUT_H
+
+#include "preprocessor/OutputBuffer.h"
+
+#include <parser/Input.h>
+#include <parser/Pointer.h>
+
+/*
+ * A chunk of the preprocessed code, read in place from the blocks of its
+ * OutputBuffer. The lines are counted from 1, the name and the first line
+ * of the chunk are given by the OffsetInput around it.
+ */
+class OutputBufferInput : public Input {
+	public:
+		// the text in [begin, end) of buffer
+		OutputBufferInput(const Pointer<OutputBuffer> & buffer, unsigned long begin, unsigned long end);
+		virtual ~OutputBufferInput();
+		
+		// '\0' at the end of the chunk
+		virtual char nextChar();
+		
+		virtual unsigned int getInputLine() const;
+		virtual InputLocation getCurrentLocation() const;
+		
+	private:
+		Pointer<OutputBuffer> outputBuffer;
+		
+		unsigned long position;
+		unsigned long end;
+		
+		// the rest of the current block
+		const char *data;
+		unsigned long left;
+		
+		// the location of the last character read
+		unsigned int line;
+		unsigned int column;
+		bool newLine;
+};
+
+#endif
@@ -0,0 +1,448 @@
+#include "preprocessor/PrecompiledHeader.h"
+
+#include "preprocessor/PreprocessorContext.h"
+#include "UccDefs.h"
+
+#include <parser/ListInput.h>
+#include <parser/MemoryInput.h>
+#include <parser/OffsetInput.h>
+#include <parser/ParserError.h>
+
+#include <fstream>
+#include <map>
+
+#include <sys/stat.h>
+
+#define PCH_MAGIC "UCCH"
+#define PCH_MAGIC_SIZE 4
+#define PCH_VERSION 3
+
+enum TokenKind {
+	TOKEN_TEXT = 0,
+	TOKEN_IDENTIFIER,
+	TOKEN_PARAMETER
+};
+
+static void writeInt(std::string & buf, unsigned int value);
+static void writeString(std::string & buf, const std::string & str);
+
+/*****************************************************************************
+ * PrecompiledHeader::Reader
+ *****************************************************************************/
+class PrecompiledHeader::Reader {
+	public:
+		Reader(const std::string & name, const std::string & buf);
+		
+		PrecompiledHeader *readHeader();
+		
+	private:
+		unsigned int readByte();
+		unsigned int readInt();
+		std::string readString();
+		
+		// a number of items of at least itemSize bytes each, that the bytes left can hold
+		unsigned int readCount(unsigned int itemSize);
+		
+		void require(unsigned int size);
+		void invalid() const;
+		
+		const std::string & fileName;
+		const std::string & buffer;
+		unsigned int position;
+};
+
+PrecompiledHeader::Reader::Reader(const std::string & name, const std::string & buf) :
+		fileName(name), buffer(buf), position(0) {}
+		
+PrecompiledHeader *PrecompiledHeader::Reader::readHeader() {
+	require(PCH_MAGIC_SIZE);
+	if (buffer.compare(0, PCH_MAGIC_SIZE, PCH_MAGIC)) invalid();
+	position += PCH_MAGIC_SIZE;
+	
+	if (readInt() != PCH_VERSION || readString() != UCC_VERSION) {
+		throw ParserError(fileName + ": precompiled header made by another version.");
+	}
+	
+	std::string header = readString();
+	
+	FileList includeDirs(readCount(4));
+	for (FileList::iterator it = includeDirs.begin(); it != includeDirs.end(); ++it) {
+		*it = readString();
+	}
+	
+	PrecompiledHeader *pch = new PrecompiledHeader(header, includeDirs);
+	
+	try {
+		pch->dependencies.resize(readCount(5));
+		for (DependencyList::iterator it = pch->dependencies.begin(); it != pch->dependencies.end(); ++it) {
+			it->file = readString();
+			it->system = readByte();
+		}
+		
+		pch->includeOnce.resize(readCount(4));
+		for (FileList::iterator it = pch->includeOnce.begin(); it != pch->includeOnce.end(); ++it) {
+			*it = readString();
+		}
+		
+		pch->definitions.resize(readCount(13));
+		for (DefinitionList::iterator it = pch->definitions.begin(); it != pch->definitions.end(); ++it) {
+			it->name = readString();
+			it->macro = readByte();
+			it->variables = readInt();
+			
+			unsigned int tokenCount = readCount(5);
+			it->tokens.reserve(tokenCount);
+			for (unsigned int i = 0; i < tokenCount; ++i) {
+				switch (readByte()) {
+					case TOKEN_TEXT:
+						it->tokens.push_back(DefineMap::MacroToken(readString()));
+						break;
+					case TOKEN_IDENTIFIER:
+						// only an identifier or not, the ids are interned again when applied
+						it->tokens.push_back(DefineMap::MacroToken(readString(), 1));
+						break;
+					case TOKEN_PARAMETER:
+					{
+						unsigned int index = readInt();
+						if (index >= it->variables) invalid();
+						it->tokens.push_back(DefineMap::MacroToken(index));
+						break;
+					}
+					default:
+						invalid();
+				}
+			}
+		}
+		
+		pch->chunks.resize(readCount(12));
+		for (ChunkList::iterator it = pch->chunks.begin(); it != pch->chunks.end(); ++it) {
+			it->name = readString();
+			it->line = readInt();
+			it->code = readString();
+		}
+		
+		FileList tokenFiles(readCount(4));
+		for (FileList::iterator it = tokenFiles.begin(); it != tokenFiles.end(); ++it) {
+			*it = readString();
+		}
+		
+		unsigned int tokenCount = readCount(16);
+		for (unsigned int i = 0; i < tokenCount; ++i) {
+			std::string tok = readString();
+			
+			unsigned int file = readInt();
+			if (file >= tokenFiles.size()) invalid();
+			
+			unsigned int line = readInt();
+			unsigned int column = readInt();
+			pch->tokens.addToken(tok, tokenFiles[file], line, column);
+		}
+		
+		// the compiler checks them when they are restored
+		pch->declarations = readString();
+		
+		if (position != buffer.size()) invalid();
+	}
+	catch (...) {
+		delete(pch);
+		throw;
+	}
+	
+	return pch;
+}
+
+unsigned int PrecompiledHeader::Reader::readByte() {
+	require(1);
+	return (unsigned char)buffer[position++];
+}
+
+unsigned int PrecompiledHeader::Reader::readInt() {
+	require(4);
+	
+	unsigned int value = 0;
+	for (unsigned int i = 0; i < 4; ++i) value |= (unsigned int)(unsigned char)buffer[position++] << (i * 8);
+	
+	return value;
+}
+
+std::string PrecompiledHeader::Reader::readString() {
+	unsigned int len = readInt();
+	require(len);
+	
+	std::string str = buffer.substr(position, len);
+	position += len;
+	
+	return str;
+}
+
+unsigned int PrecompiledHeader::Reader::readCount(unsigned int itemSize) {
+	unsigned int count = readInt();
+	
+	// checked before anything is allocated for them
+	if (count > (buffer.size() - position) / itemSize) invalid();
+	
+	return count;
+}
+
+void PrecompiledHeader::Reader::require(unsigned int size) {
+	if (buffer.size() - position < size) invalid();
+}
+
+void PrecompiledHeader::Reader::invalid() const {
+	throw ParserError(fileName + ": invalid precompiled header.");
+}
+
+/*****************************************************************************
+ * PrecompiledHeader
+ *****************************************************************************/
+PrecompiledHeader::PrecompiledHeader(const std::string & hdr, const FileList & inclDirs) :
+		header(hdr), includeDirs(inclDirs), tokens(hdr) {}
+		
+PrecompiledHeader::~PrecompiledHeader() {}
+
+const std::string & PrecompiledHeader::getHeader() const {
+	return header;
+}
+
+const TokenStream & PrecompiledHeader::getTokens() const {
+	return tokens;
+}
+
+const std::string & PrecompiledHeader::getDeclarations() const {
+	return declarations;
+}
+
+void PrecompiledHeader::setDeclarations(const std::string & decls) {
+	declarations = decls;
+}
+
+void PrecompiledHeader::addChunk(const std::string & name, unsigned int line, const std::string & code) {
+	Chunk chunk;
+	chunk.name = name;
+	chunk.line = line;
+	chunk.code = code;
+	chunks.push_back(chunk);
+}
+
+TokenStream *PrecompiledHeader::getTokenOutput() {
+	return &tokens;
+}
+
+void PrecompiledHeader::addDependency(const std::string & file, bool system) {
+	Dependency dependency;
+	dependency.file = file;
+	dependency.system = system;
+	dependencies.push_back(dependency);
+}
+
+void PrecompiledHeader::addIncludeOnce(const std::string & file) {
+	includeOnce.push_back(file);
+}
+
+void PrecompiledHeader::setDefinitions(const DefineMap & defineMap) {
+	definitions.clear();
+	
+	DefineMap::NameList names = defineMap.getDefinedNames();
+	for (DefineMap::NameList::const_iterator it = names.begin(); it != names.end(); ++it) {
+		Definition definition;
+		definition.name = *it;
+		definition.macro = defineMap.macroDefined(*it);
+		
+		if (definition.macro) {
+			DefineMap::Macro *macro = defineMap.getMacro(*it);
+			definition.variables = macro->getVariablesCount();
+			definition.tokens = macro->getTokens();
+		}
+		else {
+			definition.variables = 0;
+			definition.tokens = *defineMap.getDefineTokens(defineMap.getId(*it));
+		}
+		
+		definitions.push_back(definition);
+	}
+}
+
+void PrecompiledHeader::apply(PreprocessorContext & context, DefineMap & defineMap,
+		ListInput *output, TokenStream *tokenOutput) const {
+		
+	for (DependencyList::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it) {
+		context.addDependency(it->file, it->system);
+	}
+	
+	for (FileList::const_iterator it = includeOnce.begin(); it != includeOnce.end(); ++it) {
+		context.setIncludeOnce(*it);
+	}
+	
+	// the header may have undefined some of the initial defines
+	DefineMap::NameList names = defineMap.getDefinedNames();
+	for (DefineMap::NameList::const_iterator it = names.begin(); it != names.end(); ++it) {
+		defineMap.undef(*it);
+	}
+	
+	for (DefinitionList::const_iterator it = definitions.begin(); it != definitions.end(); ++it) {
+		DefineMap::MacroTokenList tokens;
+		tokens.reserve(it->tokens.size());
+		
+		for (DefineMap::MacroTokenList::const_iterator tokIt = it->tokens.begin();
+				tokIt != it->tokens.end(); ++tokIt) {
+	
+			if (!tokIt->isIdentifier()) tokens.push_back(*tokIt);
+			else tokens.push_back(DefineMap::MacroToken(tokIt->getText(), defineMap.getId(tokIt->getText())));
+		}
+		
+		if (it->macro) {
+			DefineMap::Macro *macro = new DefineMap::Macro(it->variables);
+			for (DefineMap::MacroTokenList::const_iterator tokIt = tokens.begin(); tokIt != tokens.end(); ++tokIt) {
+				macro->addToken(*tokIt);
+			}
+			defineMap.defineMacro(it->name, macro);
+		}
+		else defineMap.define(it->name, tokens);
+	}
+	
+	if (tokenOutput) {
+		tokenOutput->append(tokens);
+		return;
+	}
+	
+	for (ChunkList::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+		OffsetInput *in = new OffsetInput(new MemoryInput(it->code), it->line - 1, it->name);
+		in->setRenameInput(true);
+		output->addInput(in);
+	}
+}
+
+void PrecompiledHeader::write(const std::string & fileName) const {
+	std::string buf(PCH_MAGIC);
+	writeInt(buf, PCH_VERSION);
+	writeString(buf, UCC_VERSION);
+	
+	writeString(buf, header);
+	
+	writeInt(buf, includeDirs.size());
+	for (FileList::const_iterator it = includeDirs.begin(); it != includeDirs.end(); ++it) {
+		writeString(buf, *it);
+	}
+	
+	writeInt(buf, dependencies.size());
+	for (DependencyList::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it) {
+		writeString(buf, it->file);
+		buf.push_back(it->system);
+	}
+	
+	writeInt(buf, includeOnce.size());
+	for (FileList::const_iterator it = includeOnce.begin(); it != includeOnce.end(); ++it) {
+		writeString(buf, *it);
+	}
+	
+	writeInt(buf, definitions.size());
+	for (DefinitionList::const_iterator it = definitions.begin(); it != definitions.end(); ++it) {
+		writeString(buf, it->name);
+		buf.push_back(it->macro);
+		writeInt(buf, it->variables);
+		
+		writeInt(buf, it->tokens.size());
+		for (DefineMap::MacroTokenList::const_iterator tokIt = it->tokens.begin();
+				tokIt != it->tokens.end(); ++tokIt) {
+	
+			if (tokIt->isParameter()) {
+				buf.push_back(TOKEN_PARAMETER);
+				writeInt(buf, tokIt->getParameterIndex());
+			}
+			else {
+				buf.push_back(tokIt->isIdentifier() ? TOKEN_IDENTIFIER : TOKEN_TEXT);
+				writeString(buf, tokIt->getText());
+			}
+		}
+	}
+	
+	writeInt(buf, chunks.size());
+	for (ChunkList::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+		writeString(buf, it->name);
+		writeInt(buf, it->line);
+		writeString(buf, it->code);
+	}
+	
+	// the name of each file is written once, the tokens have its index
+	FileList tokenFiles;
+	std::map<std::string, unsigned int> fileIndex;
+	for (unsigned int i = 0; i < tokens.size(); ++i) {
+		const std::string & file = tokens.getFileName(tokens.getToken(i));
+		if (fileIndex.insert(std::make_pair(file, (unsigned int)tokenFiles.size())).second) {
+			tokenFiles.push_back(file);
+		}
+	}
+	
+	writeInt(buf, tokenFiles.size());
+	for (FileList::const_iterator it = tokenFiles.begin(); it != tokenFiles.end(); ++it) {
+		writeString(buf, *it);
+	}
+	
+	writeInt(buf, tokens.size());
+	for (unsigned int i = 0; i < tokens.size(); ++i) {
+		const TokenStream::Token & token = tokens.getToken(i);
+		writeString(buf, tokens.getText(token));
+		writeInt(buf, fileIndex[tokens.getFileName(token)]);
+		writeInt(buf, token.line);
+		writeInt(buf, token.column);
+	}
+	
+	writeString(buf, declarations);
+	
+	std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary);
+	out.write(buf.data(), buf.size());
+	if (!out) throw ParserError(fileName + ": cannot write file.");
+}
+
+PrecompiledHeader *PrecompiledHeader::read(const std::string & fileName, const FileList & inclDirs) {
+	std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) throw ParserError(fileName + ": cannot open file.");
+	
+	// read the whole file at once, it is decoded from memory
+	in.seekg(0, std::ios::end);
+	std::string buffer(in.tellg(), '\0');
+	in.seekg(0, std::ios::beg);
+	if (!buffer.empty()) in.read(&buffer[0], buffer.size());
+	if (!in) throw ParserError(fileName + ": cannot read file.");
+	
+	PrecompiledHeader *pch = Reader(fileName, buffer).readHeader();
+	
+	// the includes could find other files
+	if (pch->includeDirs != inclDirs) {
+		delete(pch);
+		throw ParserError(fileName + ": precompiled header made with other include directories.");
+	}
+	
+	try {
+		pch->checkDependencies(fileName);
+	}
+	catch (...) {
+		delete(pch);
+		throw;
+	}
+	
+	return pch;
+}
+
+void PrecompiledHeader::checkDependencies(const std::string & fileName) const {
+	struct stat st;
+	if (stat(fileName.c_str(), &st)) throw ParserError(fileName + ": cannot read file.");
+	
+	time_t time = st.st_mtime;
+	
+	// the header is the first of them
+	for (DependencyList::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it) {
+		if (stat(it->file.c_str(), &st) || st.st_mtime > time) {
+			throw ParserError(fileName + ": precompiled header older than " + it->file + ".");
+		}
+	}
+}
+
+static void writeInt(std::string & buf, unsigned int value) {
+	for (unsigned int i = 0; i < 4; ++i) buf.push_back((value >> (i * 8)) & 0xFF);
+}
+
+static void writeString(std::string & buf, const std::string & str) {
+	writeInt(buf, str.size());
+	buf += str;
+}
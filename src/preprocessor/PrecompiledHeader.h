@@ -0,0 +1,105 @@
+#ifndef PRECOMPILED_HEADER_H
+#define PRECOMPILED_HEADER_H
+
+#include "preprocessor/DefineMap.h"
+#include "TokenStream.h"
+
+#include <string>
+#include <vector>
+
+class ListInput;
+class PreprocessorContext;
+
+/*
+ * The state of the preprocessor after a header: the code it wrote, the
+ * defines and macros, the files it included and the #pragma once. And the
+ * declarations the compiler made from that code, if it has only declarations.
+ * A translation unit whose first directive includes the header starts from
+ * it instead of reading the header again.
+ *
+ * Once made or read it is not changed, so all the preprocessor threads can
+ * use the same one.
+ */
+class PrecompiledHeader {
+	public:
+		typedef std::vector<std::string> FileList;
+		
+		PrecompiledHeader(const std::string & hdr, const FileList & inclDirs);
+		~PrecompiledHeader();
+		
+		const std::string & getHeader() const;
+		
+		// the code of the header as tokens
+		const TokenStream & getTokens() const;
+		
+		// made by Compiler::compileDeclarations, empty if there are none
+		const std::string & getDeclarations() const;
+		void setDeclarations(const std::string & decls);
+		
+		// recorded while the header is preprocessed
+		void addChunk(const std::string & name, unsigned int line, const std::string & code);
+		TokenStream *getTokenOutput();
+		void addDependency(const std::string & file, bool system);
+		void addIncludeOnce(const std::string & file);
+		void setDefinitions(const DefineMap & defineMap);
+		
+		/*
+		 * Put the state in a new translation unit. The code is added to
+		 * tokenOutput if it is not NULL, otherwise to output as text.
+		 */
+		void apply(PreprocessorContext & context, DefineMap & defineMap, ListInput *output,
+				TokenStream *tokenOutput) const;
+		
+		void write(const std::string & fileName) const;
+		
+		/*
+		 * Throw a ParserError if the file is not a precompiled header of this
+		 * version, if it was made with other include directories, or if
+		 * some file it was made from changed since.
+		 */
+		static PrecompiledHeader *read(const std::string & fileName, const FileList & inclDirs);
+		
+	private:
+		class Reader;
+		
+		// throw a ParserError if a dependency is newer than the file, or is gone
+		void checkDependencies(const std::string & fileName) const;
+		
+		struct Chunk {
+			std::string name;
+			unsigned int line;
+			std::string code;
+		};
+		typedef std::vector<Chunk> ChunkList;
+		
+		struct Dependency {
+			std::string file;
+			bool system;
+		};
+		typedef std::vector<Dependency> DependencyList;
+		
+		struct Definition {
+			std::string name;
+			bool macro;
+			unsigned int variables;
+			
+			// the ids of the identifiers are of the DefineMap they came from
+			DefineMap::MacroTokenList tokens;
+		};
+		typedef std::vector<Definition> DefinitionList;
+		
+		std::string header;
+		FileList includeDirs;
+		
+		// the code as text (for -E) and as tokens (for the compiler)
+		ChunkList chunks;
+		TokenStream tokens;
+		
+		std::string declarations;
+		
+		DependencyList dependencies;
+		FileList includeOnce;
+		DefinitionList definitions;
+};
+
+#endif
@@ -1,71 +1,85 @@
 #include "preprocessor/Preprocessor.h"
 
 #include "preprocessor/DefineMap.h"
+#include "preprocessor/PrecompiledHeader.h"
 #include "preprocessor/PreprocessorContext.h"
-#include "preprocessor/PreprocessorFileWrapper.h"
-#include "preprocessor/PreprocessorMacroParser.h"
-#include "preprocessor/PreprocessorMacroScanner.h"
 #include "preprocessor/PreprocessorParser.h"
 #include "PreprocessorParserBuffer.h"
 #include "PreprocExpParserBuffer.h"
+#include "CharClass.h"
+#include "MappedInput.h"
+#include "TimeReport.h"
+#include "TokenStream.h"
 
 #include <parser/Input.h>
 #include <parser/ListInput.h>
+#include <parser/MemoryInput.h>
 #include <parser/ParserLoader.h>
 
 #include <iostream>
 
-Preprocessor::Preprocessor(const FileList & inclDirs) : includeDirs(inclDirs) {
+Preprocessor::Preprocessor(const FileList & inclDirs) : includeDirs(inclDirs),
+		includeResolver(&ownIncludeResolver), timeReport(NULL), precompiledHeader(NULL) {
+	
 	scannerAutomata = ParserLoader::bufferToAutomata(preprocessor_parser_buffer_scanner);
 	parserTable = ParserLoader::bufferToTable(preprocessor_parser_buffer_parser);
-	
-	expScannerAutomata = ParserLoader::bufferToAutomata(preproc_exp_parser_buffer_scanner);
-	expParserTable = ParserLoader::bufferToTable(preproc_exp_parser_buffer_parser);
 }
 
 Preprocessor::~Preprocessor() {}
 
-Input *Preprocessor::preprocess(Input *input) const {
-	std::string baseName = input->getInputName();
-	
-	input = preprocessStep1(input);
-	input = preprocessStep2(input, baseName);
-	input = preprocessStep3(input, baseName);
+Input *Preprocessor::preprocess(Input *input, FileList *dependencies,
+		bool systemDependencies) const {
+		
+	ListInput *output = new ListInput();
+	preprocess(input, dependencies, systemDependencies, output, NULL, NULL);
 	
-	return input;
+	return output;
 }
 
-Input *Preprocessor::preprocessStep1(Input *input) const {
-	PreprocessorContext context(this);
-	context.setBaseFile(input->getInputName());
+TokenStream *Preprocessor::preprocessTokens(Input *input, FileList *dependencies,
+		bool systemDependencies, bool *precompiled) const {
+		
+	TokenStream *tokens = new TokenStream(input->getInputName());
 	
-	DefineMap defineMap(context);
-	PreprocessorParser parser(context, defineMap);
-	parser.parse(input);
+	try {
+		preprocess(input, dependencies, systemDependencies, NULL, tokens, precompiled);
+	}
+	catch (...) {
+		delete(tokens);
+		throw;
+	}
 	
-	return parser.getResult();
+	return tokens;
 }
 
-Input *Preprocessor::preprocessStep2(Input *input, const std::string & baseName) const {
-	PreprocessorContext context(this);
-	context.setBaseFile(baseName);
+PrecompiledHeader *Preprocessor::precompileHeader(const std::string & header) const {
+	TimeReport::Timer timer(timeReport, header, TimeReport::PREPROCESS);
 	
-	DefineMap defineMap(context);
-	PreprocessorMacroParser parser(context, defineMap);
-	parser.parse(input);
+	PrecompiledHeader *pch = new PrecompiledHeader(header, includeDirs);
 	
-	return parser.getResult();
-}
-
-Input *Preprocessor::preprocessStep3(Input *input, const std::string & baseName) const {
 	PreprocessorContext context(this);
-	context.setBaseFile(baseName);
+	context.setBaseFile(header);
+	context.setPchOutput(pch);
+	context.setTokenOutput(pch->getTokenOutput());
 	
 	DefineMap defineMap(context);
-	PreprocessorFileWrapper parser(context, defineMap);
-	parser.parse(input);
+	PreprocessorParser parser(context, defineMap);
 	
-	return parser.getResult();
+	try {
+		parser.parse(new MemoryInput(std::string("#include \"") + header + "\"\n", header));
+	}
+	catch (...) {
+		delete(parser.getResult());
+		delete(pch);
+		throw;
+	}
+	
+	// the code was added to pch too
+	delete(parser.getResult());
+	
+	pch->setDefinitions(defineMap);
+	
+	return pch;
 }
 
 const Pointer<ScannerAutomata> & Preprocessor::getScannerAutomata() const {
@@ -77,13 +91,199 @@ const Pointer<ParserTable> & Preprocessor::getParserTable() const {
 }
 
 const Pointer<ScannerAutomata> & Preprocessor::getExpScannerAutomata() const {
+	if (!expScannerAutomata) {
+		expScannerAutomata = ParserLoader::bufferToAutomata(preproc_exp_parser_buffer_scanner);
+	}
 	return expScannerAutomata;
 }
 
 const Pointer<ParserTable> & Preprocessor::getExpParserTable() const {
+	if (!expParserTable) expParserTable = ParserLoader::bufferToTable(preproc_exp_parser_buffer_parser);
 	return expParserTable;
 }
 
+void Preprocessor::loadTables() const {
+	getExpScannerAutomata();
+	getExpParserTable();
+}
+
+Input *Preprocessor::openHeader(const std::string & fileName) const {
+	const Header & header = getHeader(fileName);
+	
+	if (!header.found) return NULL;
+	return new MappedInput(header.file, fileName);
+}
+
+std::string Preprocessor::findHeader(const std::string & fileName) const {
+	return includeResolver->find(includeDirs, fileName);
+}
+
+const std::string & Preprocessor::getHeaderGuard(const std::string & fileName) const {
+	return getHeader(fileName).guard;
+}
+
+void Preprocessor::setHeaderGuard(const std::string & fileName, const std::string & guard) const {
+	HeaderMap::iterator it = headers.find(fileName);
+	if (it != headers.end()) it->second.guard = guard;
+}
+
+const PreprocessorExpProgram *Preprocessor::getExpProgram(const std::string & exp) const {
+	ExpProgramMap::const_iterator it = expPrograms.find(exp);
+	return it == expPrograms.end() ? NULL : &it->second;
+}
+
+const PreprocessorExpProgram *Preprocessor::setExpProgram(const std::string & exp,
+		const PreprocessorExpProgram & program) const {
+	
+	PreprocessorExpProgram & result = expPrograms[exp];
+	result = program;
+	return &result;
+}
+
+void Preprocessor::preprocess(Input *input, FileList *dependencies, bool systemDependencies,
+		ListInput *output, TokenStream *tokens, bool *precompiled) const {
+		
+	TimeReport::Timer timer(timeReport, input->getInputName(), TimeReport::PREPROCESS);
+	
+	PreprocessorContext context(this);
+	context.setBaseFile(input->getInputName());
+	context.setDependencies(dependencies, systemDependencies);
+	context.setTokenOutput(tokens);
+	
+	DefineMap defineMap(context);
+	
+	bool included = false;
+	if (precompiledHeader) {
+		input = skipPrecompiledInclude(input, included);
+		if (included) precompiledHeader->apply(context, defineMap, output, tokens);
+	}
+	if (precompiled) *precompiled = included;
+	
+	PreprocessorParser parser(context, defineMap, output);
+	parser.setShowWarnings(true);
+	parser.parse(input);
+}
+
+// read a char of input, keeping it in text
+static char readChar(Input *input, std::string & text) {
+	char c = input->nextChar();
+	if (c) text.push_back(c);
+	return c;
+}
+
+// read the blanks and comments from c on, return the first char after them
+static char skipBlanks(Input *input, std::string & text, char c, bool newLines) {
+	for (;;) {
+		if (CharClass::isLineSpace(c) || (newLines && c == '\n')) c = readChar(input, text);
+		else if (c == '/') {
+			c = readChar(input, text);
+			
+			if (c == '*') {
+				char last = 0;
+				c = readChar(input, text);
+				while (c && !(last == '*' && c == '/')) {
+					last = c;
+					c = readChar(input, text);
+				}
+				if (!c) return c;
+				c = readChar(input, text);
+			}
+			else if (c == '/') {
+				while (c && c != '\n') c = readChar(input, text);
+			}
+			else return '/';
+		}
+		else return c;
+	}
+}
+
+Input *Preprocessor::skipPrecompiledInclude(Input *input, bool & included) const {
+	std::string text;
+	included = false;
+	
+	char c = skipBlanks(input, text, readChar(input, text), true);
+	
+	if (c == '#') {
+		c = skipBlanks(input, text, readChar(input, text), false);
+		
+		std::string directive;
+		while (CharClass::isIdentifier(c)) {
+			directive.push_back(c);
+			c = readChar(input, text);
+		}
+		c = skipBlanks(input, text, c, false);
+		
+		char end = c == '"' ? '"' : (c == '<' ? '>' : 0);
+		if (directive == "include" && end) {
+			std::string fileName;
+			
+			c = readChar(input, text);
+			while (c && c != end && c != '\n') {
+				fileName.push_back(c);
+				c = readChar(input, text);
+			}
+			
+			if (c == end) {
+				// nothing else on the line
+				c = skipBlanks(input, text, readChar(input, text), false);
+				
+				std::string path = findHeader(fileName);
+				included = (!c || c == '\n') && !path.empty()
+						&& path == findHeader(precompiledHeader->getHeader());
+			}
+		}
+	}
+	
+	// the input goes on after the directive, its lines are still counted
+	if (included) return input;
+	
+	ListInput *result = new ListInput();
+	result->addInput(new MemoryInput(text, input->getInputName()));
+	result->addInput(input);
+	
+	return result;
+}
+
+const Preprocessor::Header & Preprocessor::getHeader(const std::string & fileName) const {
+	HeaderMap::iterator it = headers.find(fileName);
+	if (it != headers.end()) return it->second;
+	
+	Header & header = headers[fileName];
+	
+	header.file = new MappedFile(fileName);
+	header.found = header.file->isOpen();
+	
+	return header;
+}
+
 const Preprocessor::FileList & Preprocessor::getIncludeDirs() const {
 	return includeDirs;
 }
+
+void Preprocessor::setIncludeDirs(const FileList & inclDirs) {
+	includeDirs = inclDirs;
+	
+	// the headers may have changed since they were read
+	headers.clear();
+	ownIncludeResolver.clear();
+}
+
+TimeReport *Preprocessor::getTimeReport() const {
+	return timeReport;
+}
+
+void Preprocessor::setTimeReport(TimeReport *report) {
+	timeReport = report;
+}
+
+const PrecompiledHeader *Preprocessor::getPrecompiledHeader() const {
+	return precompiledHeader;
+}
+
+void Preprocessor::setPrecompiledHeader(const PrecompiledHeader *pch) {
+	precompiledHeader = pch;
+}
+
+void Preprocessor::setIncludeResolver(IncludeResolver *resolver) {
+	includeResolver = resolver ? resolver : &ownIncludeResolver;
+}
@@ -1,6 +1,10 @@
 #ifndef PREPROCESSOR_H
 #define PREPROCESSOR_H
 
+#include "preprocessor/IncludeResolver.h"
+#include "preprocessor/PreprocessorExpProgram.h"
+#include "MappedFile.h"
+
 #include <parser/ParserTable.h>
 #include <parser/Pointer.h>
 #include <parser/ScannerAutomata.h>
@@ -11,6 +15,10 @@
 
 class DefineMap;
 class Input;
+class ListInput;
+class PrecompiledHeader;
+class TimeReport;
+class TokenStream;
 
 class Preprocessor {
 	public:
@@ -19,7 +27,24 @@ class Preprocessor {
 		Preprocessor(const FileList & inclDirs);
 		~Preprocessor();
 		
-		Input *preprocess(Input *input) const;
+		/*
+		 * If dependencies is not NULL, the files included by the input are
+		 * added to it. The system headers (included with <>) are added only
+		 * if systemDependencies is true.
+		 */
+		Input *preprocess(Input *input, FileList *dependencies = NULL,
+				bool systemDependencies = true) const;
+		
+		/*
+		 * The same, but the code is returned as tokens for the compiler
+		 * instead of text. If precompiled is not NULL it is set to whether
+		 * the tokens start with the code of the precompiled header.
+		 */
+		TokenStream *preprocessTokens(Input *input, FileList *dependencies = NULL,
+				bool systemDependencies = true, bool *precompiled = NULL) const;
+		
+		// preprocess the header as the first include of a translation unit
+		PrecompiledHeader *precompileHeader(const std::string & header) const;
 		
 		const Pointer<ScannerAutomata> & getScannerAutomata() const;
 		const Pointer<ParserTable> & getParserTable() const;
@@ -27,20 +52,102 @@ class Preprocessor {
 		const Pointer<ScannerAutomata> & getExpScannerAutomata() const;
 		const Pointer<ParserTable> & getExpParserTable() const;
 		
+		// the expression tables are loaded the first time they are used,
+		// this loads them now
+		void loadTables() const;
+		
+		/*
+		 * Open a header, reading it only the first time it is included by
+		 * any of the inputs of this preprocessor.
+		 * Return NULL if the file cannot be read.
+		 */
+		Input *openHeader(const std::string & fileName) const;
+		
+		/*
+		 * The path of the header in the first include directory that has
+		 * it, an empty string if none has it.
+		 */
+		std::string findHeader(const std::string & fileName) const;
+		
+		/*
+		 * The macro of the #ifndef that wraps the whole header, an include
+		 * can be skipped while it is defined. Empty if the header has none.
+		 */
+		const std::string & getHeaderGuard(const std::string & fileName) const;
+		void setHeaderGuard(const std::string & fileName, const std::string & guard) const;
+		
+		/*
+		 * The #if expressions already compiled, by the text of their tokens
+		 * after the macros are expanded. NULL if exp was not compiled yet.
+		 */
+		const PreprocessorExpProgram *getExpProgram(const std::string & exp) const;
+		const PreprocessorExpProgram *setExpProgram(const std::string & exp,
+				const PreprocessorExpProgram & program) const;
+		
 		const FileList & getIncludeDirs() const;
+		void setIncludeDirs(const FileList & inclDirs);
+		
+		// NULL if the preprocessor is not timed
+		TimeReport *getTimeReport() const;
+		void setTimeReport(TimeReport *report);
+		
+		/*
+		 * An input whose first directive includes the header of pch starts
+		 * from pch instead, NULL to always read the header.
+		 */
+		const PrecompiledHeader *getPrecompiledHeader() const;
+		void setPrecompiledHeader(const PrecompiledHeader *pch);
+		
+		// one shared with other preprocessors, NULL to use its own
+		void setIncludeResolver(IncludeResolver *resolver);
 		
 	private:
-		Input *preprocessStep1(Input *input) const;
-		Input *preprocessStep2(Input *input, const std::string & baseName) const;
-		Input *preprocessStep3(Input *input, const std::string & baseName) const;
+		struct Header {
+			bool found;
+			
+			// mapped while the header is cached, each include reads it in place
+			Pointer<MappedFile> file;
+			std::string guard;
+		};
+		typedef std::map<std::string, Header> HeaderMap;
+		typedef std::map<std::string, PreprocessorExpProgram> ExpProgramMap;
+		
+		// the code is added to output, or to tokens if it is not NULL
+		void preprocess(Input *input, FileList *dependencies, bool systemDependencies,
+				ListInput *output, TokenStream *tokens, bool *precompiled) const;
+		
+		/*
+		 * Read the blanks and comments before the first directive of input,
+		 * and the directive if it includes the precompiled header. Return
+		 * input from where the preprocessor goes on: after the directive if
+		 * included is set, otherwise from the start again.
+		 */
+		Input *skipPrecompiledInclude(Input *input, bool & included) const;
+		
+		// read the header if it was not read yet
+		const Header & getHeader(const std::string & fileName) const;
 		
 		Pointer<ScannerAutomata> scannerAutomata;
 		Pointer<ParserTable> parserTable;
 		
-		Pointer<ScannerAutomata> expScannerAutomata;
-		Pointer<ParserTable> expParserTable;
+		// loaded on first use, a file without #if never needs them
+		mutable Pointer<ScannerAutomata> expScannerAutomata;
+		mutable Pointer<ParserTable> expParserTable;
+		
+		FileList includeDirs;
+		
+		// the headers already read (or not found), by path
+		mutable HeaderMap headers;
+		
+		IncludeResolver ownIncludeResolver;
+		IncludeResolver *includeResolver;
+		
+		// shared by all the inputs, the headers repeat the same conditions
+		mutable ExpProgramMap expPrograms;
+		
+		TimeReport *timeReport;
 		
-		const FileList & includeDirs;
+		const PrecompiledHeader *precompiledHeader;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "preprocessor/PreprocessorContext.h"
 
+#include "preprocessor/PrecompiledHeader.h"
 #include "UccDefs.h"
 
 #include <parser/Input.h>
@@ -12,7 +13,8 @@
 #include <sys/time.h>
 
 PreprocessorContext::PreprocessorContext(const Preprocessor *preproc) :
-		preprocessor(preproc), input(NULL), includeLevel(0) {}
+		preprocessor(preproc), input(NULL), includeLevel(0), dependencies(NULL),
+		systemDependencies(true), pchOutput(NULL), tokenOutput(NULL), outputBuffer(new OutputBuffer()) {}
 
 PreprocessorContext::~PreprocessorContext() {}
 
@@ -37,6 +39,45 @@ void PreprocessorContext::decIncludeLevel() {
 	--includeLevel;
 }
 
+void PreprocessorContext::setDependencies(FileList *deps, bool system) {
+	dependencies = deps;
+	systemDependencies = system;
+}
+
+void PreprocessorContext::addDependency(const std::string & file, bool system) {
+	if (dependencies && (systemDependencies || !system)) dependencies->push_back(file);
+	if (pchOutput) pchOutput->addDependency(file, system);
+}
+
+void PreprocessorContext::setIncludeOnce(const std::string & file) {
+	includeOnce.insert(file);
+	if (pchOutput) pchOutput->addIncludeOnce(file);
+}
+
+bool PreprocessorContext::isIncludeOnce(const std::string & file) const {
+	return includeOnce.find(file) != includeOnce.end();
+}
+
+void PreprocessorContext::setPchOutput(PrecompiledHeader *pch) {
+	pchOutput = pch;
+}
+
+PrecompiledHeader *PreprocessorContext::getPchOutput() const {
+	return pchOutput;
+}
+
+void PreprocessorContext::setTokenOutput(TokenStream *tokens) {
+	tokenOutput = tokens;
+}
+
+TokenStream *PreprocessorContext::getTokenOutput() const {
+	return tokenOutput;
+}
+
+const Pointer<OutputBuffer> & PreprocessorContext::getOutputBuffer() const {
+	return outputBuffer;
+}
+
 std::string PreprocessorContext::define__FILE__() const {
 	assert(input);
 	return std::string("\"") + input->getInputName() + "\"";
@@ -63,12 +104,13 @@ std::string PreprocessorContext::define__DATE__() const {
 	};
 	
 	time_t t = time(NULL);
-	tm *dateTm = localtime(&t);
+	tm dateTm;
+	localtime_r(&t, &dateTm); // preprocessors may run in several threads
 	
-	assert(dateTm->tm_mon >= 0 && dateTm->tm_mon < 12);
+	assert(dateTm.tm_mon >= 0 && dateTm.tm_mon < 12);
 	
 	char buf[32];
-	sprintf(buf, "\"%s %2d %4d\"", MONTHS[dateTm->tm_mon],dateTm->tm_mday, 1900 + dateTm->tm_year);
+	sprintf(buf, "\"%s %2d %4d\"", MONTHS[dateTm.tm_mon],dateTm.tm_mday, 1900 + dateTm.tm_year);
 	assert(strlen(buf) == 13);
 	
 	return std::string(buf);
@@ -76,10 +118,11 @@ std::string PreprocessorContext::define__DATE__() const {
 
 std::string PreprocessorContext::define__TIME__() const {
 	time_t t = time(NULL);
-	tm *timeTm = localtime(&t);
+	tm timeTm;
+	localtime_r(&t, &timeTm);
 	
 	char buf[32];
-	sprintf(buf, "\"%02d:%02d:%02d\"", timeTm->tm_hour, timeTm->tm_min, timeTm->tm_sec);
+	sprintf(buf, "\"%02d:%02d:%02d\"", timeTm.tm_hour, timeTm.tm_min, timeTm.tm_sec);
 	assert(strlen(buf) == 10);
 	
 	return std::string(buf);
@@ -1,13 +1,23 @@
 #ifndef PREPROCESSOR_CONTEXT_H
 #define PREPROCESSOR_CONTEXT_H
 
+#include "preprocessor/OutputBuffer.h"
+
+#include <parser/Pointer.h>
+
+#include <set>
 #include <string>
+#include <vector>
 
 class Input;
+class PrecompiledHeader;
 class Preprocessor;
+class TokenStream;
 
 class PreprocessorContext {
 	public:
+		typedef std::vector<std::string> FileList;
+		
 		PreprocessorContext(const Preprocessor *preproc);
 		~PreprocessorContext();
 		
@@ -20,6 +30,29 @@ class PreprocessorContext {
 		void incIncludeLevel();
 		void decIncludeLevel();
 		
+		/*
+		 * The included files are added to deps (NULL to not collect them).
+		 * The system headers are added only if system is true.
+		 */
+		void setDependencies(FileList *deps, bool system);
+		void addDependency(const std::string & file, bool system);
+		
+		// a header with #pragma once is included only once by each input
+		void setIncludeOnce(const std::string & file);
+		bool isIncludeOnce(const std::string & file) const;
+		
+		// the code, the dependencies and the #pragma once are also added to pch
+		void setPchOutput(PrecompiledHeader *pch);
+		PrecompiledHeader *getPchOutput() const;
+		
+		// the code is added to tokens instead of being written as text
+		// (a precompiled header keeps both)
+		void setTokenOutput(TokenStream *tokens);
+		TokenStream *getTokenOutput() const;
+		
+		// the text output of all the files, the chunks of the output read it
+		const Pointer<OutputBuffer> & getOutputBuffer() const;
+		
 		// standard defines
 		std::string define__FILE__() const;
 		std::string define__LINE__() const;
@@ -46,6 +79,17 @@ class PreprocessorContext {
 		std::string baseFile;
 		
 		unsigned int includeLevel;
+		
+		FileList *dependencies;
+		bool systemDependencies;
+		
+		std::set<std::string> includeOnce;
+		
+		PrecompiledHeader *pchOutput;
+		
+		TokenStream *tokenOutput;
+		
+		Pointer<OutputBuffer> outputBuffer;
 };
 
 #endif
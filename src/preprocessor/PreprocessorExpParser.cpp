@@ -2,6 +2,7 @@
 
 #include "preprocessor/DefineMap.h"
 #include "preprocessor/Preprocessor.h"
+#include "preprocessor/PreprocessorExpProgram.h"
 #include "preprocessor/PreprocessorExpScanner.h"
 #include "Number.h"
 #include "PreprocExpParserBuffer.h"
@@ -17,25 +18,35 @@
  * PreprocessorExpParser
  *****************************************************************************/
 PreprocessorExpParser::PreprocessorExpParser(const Preprocessor *preproc,
-		const DefineMap & defMap) : defineMap(defMap) {
-	
-	scannerAutomata = preproc->getExpScannerAutomata();
-	parserTable = preproc->getExpParserTable();
-}
+		const DefineMap & defMap) : preprocessor(preproc), defineMap(defMap) {}
 
 bool PreprocessorExpParser::parseExp(Input *exp) const {
-	Scanner *scanner = new PreprocessorExpScanner(scannerAutomata, exp, defineMap);
-	Parser *parser = new Parser(parserTable, scanner);
+	PreprocessorExpScanner *scanner = new PreprocessorExpScanner(preprocessor->getExpScannerAutomata(),
+			exp, defineMap);
 	
-	Node *root = parser->parse();
+	// the same tokens are the same program, whatever macros they came from
+	std::string text = scanner->readExpression();
+	InputLocation loc = exp->getCurrentLocation();
 	
-	assert(root->getNodeType() == ParsingTree::NODE_NON_TERMINAL);
-	bool result = evaluateExpression((NonTerminal *)root).boolValue();
+	const PreprocessorExpProgram *program = preprocessor->getExpProgram(text);
 	
-	delete(root);
-	delete(parser);
+	if (program) delete(scanner);
+	else {
+		Parser *parser = new Parser(preprocessor->getExpParserTable(), scanner);
+		
+		Node *root = parser->parse();
+		
+		assert(root->getNodeType() == ParsingTree::NODE_NON_TERMINAL);
+		PreprocessorExpProgram compiled;
+		compileExpression((NonTerminal *)root, compiled);
+		
+		delete(root);
+		delete(parser);
+		
+		program = preprocessor->setExpProgram(text, compiled);
+	}
 	
-	return result;
+	return program->run(defineMap, loc).boolValue();
 }
 
 /*****************************************************************************
@@ -43,13 +54,13 @@ bool PreprocessorExpParser::parseExp(Input *exp) const {
  *****************************************************************************/
 
 /*
- * <EXPRESSION> ::= <LOGICAL_OR_EXPRESSION>;
+ * <EXPRESSION> ::= <CONDITIONAL_EXPRESSION>;
  */
-Number PreprocessorExpParser::evaluateExpression(NonTerminal *nt) const {
+void PreprocessorExpParser::compileExpression(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_EXPRESSION);
 	assert(nt->getNonTerminalRule() == 0);
 	
-	return evaluateConditionalExp(nt->getNonTerminalAt(0));
+	compileConditionalExp(nt->getNonTerminalAt(0), program);
 }
 
 /*
@@ -61,36 +72,32 @@ Number PreprocessorExpParser::evaluateExpression(NonTerminal *nt) const {
  *		| IDENTIFIER
  *		;
  */
-Number PreprocessorExpParser::evaluatePrimaryExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compilePrimaryExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_PRIMARY_EXPRESSION);
 	
-	Number result;
-	
 	switch (nt->getNonTerminalRule()) {
 		case 0: // <PRIMARY_EXPRESSION> ::= CONSTANT
-			result = evaluateConstant(nt->getTokenAt(0));
+			program.addPush(evaluateConstant(nt->getTokenAt(0)));
 			break;
 		case 1: // <PRIMARY_EXPRESSION> ::= P_OPEN <EXPRESSION> P_CLOSE
-			result = evaluateExpression(nt->getNonTerminalAt(1));
+			compileExpression(nt->getNonTerminalAt(1), program);
 			break;
 		case 2: // <PRIMARY_EXPRESSION> ::= DEFINED P_OPEN IDENTIFIER P_CLOSE
-			result = Number(defineMap.isDefined(nt->getTokenAt(2)->getToken()));
+			program.addName(PreprocessorExpProgram::OP_DEFINED, nt->getTokenAt(2)->getToken());
 			break;
 		case 3:// <PRIMARY_EXPRESSION> ::= DEFINED_M IDENTIFIER P_CLOSE
-			result = Number(defineMap.isDefined(nt->getTokenAt(1)->getToken()));
+			program.addName(PreprocessorExpProgram::OP_DEFINED, nt->getTokenAt(1)->getToken());
 			break;
 		case 4: // <PRIMARY_EXPRESSION> ::= DEFINED IDENTIFIER
-			result = Number(defineMap.isDefined(nt->getTokenAt(1)->getToken()));
+			program.addName(PreprocessorExpProgram::OP_DEFINED, nt->getTokenAt(1)->getToken());
 			break;
-		case 5:
-			throw ParserError(nt->getInputLocation(), std::string("\"") + nt->getTokenAt(0)->getToken()
-					+ "\" undefined."); 
+		case 5: // <PRIMARY_EXPRESSION> ::= IDENTIFIER
+			// only an error if it is evaluated, it may be after a false &&
+			program.addName(PreprocessorExpProgram::OP_UNDEFINED, nt->getTokenAt(0)->getToken());
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -98,22 +105,18 @@ Number PreprocessorExpParser::evaluatePrimaryExp(NonTerminal *nt) const {
  *		| <UNARY_OPERATOR> <PRIMARY_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateUnaryExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileUnaryExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_UNARY_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluatePrimaryExp(nt->getNonTerminalAt(0));
+		compilePrimaryExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		result = evaluatePrimaryExp(nt->getNonTerminalAt(1));
-		result = evaluateUnaryOperator(nt->getNonTerminalAt(0), result);
+		compilePrimaryExp(nt->getNonTerminalAt(1), program);
+		compileUnaryOperator(nt->getNonTerminalAt(0), program);
 	}
-	
-	return result;
 }
 
 /*
@@ -123,30 +126,25 @@ Number PreprocessorExpParser::evaluateUnaryExp(NonTerminal *nt) const {
  *		| NOT
  *		;
  */
-Number PreprocessorExpParser::evaluateUnaryOperator(NonTerminal *nt, Number num) const {
+void PreprocessorExpParser::compileUnaryOperator(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_UNARY_OPERATOR);
 	
-	Number result;
-	
 	switch (nt->getNonTerminalRule()) {
 		case 0: // <UNARY_OPERATOR> ::= PLUS_SIG
-			result = num;
+			program.addOperation(PreprocessorExpProgram::OP_PLUS);
 			break;
 		case 1: // <UNARY_OPERATOR> ::= LESS_SIG
-			result = -num;
+			program.addOperation(PreprocessorExpProgram::OP_MINUS);
 			break;
 		case 2: // <UNARY_OPERATOR> ::= NEG
-			if (num.isFloat()) throw ParserError(nt->getInputLocation(), "Invalid unary operand.");
-			result = ~num;;
+			program.addOperation(PreprocessorExpProgram::OP_BIT_NOT);
 			break;
 		case 3: // <UNARY_OPERATOR> ::= NOT
-			result = !num;
+			program.addOperation(PreprocessorExpProgram::OP_NOT);
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -156,37 +154,30 @@ Number PreprocessorExpParser::evaluateUnaryOperator(NonTerminal *nt, Number num)
  *		| <MULTIPLICATIVE_EXPRESSION> MOD <UNARY_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateMultiplicativeExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileMultiplicativeExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_MULTIPLICATIVE_EXPRESSION);
 	
-	Number result;
-	Number a, b;
+	if (nt->getNonTerminalRule() == 0) {
+		compileUnaryExp(nt->getNonTerminalAt(0), program);
+		return;
+	}
+	
+	compileMultiplicativeExp(nt->getNonTerminalAt(0), program);
+	compileUnaryExp(nt->getNonTerminalAt(2), program);
 	
 	switch (nt->getNonTerminalRule()) {
-		case 0: // <MULTIPLICATIVE_EXPRESSION> ::= <UNARY_EXPRESSION>
-			result = evaluateUnaryExp(nt->getNonTerminalAt(0));
-			break;
 		case 1: // <MULTIPLICATIVE_EXPRESSION> ::=  <MULTIPLICATIVE_EXPRESSION> MUL <UNARY_EXPRESSION>
-			a = evaluateMultiplicativeExp(nt->getNonTerminalAt(2));
-			b = evaluateUnaryExp(nt->getNonTerminalAt(0));
-			result = a * b;
+			program.addOperation(PreprocessorExpProgram::OP_MUL);
 			break;
 		case 2: // <MULTIPLICATIVE_EXPRESSION> ::= <MULTIPLICATIVE_EXPRESSION> DIV <UNARY_EXPRESSION>
-			a = evaluateMultiplicativeExp(nt->getNonTerminalAt(2));
-			b = evaluateUnaryExp(nt->getNonTerminalAt(0));
-			result = a / b;
+			program.addOperation(PreprocessorExpProgram::OP_DIV);
 			break;
 		case 3: // <MULTIPLICATIVE_EXPRESSION> ::= <MULTIPLICATIVE_EXPRESSION> MOD <UNARY_EXPRESSION>
-			a = evaluateMultiplicativeExp(nt->getNonTerminalAt(2));
-			b = evaluateUnaryExp(nt->getNonTerminalAt(0));
-			if (b.isFloat()) throw ParserError(nt->getInputLocation(), "Invalid operand.");
-			result = a % b;
+			program.addOperation(PreprocessorExpProgram::OP_MOD);
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -195,31 +186,27 @@ Number PreprocessorExpParser::evaluateMultiplicativeExp(NonTerminal *nt) const {
  *		| <ADDITIVE_EXPRESSION> LESS_SIG <MULTIPLICATIVE_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateAdditiveExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileAdditiveExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_ADDITIVE_EXPRESSION);
 	
-	Number result;
-	Number a, b;
+	if (nt->getNonTerminalRule() == 0) {
+		compileMultiplicativeExp(nt->getNonTerminalAt(0), program);
+		return;
+	}
+	
+	compileAdditiveExp(nt->getNonTerminalAt(0), program);
+	compileMultiplicativeExp(nt->getNonTerminalAt(2), program);
 	
 	switch (nt->getNonTerminalRule()) {
-		case 0: // <ADDITIVE_EXPRESSION> ::= <MULTIPLICATIVE_EXPRESSION>
-			result = evaluateMultiplicativeExp(nt->getNonTerminalAt(0));
-			break;
 		case 1: // <ADDITIVE_EXPRESSION> ::= <ADDITIVE_EXPRESSION> PLUS_SIG <MULTIPLICATIVE_EXPRESSION>
-			a = evaluateAdditiveExp(nt->getNonTerminalAt(0));
-			b = evaluateMultiplicativeExp(nt->getNonTerminalAt(2));
-			result = a + b;
+			program.addOperation(PreprocessorExpProgram::OP_ADD);
 			break;
 		case 2: // <ADDITIVE_EXPRESSION> ::= <ADDITIVE_EXPRESSION> LESS_SIG <MULTIPLICATIVE_EXPRESSION>
-			a = evaluateAdditiveExp(nt->getNonTerminalAt(0));
-			b = evaluateMultiplicativeExp(nt->getNonTerminalAt(2));
-			result = a - b;
+			program.addOperation(PreprocessorExpProgram::OP_SUB);
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -228,33 +215,27 @@ Number PreprocessorExpParser::evaluateAdditiveExp(NonTerminal *nt) const {
  *		| <SHIFT_EXPRESSION> RIGHT_OP <ADDITIVE_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateShiftExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileShiftExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_SHIFT_EXPRESSION);
 	
-	Number result;
-	Number a, b;
+	if (nt->getNonTerminalRule() == 0) {
+		compileAdditiveExp(nt->getNonTerminalAt(0), program);
+		return;
+	}
+	
+	compileShiftExp(nt->getNonTerminalAt(0), program);
+	compileAdditiveExp(nt->getNonTerminalAt(2), program);
 	
 	switch (nt->getNonTerminalRule()) {
-		case 0: // <SHIFT_EXPRESSION> ::= <ADDITIVE_EXPRESSION>
-			result = evaluateAdditiveExp(nt->getNonTerminalAt(0));
-			break;
 		case 1: // <SHIFT_EXPRESSION> ::= <SHIFT_EXPRESSION> LEFT_OP <ADDITIVE_EXPRESSION>
-			a = evaluateShiftExp(nt->getNonTerminalAt(0));
-			b = evaluateAdditiveExp(nt->getNonTerminalAt(2));
-			if (b.isFloat()) throw ParserError(nt->getInputLocation(), "Invalid operand.");
-			result = a << b.intValue();
+			program.addOperation(PreprocessorExpProgram::OP_SHIFT_LEFT);
 			break;
 		case 2: // <SHIFT_EXPRESSION> ::= <SHIFT_EXPRESSION> RIGHT_OP <ADDITIVE_EXPRESSION>
-			a = evaluateShiftExp(nt->getNonTerminalAt(0));
-			b = evaluateAdditiveExp(nt->getNonTerminalAt(2));
-			if (b.isFloat()) throw ParserError(nt->getInputLocation(), "Invalid operand.");
-			result = a >> b.intValue();
+			program.addOperation(PreprocessorExpProgram::OP_SHIFT_RIGHT);
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -265,41 +246,33 @@ Number PreprocessorExpParser::evaluateShiftExp(NonTerminal *nt) const {
  *		| <RELATIONAL_EXPRESSION> GE_OP <SHIFT_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateRelationExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileRelationExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_RELATIONAL_EXPRESSION);
 	
-	Number result;
-	Number a, b;
+	if (nt->getNonTerminalRule() == 0) {
+		compileShiftExp(nt->getNonTerminalAt(0), program);
+		return;
+	}
+	
+	compileRelationExp(nt->getNonTerminalAt(0), program);
+	compileShiftExp(nt->getNonTerminalAt(2), program);
 	
 	switch (nt->getNonTerminalRule()) {
-		case 0: // <RELATIONAL_EXPRESSION> ::= <SHIFT_EXPRESSION>
-			result = evaluateShiftExp(nt->getNonTerminalAt(0));
-			break;
 		case 1: // <RELATIONAL_EXPRESSION> ::= <RELATIONAL_EXPRESSION> LESS <SHIFT_EXPRESSION>
-			a = evaluateRelationExp(nt->getNonTerminalAt(0));
-			b = evaluateShiftExp(nt->getNonTerminalAt(2));
-			result = Number(a < b);
+			program.addOperation(PreprocessorExpProgram::OP_LESS);
 			break;
 		case 2: // <RELATIONAL_EXPRESSION> ::= <RELATIONAL_EXPRESSION> GREATER <SHIFT_EXPRESSION>
-			a = evaluateRelationExp(nt->getNonTerminalAt(0));
-			b = evaluateShiftExp(nt->getNonTerminalAt(2));
-			result = Number(a > b);
+			program.addOperation(PreprocessorExpProgram::OP_GREATER);
 			break;
 		case 3: // <RELATIONAL_EXPRESSION> ::= <RELATIONAL_EXPRESSION> LE_OP <SHIFT_EXPRESSION>
-			a = evaluateRelationExp(nt->getNonTerminalAt(0));
-			b = evaluateShiftExp(nt->getNonTerminalAt(2));
-			result = Number(a <= b);
+			program.addOperation(PreprocessorExpProgram::OP_LESS_EQUAL);
 			break;
-		case 4: // <RELATIONAL_EXPRESSION> ::= <RELATIONAL_EXPRESSION> LE_OP <SHIFT_EXPRESSION>
-			a = evaluateRelationExp(nt->getNonTerminalAt(0));
-			b = evaluateShiftExp(nt->getNonTerminalAt(2));
-			result = Number(a >= b);
+		case 4: // <RELATIONAL_EXPRESSION> ::= <RELATIONAL_EXPRESSION> GE_OP <SHIFT_EXPRESSION>
+			program.addOperation(PreprocessorExpProgram::OP_GREATER_EQUAL);
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -308,31 +281,27 @@ Number PreprocessorExpParser::evaluateRelationExp(NonTerminal *nt) const {
  *		| <EQUALITY_EXPRESSION> NE_OP <RELATIONAL_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateEqualityExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileEqualityExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_EQUALITY_EXPRESSION);
 	
-	Number result;
-	Number a, b;
+	if (nt->getNonTerminalRule() == 0) {
+		compileRelationExp(nt->getNonTerminalAt(0), program);
+		return;
+	}
+	
+	compileEqualityExp(nt->getNonTerminalAt(0), program);
+	compileRelationExp(nt->getNonTerminalAt(2), program);
 	
 	switch (nt->getNonTerminalRule()) {
-		case 0: // <EQUALITY_EXPRESSION> ::= <RELATIONAL_EXPRESSION>
-			result = evaluateRelationExp(nt->getNonTerminalAt(0));
-			break;
 		case 1: // <EQUALITY_EXPRESSION> ::= <EQUALITY_EXPRESSION> EQ_OP <RELATIONAL_EXPRESSION>
-			a = evaluateEqualityExp(nt->getNonTerminalAt(0));
-			b = evaluateRelationExp(nt->getNonTerminalAt(2));
-			result = Number(a == b);
+			program.addOperation(PreprocessorExpProgram::OP_EQUAL);
 			break;
 		case 2: // <EQUALITY_EXPRESSION> ::= <EQUALITY_EXPRESSION> NE_OP <RELATIONAL_EXPRESSION>
-			a = evaluateEqualityExp(nt->getNonTerminalAt(0));
-			b = evaluateRelationExp(nt->getNonTerminalAt(2));
-			result = Number(a != b);
+			program.addOperation(PreprocessorExpProgram::OP_NOT_EQUAL);
 			break;
 		default:
 			abort();
 	}
-	
-	return result;
 }
 
 /*
@@ -340,26 +309,19 @@ Number PreprocessorExpParser::evaluateEqualityExp(NonTerminal *nt) const {
  *		| <AND_EXPRESSION> AND <EQUALITY_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateAndExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileAndExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_AND_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluateEqualityExp(nt->getNonTerminalAt(0));
+		compileEqualityExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		Number a = evaluateAndExp(nt->getNonTerminalAt(0));
-		Number b = evaluateEqualityExp(nt->getNonTerminalAt(2));
-		if (a.isFloat() || b.isFloat()) { 
-			throw ParserError(nt->getInputLocation(), "use of invalid operand.");
-		}
-		result = a & b;
+		compileAndExp(nt->getNonTerminalAt(0), program);
+		compileEqualityExp(nt->getNonTerminalAt(2), program);
+		program.addOperation(PreprocessorExpProgram::OP_AND);
 	}
-	
-	return result;
 }
 
 /*
@@ -367,26 +329,19 @@ Number PreprocessorExpParser::evaluateAndExp(NonTerminal *nt) const {
  *		| <EXCLUSIVE_OR_EXPRESSION> XOR <AND_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateExclusiveOrExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileExclusiveOrExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_EXCLUSIVE_OR_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluateAndExp(nt->getNonTerminalAt(0));
+		compileAndExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		Number a = evaluateExclusiveOrExp(nt->getNonTerminalAt(0));
-		Number b = evaluateAndExp(nt->getNonTerminalAt(2));
-		if (a.isFloat() || b.isFloat()) { 
-			throw ParserError(nt->getInputLocation(), "use of invalid operand.");
-		}
-		result = a ^ b;
+		compileExclusiveOrExp(nt->getNonTerminalAt(0), program);
+		compileAndExp(nt->getNonTerminalAt(2), program);
+		program.addOperation(PreprocessorExpProgram::OP_XOR);
 	}
-	
-	return result;
 }
 
 /*
@@ -394,26 +349,19 @@ Number PreprocessorExpParser::evaluateExclusiveOrExp(NonTerminal *nt) const {
  *		| <INCLUSIVE_OR_EXPRESSION> OR <EXCLUSIVE_OR_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateInclusiveOrExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileInclusiveOrExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_INCLUSIVE_OR_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluateExclusiveOrExp(nt->getNonTerminalAt(0));
+		compileExclusiveOrExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		Number a = evaluateInclusiveOrExp(nt->getNonTerminalAt(0));
-		Number b = evaluateExclusiveOrExp(nt->getNonTerminalAt(2));
-		if (a.isFloat() || b.isFloat()) { 
-			throw ParserError(nt->getInputLocation(), "use of invalid operand.");
-		}
-		result = a | b;
+		compileInclusiveOrExp(nt->getNonTerminalAt(0), program);
+		compileExclusiveOrExp(nt->getNonTerminalAt(2), program);
+		program.addOperation(PreprocessorExpProgram::OP_OR);
 	}
-	
-	return result;
 }
 
 /*
@@ -421,26 +369,22 @@ Number PreprocessorExpParser::evaluateInclusiveOrExp(NonTerminal *nt) const {
  *		| <LOGICAL_AND_EXPRESSION> AND_OP <INCLUSIVE_OR_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateLogicalAndExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileLogicalAndExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_LOGICAL_AND_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluateInclusiveOrExp(nt->getNonTerminalAt(0));
+		compileInclusiveOrExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		Number a = evaluateLogicalAndExp(nt->getNonTerminalAt(0));
-		if (!a.boolValue()) result = Number(false);
-		else {
-			Number b = evaluateInclusiveOrExp(nt->getNonTerminalAt(2));
-			result = Number(b.boolValue());
-		}
+		// the right side is not evaluated if the left one is false
+		compileLogicalAndExp(nt->getNonTerminalAt(0), program);
+		unsigned int jump = program.addJump(PreprocessorExpProgram::OP_AND_JUMP);
+		compileInclusiveOrExp(nt->getNonTerminalAt(2), program);
+		program.addOperation(PreprocessorExpProgram::OP_BOOL);
+		program.setJumpTarget(jump);
 	}
-	
-	return result;
 }
 
 /*
@@ -448,26 +392,22 @@ Number PreprocessorExpParser::evaluateLogicalAndExp(NonTerminal *nt) const {
  *		| <LOGICAL_OR_EXPRESSION> OR_OP <LOGICAL_AND_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateLogicalOrExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileLogicalOrExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_LOGICAL_OR_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluateLogicalAndExp(nt->getNonTerminalAt(0));
+		compileLogicalAndExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		Number a = evaluateLogicalOrExp(nt->getNonTerminalAt(0));
-		if (a.boolValue()) result = Number(true);
-		else {
-			Number b = evaluateLogicalAndExp(nt->getNonTerminalAt(2));
-			result = Number(b.boolValue());
-		}
+		// the right side is not evaluated if the left one is true
+		compileLogicalOrExp(nt->getNonTerminalAt(0), program);
+		unsigned int jump = program.addJump(PreprocessorExpProgram::OP_OR_JUMP);
+		compileLogicalAndExp(nt->getNonTerminalAt(2), program);
+		program.addOperation(PreprocessorExpProgram::OP_BOOL);
+		program.setJumpTarget(jump);
 	}
-	
-	return result;
 }
 
 /*
@@ -475,22 +415,23 @@ Number PreprocessorExpParser::evaluateLogicalOrExp(NonTerminal *nt) const {
  *		| <LOGICAL_OR_EXPRESSION> QUESTION <EXPRESSION> COLUMN <CONDITIONAL_EXPRESSION>
  *		;
  */
-Number PreprocessorExpParser::evaluateConditionalExp(NonTerminal *nt) const {
+void PreprocessorExpParser::compileConditionalExp(NonTerminal *nt, PreprocessorExpProgram & program) const {
 	assert(nt->getNonTerminalId() == PREPROCEXPPARSERBUFFER_NONTERMINAL_CONDITIONAL_EXPRESSION);
 	
-	Number result;
-	
 	if (nt->getNonTerminalRule() == 0) {
-		result = evaluateLogicalOrExp(nt->getNonTerminalAt(0));
+		compileLogicalOrExp(nt->getNonTerminalAt(0), program);
 	}
 	else {
 		assert(nt->getNonTerminalRule() == 1);
 		
-		Number condition = evaluateLogicalOrExp(nt->getNonTerminalAt(0));
+		compileLogicalOrExp(nt->getNonTerminalAt(0), program);
+		unsigned int elseJump = program.addJump(PreprocessorExpProgram::OP_JUMP_FALSE);
+		
+		compileExpression(nt->getNonTerminalAt(2), program);
+		unsigned int endJump = program.addJump(PreprocessorExpProgram::OP_JUMP);
 		
-		if (condition.boolValue()) result = evaluateExpression(nt->getNonTerminalAt(2));
-		else result = evaluateConditionalExp(nt->getNonTerminalAt(4));
+		program.setJumpTarget(elseJump);
+		compileConditionalExp(nt->getNonTerminalAt(4), program);
+		program.setJumpTarget(endJump);
 	}
-	
-	return result;
 }
@@ -10,11 +10,16 @@
 
 class DefineMap;
 class Preprocessor;
+class PreprocessorExpProgram;
 
 class PreprocessorExpParser {
 	public:
 		PreprocessorExpParser(const Preprocessor *preproc, const DefineMap & defMap);
 		
+		/*
+		 * The expression is compiled only the first time its tokens (with
+		 * the macros expanded) are seen by the preprocessor.
+		 */
 		bool parseExp(Input *exp) const;
 		
 	private:
@@ -22,24 +27,24 @@ class PreprocessorExpParser {
 		typedef ParsingTree::NonTerminal NonTerminal;
 		typedef ParsingTree::Token Token;
 		
-		Number evaluateExpression(NonTerminal *nt) const;
-		Number evaluatePrimaryExp(NonTerminal *nt) const;
-		Number evaluateUnaryExp(NonTerminal *nt) const;
-		Number evaluateUnaryOperator(NonTerminal *nt, Number num) const;
-		Number evaluateMultiplicativeExp(NonTerminal *nt) const;
-		Number evaluateAdditiveExp(NonTerminal *nt) const;
-		Number evaluateShiftExp(NonTerminal *nt) const;
-		Number evaluateRelationExp(NonTerminal *nt) const;
-		Number evaluateEqualityExp(NonTerminal *nt) const;
-		Number evaluateAndExp(NonTerminal *nt) const;
-		Number evaluateExclusiveOrExp(NonTerminal *nt) const;
-		Number evaluateInclusiveOrExp(NonTerminal *nt) const;
-		Number evaluateLogicalAndExp(NonTerminal *nt) const;
-		Number evaluateLogicalOrExp(NonTerminal *nt) const;
-		Number evaluateConditionalExp(NonTerminal *nt) const;
+		void compileExpression(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compilePrimaryExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileUnaryExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileUnaryOperator(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileMultiplicativeExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileAdditiveExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileShiftExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileRelationExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileEqualityExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileAndExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileExclusiveOrExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileInclusiveOrExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileLogicalAndExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileLogicalOrExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
+		void compileConditionalExp(NonTerminal *nt, PreprocessorExpProgram & program) const;
 		
-		Pointer<ScannerAutomata> scannerAutomata;
-		Pointer<ParserTable> parserTable;
+		// the tables are taken from it only when an expression is parsed
+		const Preprocessor *preprocessor;
 		
 		const DefineMap & defineMap;
 };
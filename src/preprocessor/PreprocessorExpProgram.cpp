@@ -0,0 +1,187 @@
+#include "preprocessor/PreprocessorExpProgram.h"
+
+#include "preprocessor/DefineMap.h"
+
+#include <parser/ParserError.h>
+
+#include <cassert>
+#include <cstdlib>
+
+static Number runBinary(PreprocessorExpProgram::Operation op, const Number & a, const Number & b,
+		const InputLocation & loc);
+		
+PreprocessorExpProgram::PreprocessorExpProgram() {}
+
+PreprocessorExpProgram::~PreprocessorExpProgram() {}
+
+void PreprocessorExpProgram::addPush(const Number & value) {
+	Instruction instruction;
+	instruction.operation = OP_PUSH;
+	instruction.value = value;
+	instruction.target = 0;
+	instructions.push_back(instruction);
+}
+
+void PreprocessorExpProgram::addName(Operation op, const std::string & name) {
+	assert(op == OP_DEFINED || op == OP_UNDEFINED);
+	
+	Instruction instruction;
+	instruction.operation = op;
+	instruction.name = name;
+	instruction.target = 0;
+	instructions.push_back(instruction);
+}
+
+void PreprocessorExpProgram::addOperation(Operation op) {
+	Instruction instruction;
+	instruction.operation = op;
+	instruction.target = 0;
+	instructions.push_back(instruction);
+}
+
+unsigned int PreprocessorExpProgram::addJump(Operation op) {
+	assert(op == OP_AND_JUMP || op == OP_OR_JUMP || op == OP_JUMP_FALSE || op == OP_JUMP);
+	
+	addOperation(op);
+	return instructions.size() - 1;
+}
+
+void PreprocessorExpProgram::setJumpTarget(unsigned int jump) {
+	assert(jump < instructions.size());
+	instructions[jump].target = instructions.size();
+}
+
+Number PreprocessorExpProgram::run(const DefineMap & defineMap, const InputLocation & loc) const {
+	std::vector<Number> stack;
+	
+	unsigned int pc = 0;
+	while (pc < instructions.size()) {
+		const Instruction & instruction = instructions[pc++];
+		
+		switch (instruction.operation) {
+			case OP_PUSH:
+				stack.push_back(instruction.value);
+				break;
+			case OP_DEFINED:
+				stack.push_back(Number(defineMap.isDefined(instruction.name)));
+				break;
+			case OP_UNDEFINED:
+				throw ParserError(loc, std::string("\"") + instruction.name + "\" undefined.");
+			case OP_PLUS:
+				break;
+			case OP_MINUS:
+				stack.back() = -stack.back();
+				break;
+			case OP_BIT_NOT:
+				if (stack.back().isFloat()) throw ParserError(loc, "Invalid unary operand.");
+				stack.back() = ~stack.back();
+				break;
+			case OP_NOT:
+				stack.back() = !stack.back();
+				break;
+			case OP_BOOL:
+				stack.back() = Number(stack.back().boolValue());
+				break;
+			case OP_AND_JUMP:
+				if (stack.back().boolValue()) stack.pop_back();
+				else {
+					stack.back() = Number(false);
+					pc = instruction.target;
+				}
+				break;
+			case OP_OR_JUMP:
+				if (!stack.back().boolValue()) stack.pop_back();
+				else {
+					stack.back() = Number(true);
+					pc = instruction.target;
+				}
+				break;
+			case OP_JUMP_FALSE:
+				if (!stack.back().boolValue()) pc = instruction.target;
+				stack.pop_back();
+				break;
+			case OP_JUMP:
+				pc = instruction.target;
+				break;
+			default:
+			{
+				assert(stack.size() >= 2);
+				
+				Number b = stack.back();
+				stack.pop_back();
+				stack.back() = runBinary(instruction.operation, stack.back(), b, loc);
+				break;
+			}
+		}
+	}
+	
+	assert(stack.size() == 1);
+	return stack.back();
+}
+
+static Number runBinary(PreprocessorExpProgram::Operation op, const Number & a, const Number & b,
+		const InputLocation & loc) {
+		
+	Number result;
+	
+	switch (op) {
+		case PreprocessorExpProgram::OP_MUL:
+			result = a * b;
+			break;
+		case PreprocessorExpProgram::OP_DIV:
+			result = a / b;
+			break;
+		case PreprocessorExpProgram::OP_MOD:
+			if (b.isFloat()) throw ParserError(loc, "Invalid operand.");
+			result = a % b;
+			break;
+		case PreprocessorExpProgram::OP_ADD:
+			result = a + b;
+			break;
+		case PreprocessorExpProgram::OP_SUB:
+			result = a - b;
+			break;
+		case PreprocessorExpProgram::OP_SHIFT_LEFT:
+			if (b.isFloat()) throw ParserError(loc, "Invalid operand.");
+			result = a << b.intValue();
+			break;
+		case PreprocessorExpProgram::OP_SHIFT_RIGHT:
+			if (b.isFloat()) throw ParserError(loc, "Invalid operand.");
+			result = a >> b.intValue();
+			break;
+		case PreprocessorExpProgram::OP_LESS:
+			result = Number(a < b);
+			break;
+		case PreprocessorExpProgram::OP_GREATER:
+			result = Number(a > b);
+			break;
+		case PreprocessorExpProgram::OP_LESS_EQUAL:
+			result = Number(a <= b);
+			break;
+		case PreprocessorExpProgram::OP_GREATER_EQUAL:
+			result = Number(a >= b);
+			break;
+		case PreprocessorExpProgram::OP_EQUAL:
+			result = Number(a == b);
+			break;
+		case PreprocessorExpProgram::OP_NOT_EQUAL:
+			result = Number(a != b);
+			break;
+		case PreprocessorExpProgram::OP_AND:
+			if (a.isFloat() || b.isFloat()) throw ParserError(loc, "use of invalid operand.");
+			result = a & b;
+			break;
+		case PreprocessorExpProgram::OP_XOR:
+			if (a.isFloat() || b.isFloat()) throw ParserError(loc, "use of invalid operand.");
+			result = a ^ b;
+			break;
+		case PreprocessorExpProgram::OP_OR:
+			if (a.isFloat() || b.isFloat()) throw ParserError(loc, "use of invalid operand.");
+			result = a | b;
+			break;
+		default:
+			abort();
+	}
+	
+	return result;
+}
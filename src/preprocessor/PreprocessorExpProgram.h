@@ -0,0 +1,94 @@
+#ifndef PREPROCESSOR_EXP_PROGRAM_H
+#define PREPROCESSOR_EXP_PROGRAM_H
+
+#include "Number.h"
+
+#include <parser/InputLocation.h>
+
+#include <string>
+#include <vector>
+
+class DefineMap;
+
+/*
+ * A #if expression compiled to postfix, run on a stack of numbers.
+ * The macros were expanded before it was compiled, so it can be run again
+ * for the same tokens; only "defined" looks at the DefineMap.
+ */
+class PreprocessorExpProgram {
+	public:
+		enum Operation {
+			OP_PUSH,
+			OP_DEFINED,
+			
+			// an identifier that is not a define, an error if it is evaluated
+			OP_UNDEFINED,
+			
+			OP_PLUS,
+			OP_MINUS,
+			OP_BIT_NOT,
+			OP_NOT,
+			
+			// turn the top into 0 or 1
+			OP_BOOL,
+			
+			OP_MUL,
+			OP_DIV,
+			OP_MOD,
+			OP_ADD,
+			OP_SUB,
+			OP_SHIFT_LEFT,
+			OP_SHIFT_RIGHT,
+			OP_LESS,
+			OP_GREATER,
+			OP_LESS_EQUAL,
+			OP_GREATER_EQUAL,
+			OP_EQUAL,
+			OP_NOT_EQUAL,
+			OP_AND,
+			OP_XOR,
+			OP_OR,
+			
+			/*
+			 * If the top is false (true) it is replaced by 0 (1) and the
+			 * jump is taken, otherwise it is popped. Used for && and ||.
+			 */
+			OP_AND_JUMP,
+			OP_OR_JUMP,
+			
+			// pop the top, jump if it is false
+			OP_JUMP_FALSE,
+			OP_JUMP
+		};
+		
+		PreprocessorExpProgram();
+		~PreprocessorExpProgram();
+		
+		void addPush(const Number & value);
+		
+		// OP_DEFINED or OP_UNDEFINED
+		void addName(Operation op, const std::string & name);
+		void addOperation(Operation op);
+		
+		// the target of the jump is set later, with setJumpTarget
+		unsigned int addJump(Operation op);
+		
+		// the jump goes to the next operation added
+		void setJumpTarget(unsigned int jump);
+		
+		// loc is where the errors are reported
+		Number run(const DefineMap & defineMap, const InputLocation & loc) const;
+		
+	private:
+		struct Instruction {
+			Operation operation;
+			Number value;
+			std::string name;
+			unsigned int target;
+		};
+		typedef std::vector<Instruction> InstructionList;
+		
+		InstructionList instructions;
+};
+
+#endif
@@ -14,7 +14,12 @@ static std::string getMacroName(const std::string & macro);
 PreprocessorExpScanner::PreprocessorExpScanner(const Pointer<ScannerAutomata> & a,
 		Input *in, const DefineMap & defMap) : Scanner(a, in), defineMap(defMap) {}
 
-PreprocessorExpScanner::~PreprocessorExpScanner() {}
+PreprocessorExpScanner::~PreprocessorExpScanner() {
+	while (!tokenQueue.empty()) {
+		delete(tokenQueue.front());
+		tokenQueue.pop();
+	}
+}
 
 ParsingTree::Token *PreprocessorExpScanner::nextToken() {
 	Token *token = NULL;
@@ -28,6 +33,22 @@ ParsingTree::Token *PreprocessorExpScanner::nextToken() {
 	return token;
 }
 
+std::string PreprocessorExpScanner::readExpression() {
+	std::vector<Token *> tokens;
+	
+	Token *token;
+	while ((token = nextToken())) tokens.push_back(token);
+	
+	std::string text;
+	for (std::vector<Token *>::const_iterator it = tokens.begin(); it != tokens.end(); ++it) {
+		text += (*it)->getToken();
+		text.push_back(' ');
+		tokenQueue.push(*it);
+	}
+	
+	return text;
+}
+
 PreprocessorExpScanner::Token *PreprocessorExpScanner::readToken() {
 	Token *token = Scanner::nextToken();
 	if (token) token = checkExpand(token);
@@ -5,6 +5,7 @@
 #include <parser/Scanner.h>
 
 #include <queue>
+#include <string>
 
 class DefineMap;
 
@@ -18,6 +19,12 @@ class PreprocessorExpScanner : public Scanner {
 		// return null if the end has been reached
 		virtual Token *nextToken();
 		
+		/*
+		 * Read (and expand) all the tokens, nextToken still returns them.
+		 * Return their text, that is the same for the same expression.
+		 */
+		std::string readExpression();
+		
 	private:
 		typedef std::queue<Token *> TokenQueue;
 		
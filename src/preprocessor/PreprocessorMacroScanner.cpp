@@ -1,44 +1,37 @@
 #include "preprocessor/PreprocessorMacroScanner.h"
 
 #include "preprocessor/DefineMap.h"
-#include "preprocessor/ComposedScannerWrapper.h"
-#include "preprocessor/DefaultScannerWrapper.h"
+#include "preprocessor/TextToken.h"
 #include "PreprocessorParserBuffer.h"
-#include "PreprocessorMacroIdScannerBuffer.h"
 #include "UccDefs.h"
 
 #include <parser/Input.h>
-#include <parser/MemoryInput.h>
-#include <parser/OffsetInput.h>
-#include <parser/ParserLoader.h>
-
-#include <cstring>
-
-// we need a smart pointer to ScannerWrapper, but making a smart pointer from
-// this would cause a double free
-class ScannerWrapperWrapper : public ScannerWrapper {
-	public:
-		ScannerWrapperWrapper(ScannerWrapper *wrap) : wrapper(wrap) {}
-		virtual ~ScannerWrapperWrapper() {}
-		
-		virtual ParsingTree::Token *scannerNextToken() {
-			return wrapper->scannerNextToken();
-		}
-		
-	private:
-		ScannerWrapper *wrapper;
-};
+#include <parser/ParserError.h>
 
-PreprocessorMacroScanner::PreprocessorMacroScanner(const Pointer<ScannerAutomata> & a, Input *in,
-				const DefineMap & defMap) : PreprocessorScanner(a, in), defineMap(defMap) {
-	
-	if (!preprocessorMacroIdScannerAutomata) {
-		preprocessorMacroIdScannerAutomata = ParserLoader::bufferToAutomata(prepro_macro_id_buffer_scanner);
-	}
-}
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+/*****************************************************************************
+ * PreprocessorMacroScanner::ExpansionToken
+ *****************************************************************************/
+PreprocessorMacroScanner::ExpansionToken::ExpansionToken(const DefineMap::MacroToken & tok,
+		const HideSet *hs, unsigned int l, unsigned int c) : token(tok), hideSet(hs), line(l), column(c) {}
+
+/*****************************************************************************
+ * PreprocessorMacroScanner
+ *****************************************************************************/
+PreprocessorMacroScanner::PreprocessorMacroScanner(const Pointer<ScannerAutomata> & a,
+		Input *in, const DefineMap & defMap) : PreprocessorScanner(a, in), defineMap(defMap),
+		expandMacros(true) {}
 
 PreprocessorMacroScanner::~PreprocessorMacroScanner() {}
 
+void PreprocessorMacroScanner::setExpandMacros(bool expand) {
+	expandMacros = expand;
+}
+
 ParsingTree::Token *PreprocessorMacroScanner::readTextToken(Token *startToken) {
 	assert(!cachedToken);
 	
@@ -46,208 +39,253 @@ ParsingTree::Token *PreprocessorMacroScanner::readTextToken(Token *startToken) {
 	if (!token || token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_DIRECTIVE_END) return token;
 	
 	InputLocation loc = token->getInputLocation();
+	unsigned int line = loc.getLine();
 	std::string tok;
+	TextToken::PositionList positions;
 	
-	while (token && token->getTokenTypeId() != PREPROCESSORPARSERBUFFER_TOKEN_DIRECTIVE_END) {
-		IdentifierSet expanded;
-		Pointer<ScannerWrapper> wrapper = new ScannerWrapperWrapper(this);
-		append(wrapper, tok, token, expanded);
+	DefineMap::MacroTokenList first;
+	defineMap.appendToken(first, token);
+	delete(token);
+	
+	ExpansionTokenList tokens;
+	for (DefineMap::MacroTokenList::const_iterator it = first.begin(); it != first.end(); ++it) {
+		tokens.push_back(ExpansionToken(*it, NULL, loc.getLine(), loc.getColumn()));
+	}
+	
+	// the directive end is left in cachedToken
+	while (fill(tokens, true, false)) {
+		ExpansionToken t = tokens.front();
+		tokens.pop_front();
 		
-		delete(token);
+		if (expand(t, tokens, true)) continue;
+		
+		// after a macro call across lines, the text goes on in the line of the code
+		for (; line < t.line; ++line) tok.push_back('\n');
 		
-		token = scannerNextToken();
+		TextToken::Position position;
+		position.start = tok.size();
+		position.length = t.token.getText().size();
+		position.line = t.line;
+		position.column = t.column;
+		positions.push_back(position);
+		
+		tok += t.token.getText();
+		tok.push_back(DELIMITER);
 	}
-	cachedToken = token;
-	
-	token = new Token(PREPROCESSORPARSERBUFFER_TOKEN_TEXT, tok, loc);
 	
-	return token;
-}
-
-ParsingTree::Token *PreprocessorMacroScanner::scannerNextToken() {
-	assert(!cachedToken);
-	return Scanner::nextToken();
+	return new TextToken(tok, loc, positions);
 }
 
-void PreprocessorMacroScanner::append(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-		Token *token, IdentifierSet & expanded) {
+bool PreprocessorMacroScanner::fill(ExpansionTokenList & tokens, bool fromInput, bool acrossLines) {
+	if (!tokens.empty()) return true;
+	if (!fromInput) return false;
 	
-	if (isDefined(token, expanded)) expand(wrapper, result, token, expanded);
-	else appendToken(result, token);
-}
-
-void PreprocessorMacroScanner::expand(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-		Token *token, IdentifierSet & expanded) {
+	Token *token = cachedToken;
+	cachedToken = NULL;
+	if (!token) token = Scanner::nextToken();
 	
-	if (isIdentifierToken(token)) {
-		const std::string & name = token->getToken();
-		
-		if (defineMap.defineDefined(name)) expandDefine(wrapper, result, name, expanded);
-		else {
-			assert(defineMap.macroDefined(name));
-			
-			Token *t = wrapper->scannerNextToken();
-			if (t->getToken() == "(") expandMacro(wrapper, result, name, expanded);
-			else {
-				appendToken(result, token);
-				cachedToken = t;
-			}
+	// the arguments of a macro call can go on in the next lines,
+	// the line ends between them are not tokens of the code
+	while (token && token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_DIRECTIVE_END) {
+		if (!acrossLines) {
+			cachedToken = token;
+			return false;
 		}
-	}
-	else if (isMacroToken(token)) {
-		std::string name = getMacroName(token);
 		
-		if (defineMap.defineDefined(name)) expandDefine(wrapper, result, name, expanded);
-		else {
-			assert(defineMap.macroDefined(name));
-			expandMacro(wrapper, result, name, expanded);
-		}
+		delete(token);
+		token = Scanner::nextToken();
 	}
-}
-
-void PreprocessorMacroScanner::expandDefine(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-		const std::string & defineName, IdentifierSet & expanded) {
 	
-	defExpanded(wrapper, result, defineMap.getDefine(defineName), expanded);
-}
-
-void PreprocessorMacroScanner::expandMacro(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-		const std::string & macroName, IdentifierSet & expanded) {
+	if (!token) return false;
 	
-	assert(!cachedToken);
+	InputLocation loc = token->getInputLocation();
 	
-	DefineMap::Macro *macro = defineMap.getMacro(macroName);
-	assert(macro);
+	DefineMap::MacroTokenList list;
+	defineMap.appendToken(list, token);
+	delete(token);
 	
-	DefineMap::ArgumentList args;
+	for (DefineMap::MacroTokenList::const_iterator it = list.begin(); it != list.end(); ++it) {
+		tokens.push_back(ExpansionToken(*it, NULL, loc.getLine(), loc.getColumn()));
+	}
 	
-	unsigned int numVars = macro->getVariablesCount();
+	return true;
+}
+
+bool PreprocessorMacroScanner::expand(const ExpansionToken & token, ExpansionTokenList & tokens,
+		bool fromInput) {
 	
-	for (unsigned int i = 0; i < numVars; ++i) {
-		std::string arg;
-		readMacroArgument(wrapper, arg, expanded);
-		args.push_back(arg);
-		
-		if (i < numVars - 1) {
-			assert(cachedToken);
-			Token *t = cachedToken;
-			cachedToken = NULL;
-			if (t->getToken() != ",") {
-				InputLocation loc = t->getInputLocation();
-				delete(t);
-				throw ParserError(loc, "Expecting \',\'");
-			}
-			delete(t);
-		}
-	}
+	if (!expandMacros || !token.token.isIdentifier()) return false;
 	
-	assert(cachedToken);
-	Token *t = cachedToken;
-	cachedToken = NULL;
-	if (t->getToken() != ")") {
-		InputLocation loc = t->getInputLocation();
-		delete(t);
-		throw ParserError(loc, "Expecting \')\'");
-	}
-	delete(t);
+	DefineMap::Id name = token.token.getIdentifier();
+	if (token.hideSet && token.hideSet->count(name)) return false;
 	
-	std::string macroResult = macro->expandMacro(args);
+	if (defineMap.defineDefined(name)) return expandDefine(token, tokens);
+	if (defineMap.macroDefined(name)) return expandMacro(token, tokens, fromInput);
 	
-	defExpanded(wrapper, result, macroResult, expanded);
+	return false;
 }
 
-void PreprocessorMacroScanner::defExpanded(const Pointer<ScannerWrapper> & wrapper,
-		std::string & result, const std::string & expansion, IdentifierSet & expanded) {
+bool PreprocessorMacroScanner::expandDefine(const ExpansionToken & token, ExpansionTokenList & tokens) {
+	DefineMap::Id name = token.token.getIdentifier();
+	const HideSet *hideSet = addToHideSet(token.hideSet, name);
 	
-	InputLocation loc = getInput()->getCurrentLocation();
-	Input *in = new OffsetInput(new MemoryInput(expansion), loc.getLine() - 1, loc.getName());
-	Pointer<ScannerWrapper> w = new DefaultScannerWrapper(new Scanner(preprocessorMacroIdScannerAutomata, in));
+	const DefineMap::MacroTokenList *value = defineMap.getDefineTokens(name);
 	
-	Pointer<ScannerWrapper> composed = new ComposedScannerWrapper(w, wrapper);
+	// the standard defines are a single constant or string
+	if (!value) {
+		tokens.push_front(ExpansionToken(DefineMap::MacroToken(defineMap.getDefine(name)), hideSet,
+				token.line, token.column));
+		return true;
+	}
 	
-	Token *token;
-	while ((token = w->scannerNextToken())) {
-		result.push_back(DELIMITER);
-		append(composed, result, token, expanded);
-		delete(token);
+	ExpansionTokenList result;
+	for (DefineMap::MacroTokenList::const_iterator it = value->begin(); it != value->end(); ++it) {
+		result.push_back(ExpansionToken(*it, hideSet, token.line, token.column));
 	}
-	result.push_back(DELIMITER);
+	tokens.insert(tokens.begin(), result.begin(), result.end());
+	
+	return true;
 }
 
-void PreprocessorMacroScanner::readMacroArgument(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-		IdentifierSet & expanded) {
+bool PreprocessorMacroScanner::expandMacro(const ExpansionToken & token, ExpansionTokenList & tokens,
+		bool fromInput) {
+	
+	// without the '(' it is just an identifier
+	if (!fill(tokens, fromInput, false) || tokens.front().token.getText() != "(") return false;
+	
+	// the tokens read, to give them back if the ')' is missing
+	ExpansionTokenList read;
+	read.push_back(tokens.front());
+	tokens.pop_front();
 	
-	Token *t = NULL;
+	std::vector<ExpansionTokenList> args(1);
 	int openPar = 0;
 	
-	while (openPar >= 0) {
-		t = wrapper->scannerNextToken();
-		if (!t) throw ParserError("Unexpected end of file.");
+	for (;;) {
+		if (!fill(tokens, fromInput, true)) {
+			if (fromInput) throw ParserError("Unexpected end of file.");
+			
+			// a call that is not complete inside an argument is not expanded
+			tokens.insert(tokens.begin(), read.begin(), read.end());
+			return false;
+		}
 		
-		if (t->getToken() == ")") {
+		ExpansionToken t = tokens.front();
+		tokens.pop_front();
+		read.push_back(t);
+		
+		const std::string & text = t.token.getText();
+		if (text == ")") {
 			if (--openPar < 0) break;
 		}
-		else if (t->getToken() == "(") ++openPar;
-		else if (t->getToken() == "," && openPar <= 0)  break;
+		else if (text == "(") ++openPar;
+		else if (text == "," && openPar == 0) {
+			args.push_back(ExpansionTokenList());
+			continue;
+		}
 		
-		appendToken(result, t);
+		args.back().push_back(t);
 	}
 	
-	assert(t);
-	cachedToken = t;
-}
-
-bool PreprocessorMacroScanner::isDefined(Token *token, IdentifierSet & expanded) {
-	if (isIdentifierToken(token)) {
-		const std::string & name = token->getToken();
-		if (defineMap.isDefined(name) && expanded.find(name) == expanded.end()) {
-			expanded.insert(name);
-			return true;
-		}
+	DefineMap::Id name = token.token.getIdentifier();
+	DefineMap::Macro *macro = defineMap.getMacro(name);
+	
+	// f() has no arguments, not an empty one
+	if (macro->getVariablesCount() == 0 && args.size() == 1 && args[0].empty()) args.clear();
+	if (args.size() != macro->getVariablesCount()) {
+		throw ParserError(std::string("Wrong number of arguments to macro ") + token.token.getText() + ".");
 	}
-	else if (isMacroToken(token)) {
-		const std::string & name = getMacroName(token);
-		if (defineMap.isDefined(name) && expanded.find(name) == expanded.end()) {
-			expanded.insert(name);
-			return true;
+	
+	// the hide set of the ')' is used, the tokens after it were not in the expansion
+	const HideSet *hideSet = intersectHideSets(token.hideSet, read.back().hideSet);
+	hideSet = addToHideSet(hideSet, name);
+	
+	// each argument is expanded only once, even if used many times
+	std::vector<ExpansionTokenList> expandedArgs(args.size());
+	std::vector<bool> argExpanded(args.size(), false);
+	
+	ExpansionTokenList result;
+	const DefineMap::MacroTokenList & value = macro->getTokens();
+	
+	for (DefineMap::MacroTokenList::const_iterator it = value.begin(); it != value.end(); ++it) {
+		if (!it->isParameter()) {
+			result.push_back(ExpansionToken(*it, hideSet, token.line, token.column));
+			continue;
+		}
+		
+		unsigned int index = it->getParameterIndex();
+		if (!argExpanded[index]) {
+			expandTokens(args[index], expandedArgs[index]);
+			argExpanded[index] = true;
+		}
+		
+		const ExpansionTokenList & arg = expandedArgs[index];
+		for (ExpansionTokenList::const_iterator argIt = arg.begin(); argIt != arg.end(); ++argIt) {
+			result.push_back(ExpansionToken(argIt->token, mergeHideSets(argIt->hideSet, hideSet),
+					token.line, token.column));
 		}
 	}
 	
-	return false;
+	tokens.insert(tokens.begin(), result.begin(), result.end());
+	
+	return true;
+}
+
+void PreprocessorMacroScanner::expandTokens(ExpansionTokenList & tokens, ExpansionTokenList & result) {
+	while (!tokens.empty()) {
+		ExpansionToken t = tokens.front();
+		tokens.pop_front();
+		
+		if (!expand(t, tokens, false)) result.push_back(t);
+	}
 }
 
-std::string PreprocessorMacroScanner::getMacroName(Token *token) const {
-	assert(token);
-	const std::string & tok = token->getToken();
-	if (token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_IDENTIFIER) return tok;
-	assert(token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_MACRO);
+const PreprocessorMacroScanner::HideSet *PreprocessorMacroScanner::getHideSet(const HideSet & hideSet) {
+	if (hideSet.empty()) return NULL;
+	return &*hideSets.insert(hideSet).first;
+}
+
+const PreprocessorMacroScanner::HideSet *PreprocessorMacroScanner::addToHideSet(const HideSet *hideSet,
+		DefineMap::Id name) {
 	
-	assert(tok.size() > 1);
+	std::pair<const HideSet *, DefineMap::Id> key(hideSet, name);
 	
-	char buf[tok.size() + 1];
-	strcpy(buf, tok.c_str());
+	HideSetAddCache::const_iterator it = addCache.find(key);
+	if (it != addCache.end()) return it->second;
 	
-	// remove the '('
-	buf[tok.size() - 1] = '\0';
+	HideSet result;
+	if (hideSet) result = *hideSet;
+	result.insert(name);
 	
-	return std::string(buf);
+	return addCache[key] = getHideSet(result);
 }
 
-bool PreprocessorMacroScanner::isIdentifierToken(Token *token) const {
-	assert(token);
+const PreprocessorMacroScanner::HideSet *PreprocessorMacroScanner::mergeHideSets(const HideSet *hs1,
+		const HideSet *hs2) {
+	
+	if (!hs1 || hs1 == hs2) return hs2;
+	if (!hs2) return hs1;
+	
+	std::pair<const HideSet *, const HideSet *> key(hs1, hs2);
+	
+	HideSetMergeCache::const_iterator it = mergeCache.find(key);
+	if (it != mergeCache.end()) return it->second;
 	
-	// ScannerWrapper may use a different id, so we need to check thy the regex
-	return identifierRegex.matches(token->getToken());
+	HideSet result(*hs1);
+	result.insert(hs2->begin(), hs2->end());
+	
+	return mergeCache[key] = getHideSet(result);
 }
 
-bool PreprocessorMacroScanner::isMacroToken(Token *token) const {
-	assert(token);
+const PreprocessorMacroScanner::HideSet *PreprocessorMacroScanner::intersectHideSets(const HideSet *hs1,
+		const HideSet *hs2) {
+	
+	if (!hs1 || !hs2) return NULL;
+	if (hs1 == hs2) return hs1;
 	
-	// ScannerWrapper may use a different id, so we need to check thy the regex
-	return macroRegex.matches(token->getToken());
+	HideSet result;
+	std::set_intersection(hs1->begin(), hs1->end(), hs2->begin(), hs2->end(),
+			std::inserter(result, result.begin()));
+			
+	return getHideSet(result);
 }
-
-Regex PreprocessorMacroScanner::identifierRegex = Regex("\\w(\\w|\\d)*");
-Regex PreprocessorMacroScanner::macroRegex = Regex("\\w(\\w|\\d)*\\(");
-
-Pointer<ScannerAutomata> PreprocessorMacroScanner::preprocessorMacroIdScannerAutomata;
@@ -1,64 +1,91 @@
 #ifndef PREPROCESSOR_MACRO_SCANNER_H
 #define PREPROCESSOR_MACRO_SCANNER_H
 
+#include "preprocessor/DefineMap.h"
 #include "preprocessor/PreprocessorScanner.h"
-#include "preprocessor/ScannerWrapper.h"
 
 #include <parser/Pointer.h>
-#include <parser/Regex.h>
 #include <parser/ScannerAutomata.h>
 
+#include <deque>
+#include <map>
 #include <set>
-#include <string>
+#include <utility>
 
-class DefineMap;
-class InputWrapper;
-
-class PreprocessorMacroScanner : public PreprocessorScanner, private ScannerWrapper {
+/*
+ * Expand the macros in the text lines, on the tokens lexed when the macros
+ * were defined (Prosser's algorithm). Each token keeps the set of macros it
+ * came from (its hide set), they are not expanded again in that token.
+ */
+class PreprocessorMacroScanner : public PreprocessorScanner {
 	public:
-		typedef std::set<std::string> IdentifierSet;
-		
 		PreprocessorMacroScanner(const Pointer<ScannerAutomata> & a, Input *in,
 				const DefineMap & defMap);
 		virtual ~PreprocessorMacroScanner();
 		
-	protected:
-		virtual Token *readTextToken(Token *startToken);
+		// inside an inactive #if the text is skipped, so it is not expanded
+		void setExpandMacros(bool expand);
 		
-		void append(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-				Token *token, IdentifierSet & expanded);
+	protected:
+		// the ids of the macros
+		typedef std::set<DefineMap::Id> HideSet;
 		
-		void expand(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-				Token *token, IdentifierSet & expanded);
+		struct ExpansionToken {
+			ExpansionToken(const DefineMap::MacroToken & tok, const HideSet *hs,
+					unsigned int l, unsigned int c);
+			
+			DefineMap::MacroToken token;
+			
+			// NULL if the token was not produced by a macro
+			const HideSet *hideSet;
+			
+			// in the source, the tokens of an expansion are where the macro is
+			unsigned int line;
+			unsigned int column;
+		};
+		typedef std::deque<ExpansionToken> ExpansionTokenList;
 		
-		void expandDefine(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-				const std::string & defineName, IdentifierSet & expanded);
-		void expandMacro(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-				const std::string & macroName, IdentifierSet & expanded);
+		virtual Token *readTextToken(Token *startToken);
 		
-		void readMacroArgument(const Pointer<ScannerWrapper> & wrapper, std::string & result,
-				IdentifierSet & expanded);
+		/*
+		 * Make sure tokens is not empty, reading the next token of the input
+		 * if fromInput. Return false if there is no token. The directive
+		 * ends are skipped if acrossLines, otherwise one ends the tokens.
+		 */
+		bool fill(ExpansionTokenList & tokens, bool fromInput, bool acrossLines);
 		
-		void defExpanded(const Pointer<ScannerWrapper> & wrapper,
-				std::string & result, const std::string & expansion, IdentifierSet & expanded);
+		/*
+		 * If token is a macro that can be expanded, put its expansion in
+		 * the front of tokens (to be scanned again) and return true.
+		 * The arguments of a macro are read from tokens (and the input
+		 * if fromInput).
+		 */
+		bool expand(const ExpansionToken & token, ExpansionTokenList & tokens, bool fromInput);
 		
-		void flushOutput();
+		bool expandDefine(const ExpansionToken & token, ExpansionTokenList & tokens);
+		bool expandMacro(const ExpansionToken & token, ExpansionTokenList & tokens, bool fromInput);
 		
-	private:
-		virtual Token *scannerNextToken();
+		// expand all the tokens, without reading the input
+		void expandTokens(ExpansionTokenList & tokens, ExpansionTokenList & result);
 		
-		bool isDefined(Token *token, IdentifierSet & expanded);
-		std::string getMacroName(Token *token) const;
+		const HideSet *getHideSet(const HideSet & hideSet);
+		const HideSet *addToHideSet(const HideSet *hideSet, DefineMap::Id name);
+		const HideSet *mergeHideSets(const HideSet *hs1, const HideSet *hs2);
+		const HideSet *intersectHideSets(const HideSet *hs1, const HideSet *hs2);
 		
-		bool isIdentifierToken(Token *token) const;
-		bool isMacroToken(Token *token) const;
+	private:
+		typedef std::set<HideSet> HideSetPool;
+		typedef std::map<std::pair<const HideSet *, DefineMap::Id>, const HideSet *> HideSetAddCache;
+		typedef std::map<std::pair<const HideSet *, const HideSet *>, const HideSet *> HideSetMergeCache;
 		
 		const DefineMap & defineMap;
 		
-		static Regex identifierRegex;
-		static Regex macroRegex;
+		bool expandMacros;
 		
-		static Pointer<ScannerAutomata> preprocessorMacroIdScannerAutomata;
+		// each different hide set is kept once, the tokens point to it
+		HideSetPool hideSets;
+		HideSetAddCache addCache;
+		HideSetMergeCache mergeCache;
 };
 
 #endif
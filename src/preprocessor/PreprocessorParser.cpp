@@ -1,17 +1,20 @@
 #include "preprocessor/PreprocessorParser.h"
 
 #include "preprocessor/DefineMap.h"
+#include "preprocessor/OutputBufferInput.h"
+#include "preprocessor/PrecompiledHeader.h"
 #include "preprocessor/Preprocessor.h"
 #include "preprocessor/PreprocessorContext.h"
 #include "preprocessor/PreprocessorExpParser.h"
 #include "preprocessor/PreprocessorMacroScanner.h"
+#include "preprocessor/TextToken.h"
+#include "MemReport.h"
 #include "PreprocessorParserBuffer.h"
+#include "TokenStream.h"
 #include "UccDefs.h"
 #include "UccUtils.h"
 
-#include <parser/FileInput.h>
 #include <parser/Input.h>
-#include <parser/IOError.h>
 #include <parser/ListInput.h>
 #include <parser/MemoryInput.h>
 #include <parser/OffsetInput.h>
@@ -19,13 +22,18 @@
 #include <parser/ParserError.h>
 #include <parser/Scanner.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 
+// the most new lines added to a chunk to reach the next code
+#define MAX_LINE_PADDING 8
+
 PreprocessorParser::PreprocessorParser(PreprocessorContext & preprocCtx,
 		DefineMap & defMap) : PreprocessorParserBase(preprocCtx, defMap),
-		includeDirs(preprocCtx.getPreprocessor()->getIncludeDirs()) {
+		systemHeader(false), scanner(NULL),
+		chunkStart(preprocCtx.getOutputBuffer()->size()), chunkLine(0), outputLine(0), lineOffset(0) {
 	
 	const Preprocessor *preproc = preprocessorContext.getPreprocessor();
 	expParser = new PreprocessorExpParser(preproc, defineMap);
@@ -36,7 +44,8 @@ PreprocessorParser::PreprocessorParser(PreprocessorContext & preprocCtx,
 PreprocessorParser::PreprocessorParser(PreprocessorContext & preprocCtx,
 		DefineMap & defMap, ListInput *output) :
 		PreprocessorParserBase(preprocCtx, defMap, output),
-		includeDirs(preprocCtx.getPreprocessor()->getIncludeDirs()) {
+		systemHeader(false), scanner(NULL),
+		chunkStart(preprocCtx.getOutputBuffer()->size()), chunkLine(0), outputLine(0), lineOffset(0) {
 	
 	const Preprocessor *preproc = preprocessorContext.getPreprocessor();
 	expParser = new PreprocessorExpParser(preproc, defineMap);
@@ -46,22 +55,57 @@ PreprocessorParser::~PreprocessorParser() {
 	delete(expParser);
 }
 
+void PreprocessorParser::setSystemHeader(bool system) {
+	systemHeader = system;
+}
+
 void PreprocessorParser::parse(Input *in) {
 	const Preprocessor *preproc = preprocessorContext.getPreprocessor();
 	
 	preprocessorContext.setInput(in);
+	std::string fileName = in->getInputName();
 	
-	Scanner *scan = new PreprocessorMacroScanner(preproc->getScannerAutomata(), in, defineMap);
-	parser = new Parser(preproc->getParserTable(), scan);
+	scanner = new PreprocessorMacroScanner(preproc->getScannerAutomata(), in, defineMap);
+	parser = new Parser(preproc->getParserTable(), scanner);
+	parser->setParserAction(this);
 	
 	NonTerminal *root = (NonTerminal *)parser->parse();
-	parsePreprocessor(root);
+	MemReport::addParsingTree(root);
+	
+	// only the headers are kept by the preprocessor, for the others it does nothing
+	preproc->setHeaderGuard(fileName, getIncludeGuard(root));
 	
 	delete(root);
 	
 	flushOutput();
 }
 
+void PreprocessorParser::recognized(NonTerminal *nt) {
+	switch (nt->getNonTerminalId()) {
+		case PREPROCESSORPARSERBUFFER_NONTERMINAL_CODE:
+			writeCode(nt);
+			break;
+		case PREPROCESSORPARSERBUFFER_NONTERMINAL_IF_LINE:
+			parseIfLine(nt);
+			break;
+		case PREPROCESSORPARSERBUFFER_NONTERMINAL_ELIF_LINE:
+			parseElifLine(nt);
+			break;
+		case PREPROCESSORPARSERBUFFER_NONTERMINAL_ELSE_LINE:
+			parseElseLine(nt);
+			break;
+		case PREPROCESSORPARSERBUFFER_NONTERMINAL_ENDIF_LINE:
+			parseEndifLine(nt);
+			break;
+		case PREPROCESSORPARSERBUFFER_NONTERMINAL_CONTROL_LINE:
+			if (isActive()) parseControlLine(nt);
+			break;
+		default:
+			// just ignore it
+			break;
+	}
+}
+
 /*
  * <CONTROL_LINE> ::= <DEFINE_LINE>
  *		| <UNDEF_LINE>
@@ -87,52 +131,28 @@ void PreprocessorParser::parseControlLine(NonTerminal *ctrlLine) {
 			parseInclude(ctrlLine->getNonTerminalAt(0));
 			break;
 		case 3: // <CONTROL_LINE> ::= <CONDITIONAL>
-			parseConditional(ctrlLine->getNonTerminalAt(0));
+			// the lines of the conditional were handled as they were recognized
 			break;
 		case 4: // <CONTROL_LINE> ::= <LINE_LINE>
 			parseLine(ctrlLine->getNonTerminalAt(0));
 			break;
 		case 5: // <CONTROL_LINE> ::= <ERROR_LINE>
-			throw ParserError(ctrlLine->getInputLocation(), getCode(ctrlLine->getNonTerminalAt(1)));
+			throw ParserError(ctrlLine->getInputLocation(),
+					getCode(ctrlLine->getNonTerminalAt(0)->getNonTerminalAt(1)));
 			break;
 		case 6: // <CONTROL_LINE> ::= <WARNING_LINE>
 			// always show, even if showWarnings is false
 			std::cerr << ctrlLine->getInputLocation() << " warning: "
-					<< cleanToken(ctrlLine->getTokenAt(1)) << std::endl;
+					<< cleanToken(ctrlLine->getNonTerminalAt(0)->getTokenAt(1)) << std::endl;
 			break;
 		case 7: // <CONTROL_LINE> ::= <PRAGMA_LINE>
-			if (showWarnings) {
-				std::cerr << "warning: ignoring #pragma at " << ctrlLine->getInputLocation() << std::endl;
-			}
+			parsePragma(ctrlLine->getNonTerminalAt(0));
 			break;
 		default:
 			abort();
 	}
 }
 
-/*
- * <DEFINE_LINE> ::= DEFINE IDENTIFIER <CODE_WITHOUT_DIRECTEND> DIRECTIVE_END
- *		| DEFINE MACRO <IDENTIFIER_LIST> P_CLOSE <CODE_WITHOUT_DIRECTEND> DIRECTIVE_END
- *		| DEFINE MACRO P_CLOSE <CODE_WITHOUT_DIRECTEND> DIRECTIVE_END
- *		;
- */
-void PreprocessorParser::parseDefine(NonTerminal *nonTerminal) {
-	PreprocessorParserBase::parseDefine(nonTerminal);
-	
-	// it will be parsed in the second step of the preprocessor
-	writeNonTerminal(nonTerminal);
-}
-
-/*
- * <UNDEF_LINE> ::= UNDEF IDENTIFIER DIRECTIVE_END;
- */
-void PreprocessorParser::parseUndef(NonTerminal *nonTerminal) {
-	PreprocessorParserBase::parseUndef(nonTerminal);
-	
-	// it will be parsed again in the second step of the preprocessor
-	writeNonTerminal(nonTerminal);
-}
-
 /*
  * <INCLUDE_LINE> ::= INCLUDE FILENAME_SYSTEM DIRECTIVE_END
  *		| INCLUDE STRING_LITERAL DIRECTIVE_END
@@ -144,10 +164,12 @@ void PreprocessorParser::parseInclude(NonTerminal *nonTerminal) {
 	
 	// if true, it will be an error if the file is not found
 	bool errorOnNF = false;
+	bool system = systemHeader;
 	std::string fileName;
 	
 	switch (nonTerminal->getNonTerminalRule()) {
 		case 0: // <INCLUDE_LINE> ::= INCLUDE FILENAME_SYSTEM DIRECTIVE_END
+			system = true;
 			fileName = cleanToken(nonTerminal->getTokenAt(1));
 			break;
 		case 1: // <INCLUDE_LINE> ::= INCLUDE STRING_LITERAL DIRECTIVE_END
@@ -167,6 +189,7 @@ void PreprocessorParser::parseInclude(NonTerminal *nonTerminal) {
 			char l = def[def.size() - 1];
 			if ((f == '\"' &&  l == '\"') || (f == '<' &&  l == '>')) {
 				fileName = cleanToken(def);
+				if (f == '<') system = true;
 			}
 			else throw ParserError(nonTerminal->getInputLocation(), "Bad include define.");
 			
@@ -176,24 +199,24 @@ void PreprocessorParser::parseInclude(NonTerminal *nonTerminal) {
 			abort();
 	}
 	
-	Input *fileInput = NULL;
-	
-	for (FileList::const_iterator it = includeDirs.begin(); it != includeDirs.end(); ++it) {
-		try {
-			fileInput = new FileInput(*it + fileName);
-			break;
-		}
-		catch (IOError & error) {}
-	}
+	const Preprocessor *preproc = preprocessorContext.getPreprocessor();
+	std::string path = preproc->findHeader(fileName);
 	
-	if (fileInput) {
-		currentOutput += std::string("\n#line ") + "1 \"" + fileInput->getInputName() + "\"";
+	if (!path.empty()) {
+		preprocessorContext.addDependency(path, system);
+		
+		if (isIncludeSkipped(path)) return;
 		
+		Input *fileInput = preproc->openHeader(path);
+		if (!fileInput) throw ParserError(nonTerminal->getInputLocation(), "Cannot read include file: " + path);
+		
+		// the header is written in its own chunks
 		flushOutput();
 		
 		preprocessorContext.incIncludeLevel();
 		PreprocessorParser p(preprocessorContext, defineMap, listInput);
 		p.setShowWarnings(showWarnings && errorOnNF);
+		p.setSystemHeader(system);
 		p.parse(fileInput);
 		preprocessorContext.setInput(parser->getScanner()->getInput());
 		preprocessorContext.decIncludeLevel();
@@ -205,6 +228,70 @@ void PreprocessorParser::parseInclude(NonTerminal *nonTerminal) {
 	}
 }
 
+/*
+ * <PRAGMA_LINE> ::= PRAGMA STRING_LITERAL DIRECTIVE_END;
+ */
+void PreprocessorParser::parsePragma(NonTerminal *nonTerminal) {
+	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_PRAGMA_LINE);
+	
+	std::string pragma = cleanToken(nonTerminal->getTokenAt(1));
+	
+	std::string::size_type begin = pragma.find_first_not_of(" \t");
+	std::string::size_type end = pragma.find_last_not_of(" \t");
+	if (begin != std::string::npos) pragma = pragma.substr(begin, end - begin + 1);
+	
+	if (pragma == "once") {
+		preprocessorContext.setIncludeOnce(parser->getScanner()->getInput()->getInputName());
+	}
+	else if (showWarnings) {
+		std::cerr << "warning: ignoring #pragma at " << nonTerminal->getInputLocation() << std::endl;
+	}
+}
+
+bool PreprocessorParser::isIncludeSkipped(const std::string & fileName) const {
+	if (preprocessorContext.isIncludeOnce(fileName)) return true;
+	
+	const std::string & guard = preprocessorContext.getPreprocessor()->getHeaderGuard(fileName);
+	return !guard.empty() && defineMap.isDefined(guard);
+}
+
+/*
+ * The file must be:
+ * <PREPROCESSOR> ::= <CODE> <CONTROL_LINE> <PREPROCESSOR>
+ * with blank <CODE>s, <CONTROL_LINE> ::= <CONDITIONAL> and the last
+ * <PREPROCESSOR> ::= <CODE>
+ *
+ * <CONDITIONAL> ::= <IF_LINE> <PREPROCESSOR> <ELIF_PARTS>
+ * with <IF_LINE> ::= IFNDEF IDENTIFIER DIRECTIVE_END
+ * and <ELIF_PARTS> ::= <ELSE_PART> ::= <ENDIF_LINE>
+ */
+std::string PreprocessorParser::getIncludeGuard(NonTerminal *root) const {
+	assert(root->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_PREPROCESSOR);
+	
+	if (root->getNonTerminalRule() != 0) return "";
+	
+	NonTerminal *ctrlLine = root->getNonTerminalAt(1);
+	NonTerminal *rest = root->getNonTerminalAt(2);
+	
+	if (!isBlankCode(root->getNonTerminalAt(0)) || ctrlLine->getNonTerminalRule() != 3) return "";
+	if (rest->getNonTerminalRule() != 1 || !isBlankCode(rest->getNonTerminalAt(0))) return "";
+	
+	NonTerminal *conditional = ctrlLine->getNonTerminalAt(0);
+	NonTerminal *ifLine = conditional->getNonTerminalAt(0);
+	NonTerminal *elifParts = conditional->getNonTerminalAt(2);
+	
+	if (ifLine->getNonTerminalRule() != 2) return "";
+	if (elifParts->getNonTerminalRule() != 1) return "";
+	if (elifParts->getNonTerminalAt(0)->getNonTerminalRule() != 1) return "";
+	
+	return ifLine->getTokenAt(1)->getToken();
+}
+
+bool PreprocessorParser::isBlankCode(NonTerminal *code) const {
+	std::string c = getCode(code);
+	return c.find_first_not_of(" \t\r\n\f\v") == std::string::npos;
+}
+
 /*
  * <LINE_LINE> ::= LINE CONSTANT STRING_LITERAL DIRECTIVE_END
  *		| LINE CONSTANT DIRECTIVE_END
@@ -213,21 +300,35 @@ void PreprocessorParser::parseInclude(NonTerminal *nonTerminal) {
 void PreprocessorParser::parseLine(NonTerminal *nonTerminal) {
 	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_LINE_LINE);
 	
-	// it will be parsed in the last step of the preprocessor
-	writeNonTerminal(nonTerminal);
+	Token *directiveEnd;
+	
+	if (nonTerminal->getNonTerminalRule() == 0) {
+		lineName = cleanToken(nonTerminal->getTokenAt(2));
+		directiveEnd = nonTerminal->getTokenAt(3);
+	}
+	else {
+		assert(nonTerminal->getNonTerminalRule() == 1);
+		directiveEnd = nonTerminal->getTokenAt(2);
+	}
+	
+	// the line after the directive has the given number
+	int line = evaluateConstant(nonTerminal->getTokenAt(1)).intValue();
+	lineOffset = line - (int)directiveEnd->getInputLocation().getLine() - 1;
 }
 
 /*
  * <CONDITIONAL> ::= <IF_LINE> <PREPROCESSOR> <ELIF_PARTS>;
  */
-void PreprocessorParser::parseConditional(NonTerminal *nonTerminal) {
-	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_CONDITIONAL);
-	assert(nonTerminal->getNonTerminalRule() == 0);
+void PreprocessorParser::parseIfLine(NonTerminal *nonTerminal) {
+	Conditional conditional;
+	conditional.parentActive = isActive();
 	
-	if (evaluateIfLine(nonTerminal->getNonTerminalAt(0))) {
-		parsePreprocessor(nonTerminal->getNonTerminalAt(1));
-	}
-	else parseElifParts(nonTerminal->getNonTerminalAt(2));
+	// the expression of a skipped group is not evaluated, it may not be valid
+	conditional.active = conditional.parentActive && evaluateIfLine(nonTerminal);
+	conditional.taken = conditional.active;
+	
+	conditionals.push_back(conditional);
+	setActive(conditional.active);
 }
 
 /*
@@ -235,34 +336,48 @@ void PreprocessorParser::parseConditional(NonTerminal *nonTerminal) {
  *		| <ELSE_PART>
  *		;
  */
-void PreprocessorParser::parseElifParts(NonTerminal *nonTerminal) {
-	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_ELIF_PARTS);
+void PreprocessorParser::parseElifLine(NonTerminal *nonTerminal) {
+	assert(!conditionals.empty());
+	Conditional & conditional = conditionals.back();
 	
-	if (nonTerminal->getNonTerminalRule() == 0) {
-		if (evaluateElifLine(nonTerminal->getNonTerminalAt(0))) {
-			parsePreprocessor(nonTerminal->getNonTerminalAt(1));
-		}
-		else parseElifParts(nonTerminal->getNonTerminalAt(2));
-	}
-	else {
-		assert(nonTerminal->getNonTerminalRule() == 1);
-		parseElsePart(nonTerminal->getNonTerminalAt(0));
-	}
+	conditional.active = conditional.parentActive && !conditional.taken
+			&& evaluateElifLine(nonTerminal);
+	if (conditional.active) conditional.taken = true;
+	
+	setActive(conditional.active);
 }
+
 /*
  * <ELSE_PART> ::= <ELSE_LINE> <PREPROCESSOR> <ENDIF_LINE>
  *		| <ENDIF_LINE>
  *		;
  */
-void PreprocessorParser::parseElsePart(NonTerminal *nonTerminal) {
-	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_ELSE_PART);
+void PreprocessorParser::parseElseLine(NonTerminal *nonTerminal) {
+	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_ELSE_LINE);
+	assert(!conditionals.empty());
+	Conditional & conditional = conditionals.back();
 	
-	if (nonTerminal->getNonTerminalRule() == 0) {
-		parsePreprocessor(nonTerminal->getNonTerminalAt(1));
-	}
-	else {
-		assert(nonTerminal->getNonTerminalRule() == 1);
-	}
+	conditional.active = conditional.parentActive && !conditional.taken;
+	conditional.taken = true;
+	
+	setActive(conditional.active);
+}
+
+void PreprocessorParser::parseEndifLine(NonTerminal *nonTerminal) {
+	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_ENDIF_LINE);
+	assert(!conditionals.empty());
+	
+	conditionals.pop_back();
+	setActive(isActive());
+}
+
+bool PreprocessorParser::isActive() const {
+	return conditionals.empty() || conditionals.back().active;
+}
+
+void PreprocessorParser::setActive(bool active) {
+	scanner->setExpandMacros(active);
+	scanner->setSkipLines(!active);
 }
 
 /*
@@ -304,10 +419,38 @@ bool PreprocessorParser::evaluateElifLine(NonTerminal *nonTerminal) {
 }
 
 void PreprocessorParser::writeCode(NonTerminal *code) {
-	std::string c = getCode(code);
+	Token *token = getCodeToken(code);
+	if (!token || !isActive()) return;
+	
+	InputLocation loc = token->getInputLocation();
+	
+	TokenStream *tokens = preprocessorContext.getTokenOutput();
+	if (tokens) writeTokens(tokens, token);
+	
+	// a precompiled header keeps its code as text too, for -E
+	if (tokens && !preprocessorContext.getPchOutput()) return;
+	
+	moveOutputTo(lineName.empty() ? loc.getName() : lineName, loc.getLine() + lineOffset);
+	
+	const std::string & tok = token->getToken();
+	preprocessorContext.getOutputBuffer()->append(tok);
+	outputLine += std::count(tok.begin(), tok.end(), '\n');
+}
+
+void PreprocessorParser::writeTokens(TokenStream *tokens, Token *token) {
+	// the lines are in the locations of the tokens
+	if (token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_DIRECTIVE_END) return;
+	
+	InputLocation loc = token->getInputLocation();
+	const std::string & name = lineName.empty() ? loc.getName() : lineName;
+	
+	// the code lines are TEXT tokens, already split by the macro scanner
+	assert(token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_TEXT);
+	TextToken *text = (TextToken *)token;
 	
-	for (std::string::const_iterator it = c.begin(); it != c.end(); ++it) {
-		currentOutput.push_back(*it);
+	for (unsigned int i = 0; i < text->getTokenCount(); ++i) {
+		const TextToken::Position & position = text->getPositionAt(i);
+		tokens->addToken(text->getTokenAt(i), name, position.line + lineOffset, position.column);
 	}
 }
 
@@ -339,6 +482,45 @@ std::string PreprocessorParser::getCode(NonTerminal *code) const {
 	return result;
 }
 
+void PreprocessorParser::moveOutputTo(const std::string & name, unsigned int line) {
+	OutputBuffer *output = preprocessorContext.getOutputBuffer().get();
+	
+	if (output->size() > chunkStart) {
+		// a few new lines are cheaper than a new chunk
+		if (name == chunkName && line >= outputLine && line - outputLine <= MAX_LINE_PADDING) {
+			while (outputLine < line) {
+				output->push_back('\n');
+				++outputLine;
+			}
+			return;
+		}
+		
+		flushOutput();
+	}
+	
+	chunkName = name;
+	chunkLine = line;
+	outputLine = line;
+}
+
+void PreprocessorParser::flushOutput() {
+	const Pointer<OutputBuffer> & output = preprocessorContext.getOutputBuffer();
+	if (output->size() == chunkStart) return;
+	
+	output->push_back('\n');
+	
+	// the chunk is read from the blocks of the output, it is not copied
+	Input *chunk = new OutputBufferInput(output, chunkStart, output->size());
+	OffsetInput *in = new OffsetInput(chunk, chunkLine - 1, chunkName);
+	in->setRenameInput(true);
+	listInput->addInput(in);
+	
+	PrecompiledHeader *pch = preprocessorContext.getPchOutput();
+	if (pch) pch->addChunk(chunkName, chunkLine, output->getText(chunkStart, output->size()));
+	
+	chunkStart = output->size();
+}
+
 bool PreprocessorParser::evaluateExpression(NonTerminal *nonTerminal) const {
 	assert(nonTerminal->getNonTerminalId() == PREPROCESSORPARSERBUFFER_NONTERMINAL_CODE_WITHOUT_DIRECTEND);
 	
@@ -3,6 +3,7 @@
 
 #include "preprocessor/PreprocessorParserBase.h"
 
+#include <parser/ParserAction.h>
 #include <parser/ParsingTree.h>
 
 #include <map>
@@ -15,8 +16,15 @@ class ListInput;
 class Parser;
 class PreprocessorContext;
 class PreprocessorExpParser;
+class PreprocessorMacroScanner;
+class TokenStream;
 
-class PreprocessorParser : public PreprocessorParserBase {
+/*
+ * Run the whole preprocessor in a single pass: the directives are handled
+ * as the parser recognizes them, the macros are expanded by the scanner and
+ * the code is written in chunks that keep the location of the source.
+ */
+class PreprocessorParser : public PreprocessorParserBase, private ParserAction {
 	public:
 		typedef std::vector<std::string> FileList;
 		
@@ -26,26 +34,53 @@ class PreprocessorParser : public PreprocessorParserBase {
 		
 		virtual void parse(Input *in);
 		
-	protected:
-		virtual void parseControlLine(NonTerminal *ctrlLine);
+		// the file being parsed is a system header (or included by one)
+		void setSystemHeader(bool system);
 		
-		virtual void parseDefine(NonTerminal *nonTerminal);
-		virtual void parseUndef(NonTerminal *nonTerminal);
+	protected:
+		void parseControlLine(NonTerminal *ctrlLine);
 		
 		void parseInclude(NonTerminal *nonTerminal);
+		void parsePragma(NonTerminal *nonTerminal);
+		
+		// the header was included before and would add nothing now
+		bool isIncludeSkipped(const std::string & fileName) const;
+		
+		/*
+		 * Return the macro of the include guard, if the whole file is
+		 * inside #ifndef MACRO ... #endif, otherwise an empty string.
+		 */
+		std::string getIncludeGuard(NonTerminal *root) const;
+		
+		// the code has only white spaces
+		bool isBlankCode(NonTerminal *code) const;
 		void parseLine(NonTerminal *nonTerminal);
 		
-		void parseConditional(NonTerminal *nonTerminal);
-		void parseElifParts(NonTerminal *nonTerminal);
-		void parseElsePart(NonTerminal *nonTerminal);
+		void parseIfLine(NonTerminal *nonTerminal);
+		void parseElifLine(NonTerminal *nonTerminal);
+		void parseElseLine(NonTerminal *nonTerminal);
+		void parseEndifLine(NonTerminal *nonTerminal);
 		
 		bool evaluateIfLine(NonTerminal *nonTerminal);
 		bool evaluateElifLine(NonTerminal *nonTerminal);
 		
+		// false inside a conditional group that is skipped
+		bool isActive() const;
+		void setActive(bool active);
+		
 		void writeCode(NonTerminal *code);
+		
+		// add the tokens of a code token to the token output
+		void writeTokens(TokenStream *tokens, Token *token);
 		std::string getCode(NonTerminal *code) const;
 		
-		bool getConditionalResult() const;
+		/*
+		 * Make the next code written be at line of name, padding the
+		 * current chunk with new lines or starting a new one.
+		 */
+		void moveOutputTo(const std::string & name, unsigned int line);
+		
+		virtual void flushOutput();
 		
 		bool evaluateExpression(NonTerminal *nonTerminal) const;
 		
@@ -57,7 +92,37 @@ class PreprocessorParser : public PreprocessorParserBase {
 		std::string cleanToken(Token *token) const;
 		
 		PreprocessorExpParser *expParser;
-		const FileList & includeDirs;
+		
+		bool systemHeader;
+		
+	private:
+		struct Conditional {
+			// the group containing the conditional is not skipped
+			bool parentActive;
+			
+			// one of the groups was already chosen
+			bool taken;
+			
+			bool active;
+		};
+		typedef std::vector<Conditional> ConditionalStack;
+		
+		virtual void recognized(NonTerminal *nt);
+		
+		PreprocessorMacroScanner *scanner;
+		
+		ConditionalStack conditionals;
+		
+		// where the chunk being written starts in the output buffer,
+		// and the location of its first line and of its end
+		unsigned long chunkStart;
+		std::string chunkName;
+		unsigned int chunkLine;
+		unsigned int outputLine;
+		
+		// set by #line
+		int lineOffset;
+		std::string lineName;
 };
 
 #endif
@@ -1,13 +1,14 @@
 #ifndef PREPROCESSOR_PARSER_BASE_H
 #define PREPROCESSOR_PARSER_BASE_H
 
+#include "preprocessor/DefineMap.h"
+
 #include <parser/ParsingTree.h>
 
 #include <map>
 #include <list>
 #include <string>
 
-class DefineMap;
 class Input;
 class ListInput;
 class Parser;
@@ -36,26 +37,22 @@ class PreprocessorParserBase {
 		void setShowWarnings(bool show);
 		
 	protected:
-		virtual void parsePreprocessor(NonTerminal *nonTerminal);
-		virtual void parseControlLine(NonTerminal *ctrlLine);
-		
 		virtual void parseDefine(NonTerminal *nonTerminal);
 		virtual void parseUndef(NonTerminal *nonTerminal);
 		
 		void parseArgumentList(NonTerminal *nt, ArgumentIndex & args) const;
 		void defineMacro(const std::string & name, const ArgumentIndex & args, NonTerminal *code);
 		
-		virtual void writeCode(NonTerminal *code);
 		virtual std::string getCode(NonTerminal *code) const;
 		void getCodeTokens(NonTerminal *code, TokenList & tokenList) const;
 		
-		void writeCodeNonRecursive(NonTerminal *code);
-		std::string getCodeNonRecursive(NonTerminal *code) const;
+		// the code lexed as the value of a define
+		DefineMap::MacroTokenList getMacroTokens(NonTerminal *code) const;
 		
-		void writeNonTerminal(NonTerminal *nonTerminal);
-		void getNonTerminalDump(std::string & result, NonTerminal *nonTerminal) const;
+		// the token added by the last rule of <CODE>, NULL if it is empty
+		Token *getCodeToken(NonTerminal *code) const;
 		
-		virtual void flushOutput();
+		virtual void flushOutput() = 0;
 		
 		std::string getMacroName(Token *token) const;
 		
@@ -66,8 +63,6 @@ class PreprocessorParserBase {
 		
 		Parser *parser;
 		
-		std::string currentOutput;
-		
 		bool showWarnings;
 };
 
@@ -1,20 +1,26 @@
 #include "preprocessor/PreprocessorScanner.h"
 
 #include "preprocessor/DefineMap.h"
+#include "CharClass.h"
+#include "MappedInput.h"
 #include "PreprocessorParserBuffer.h"
 #include "UccDefs.h"
 
 #include <parser/Input.h>
+#include <parser/MemoryInput.h>
+#include <parser/OffsetInput.h>
 
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
 
 PreprocessorScanner::PreprocessorScanner(const Pointer<ScannerAutomata> & a, Input *in) :
-		Scanner(a, in), state(LINE_BEGIN), cachedToken(NULL) {}
+		Scanner(a, in), state(LINE_BEGIN), cachedToken(NULL), skipping(false),
+		lineScanner(NULL), mappedInput(dynamic_cast<MappedInput *>(in)) {}
 
 PreprocessorScanner::~PreprocessorScanner() {
 	delete(cachedToken);
+	delete(lineScanner);
 }
 
 ParsingTree::Token *PreprocessorScanner::nextToken() {
@@ -26,9 +32,13 @@ ParsingTree::Token *PreprocessorScanner::nextToken() {
 		return token;
 	}
 	
+	if (lineScanner) return readTokenLineScanner();
+	if (skipping && state == LINE_BEGIN) return skipLines();
+	
 	switch (state) {
 		case LINE_BEGIN: return readTokenLineBegin();
 		case INCLUDE_LINE: return readTokenIncludeLine();
+		case PRAGMA_LINE: return readTokenPragmaLine();
 		case OTHER: return readTokenOther();
 	}
 	
@@ -36,6 +46,10 @@ ParsingTree::Token *PreprocessorScanner::nextToken() {
 	abort();
 }
 
+void PreprocessorScanner::setSkipLines(bool skip) {
+	skipping = skip;
+}
+
 ParsingTree::Token *PreprocessorScanner::readTokenLineBegin() {
 	assert(state == LINE_BEGIN);
 	assert(!cachedToken);
@@ -49,6 +63,9 @@ ParsingTree::Token *PreprocessorScanner::readTokenLineBegin() {
 		if (token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_INCLUDE) {
 			state = INCLUDE_LINE;
 		}
+		else if (token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_PRAGMA) {
+			state = PRAGMA_LINE;
+		}
 		else state = OTHER;
 	}
 	else token = readTextToken(token);
@@ -78,6 +95,33 @@ ParsingTree::Token *PreprocessorScanner::readTokenIncludeLine() {
 	return token;
 }
 
+ParsingTree::Token *PreprocessorScanner::readTokenPragmaLine() {
+	assert(state == PRAGMA_LINE);
+	assert(!cachedToken);
+	
+	Token *token = Scanner::nextToken();
+	if (!token) return NULL;
+	
+	state = OTHER;
+	if (token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_STRING_LITERAL) return token;
+	
+	InputLocation loc = token->getInputLocation();
+	std::string text = "\"";
+	
+	while (token && token->getTokenTypeId() != PREPROCESSORPARSERBUFFER_TOKEN_DIRECTIVE_END) {
+		appendToken(text, token);
+		delete(token);
+		token = Scanner::nextToken();
+	}
+	text.push_back('"');
+	
+	// the directive end is returned next, the line ends with it
+	cachedToken = token;
+	if (token) state = LINE_BEGIN;
+	
+	return new Token(PREPROCESSORPARSERBUFFER_TOKEN_STRING_LITERAL, text, loc);
+}
+
 ParsingTree::Token *PreprocessorScanner::readTokenOther() {
 	assert(state == OTHER);
 	assert(!cachedToken);
@@ -155,3 +199,179 @@ void PreprocessorScanner::appendToken(std::string & result, Token *token) {
 	
 	result.push_back(DELIMITER);
 }
+
+ParsingTree::Token *PreprocessorScanner::skipLines() {
+	assert(state == LINE_BEGIN);
+	assert(!cachedToken && !lineScanner);
+	
+	Input *input = getInput();
+	
+	// the conditionals opened in the skipped lines
+	unsigned int depth = 0;
+	
+	for (;;) {
+		char c = skipBlanks(input->nextChar(), NULL);
+		
+		if (!c) return NULL;
+		if (c != '#') {
+			skipLine(c, NULL);
+			continue;
+		}
+		
+		unsigned int line = input->getInputLine();
+		std::string text = "#";
+		
+		c = skipBlanks(readRawChar(&text), &text);
+		
+		std::string name;
+		while (CharClass::isIdentifier(c)) {
+			name.push_back(c);
+			c = readRawChar(&text);
+		}
+		
+		if (name == "if" || name == "ifdef" || name == "ifndef") ++depth;
+		else if (name == "endif" && depth > 0) --depth;
+		else if (depth == 0 && (name == "elif" || name == "else" || name == "endif")) {
+			skipLine(c, &text);
+			
+			// the directive is lexed as usual, the parser needs its tokens
+			Input *in = new MemoryInput(text, input->getInputName());
+			in = new OffsetInput(in, line - 1);
+			lineScanner = new Scanner(getScannerAutomata(), in);
+			
+			state = OTHER;
+			return readTokenLineScanner();
+		}
+		
+		skipLine(c, NULL);
+	}
+}
+
+ParsingTree::Token *PreprocessorScanner::readTokenLineScanner() {
+	assert(lineScanner);
+	
+	Token *token = lineScanner->nextToken();
+	
+	if (!token || token->getTokenTypeId() == PREPROCESSORPARSERBUFFER_TOKEN_DIRECTIVE_END) {
+		delete(lineScanner);
+		lineScanner = NULL;
+		state = LINE_BEGIN;
+	}
+	
+	// the directive was the end of the input
+	if (!token) return nextToken();
+	
+	return token;
+}
+
+char PreprocessorScanner::skipBlanks(char c, std::string *text) {
+	for (;;) {
+		while (CharClass::isLineSpace(c)) {
+			if (text) text->push_back(c);
+			c = getInput()->nextChar();
+		}
+		if (c != '/') return c;
+		
+		char next = getInput()->nextChar();
+		
+		if (next == '*') {
+			// the directive is lexed without the comment, a space is enough
+			if (text) text->push_back(' ');
+			
+			c = readRawChar(NULL);
+			next = c ? readRawChar(NULL) : 0;
+			while (next && (c != '*' || next != '/')) {
+				c = next;
+				if (c != '*') skipToStar(NULL);
+				next = readRawChar(NULL);
+			}
+			c = next ? readRawChar(NULL) : 0;
+		}
+		else if (next == '/') {
+			while (next && next != '\n') next = readRawChar(NULL);
+			return next;
+		}
+		else {
+			// not a directive, the rest of the line is skipped here
+			skipLine(next, text);
+			return next ? '\n' : 0;
+		}
+	}
+}
+
+void PreprocessorScanner::skipLine(char c, std::string *text) {
+	while (c && c != '\n') {
+		// most of the characters mean nothing here
+		if (CharClass::isPlainText(c)) c = readPlainText(text);
+		if (!c || c == '\n') break;
+		
+		char next = readRawChar(text);
+		
+		if (c == '\\' && next == '\n') {
+			// the line continues
+			c = readRawChar(text);
+		}
+		else if (c == '/' && next == '*') {
+			c = readRawChar(text);
+			next = c ? readRawChar(text) : 0;
+			while (next && (c != '*' || next != '/')) {
+				c = next;
+				
+				// the comment can only end after a '*'
+				if (c != '*') skipToStar(text);
+				next = readRawChar(text);
+			}
+			c = next ? readRawChar(text) : 0;
+		}
+		else if (c == '/' && next == '/') {
+			while (next && next != '\n') next = readRawChar(text);
+			c = next;
+		}
+		else if (c == '\"' || c == '\'') {
+			// in a skipped group a quote may be alone (like in "don't"), the line ends it
+			char quote = c;
+			while (next && next != quote && next != '\n') {
+				if (next == '\\') next = readRawChar(text);
+				if (next) next = readRawChar(text);
+			}
+			c = next == quote ? readRawChar(text) : next;
+		}
+		else c = next;
+	}
+}
+
+char PreprocessorScanner::readPlainText(std::string *text) {
+	if (mappedInput) {
+		unsigned long length;
+		const char *data = mappedInput->peek(length);
+		unsigned long count = CharClass::skipPlainText(data, data + length) - data;
+		
+		if (text) text->append(data, count);
+		mappedInput->skip(count);
+		
+		return readRawChar(text);
+	}
+	
+	char c = readRawChar(text);
+	while (CharClass::isPlainText(c)) c = readRawChar(text);
+	
+	return c;
+}
+
+void PreprocessorScanner::skipToStar(std::string *text) {
+	if (!mappedInput) return;
+	
+	unsigned long length;
+	const char *data = mappedInput->peek(length);
+	const char *star = (const char *)memchr(data, '*', length);
+	unsigned long count = star ? star - data : length;
+	
+	if (text) text->append(data, count);
+	mappedInput->skip(count);
+}
+
+char PreprocessorScanner::readRawChar(std::string *text) {
+	char c = getInput()->nextChar();
+	if (c && text) text->push_back(c);
+	return c;
+}
@@ -7,6 +7,7 @@
 #include <parser/ScannerAutomata.h>
 
 class Input;
+class MappedInput;
 
 class PreprocessorScanner : public Scanner {
 	public:
@@ -18,15 +19,26 @@ class PreprocessorScanner : public Scanner {
 		// return null if the end has been reached
 		virtual Token *nextToken();
 		
+		// inside an inactive #if the lines are skipped without making tokens
+		void setSkipLines(bool skip);
+		
 	protected:
 		enum State {
 			LINE_BEGIN,
 			INCLUDE_LINE,
+			PRAGMA_LINE,
 			OTHER
 		};
 		
 		Token *readTokenLineBegin();
 		Token *readTokenIncludeLine();
+		
+		/*
+		 * The grammar takes a string literal after #pragma, anything else
+		 * (like #pragma once) is read as a string literal with the rest of
+		 * the line.
+		 */
+		Token *readTokenPragmaLine();
 		Token *readTokenOther();
 		
 		/*
@@ -41,11 +53,54 @@ class PreprocessorScanner : public Scanner {
 		virtual Token *readTextToken(Token *startToken);
 		void appendToken(std::string & result, Token *token);
 		
+		/*
+		 * Skip the lines until the #elif, #else or #endif that ends the
+		 * group, the conditionals nested in it are skipped too. Only the
+		 * directives at the start of the lines are looked at, the other
+		 * characters are not lexed.
+		 * Return the first token of the directive, NULL at the end.
+		 */
+		Token *skipLines();
+		Token *readTokenLineScanner();
+		
+		/*
+		 * Read up to the end of the line (the '\n' included), c is the
+		 * character already read. The comments may take many lines.
+		 * If text is not NULL the characters read are added to it.
+		 */
+		void skipLine(char c, std::string *text);
+		
+		/*
+		 * Skip the spaces and the comments before a directive or its name,
+		 * c is the character already read. Return the first other character,
+		 * a '\n' if a line comment or a '/' that is not a comment ended the line.
+		 */
+		char skipBlanks(char c, std::string *text);
+		
+		/*
+		 * Read the plain text after the character already read, return the
+		 * first other character. A mapped input is tested in blocks, in place.
+		 */
+		char readPlainText(std::string *text);
+		
+		// pass the characters before the next '*', only on a mapped input
+		void skipToStar(std::string *text);
+		
+		char readRawChar(std::string *text);
+		
 		State state;
 		
 		// some times we need to look a token forward
 		// if we do not use it, we need to save it
 		Token *cachedToken;
+		
+		bool skipping;
+		
+		// lexes the directive that ends the skipped lines
+		Scanner *lineScanner;
+		
+		// the input if it is a MappedInput, its skipped lines are read in place
+		MappedInput *mappedInput;
 };
 
 #endif
@@ -1,5 +0,0 @@
-#include "ScannerWrapper.h"
-
-ScannerWrapper::ScannerWrapper() {}
-
-ScannerWrapper::~ScannerWrapper() {}
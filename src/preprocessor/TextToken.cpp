@@ -0,0 +1,24 @@
+#include "preprocessor/TextToken.h"
+
+#include "PreprocessorParserBuffer.h"
+
+#include <cassert>
+
+TextToken::TextToken(const std::string & tok, const InputLocation & location, const PositionList & pos) :
+		ParsingTree::Token(PREPROCESSORPARSERBUFFER_TOKEN_TEXT, tok, location), positions(pos) {}
+		
+TextToken::~TextToken() {}
+
+unsigned int TextToken::getTokenCount() const {
+	return positions.size();
+}
+
+std::string TextToken::getTokenAt(unsigned int index) const {
+	assert(index < positions.size());
+	return getToken().substr(positions[index].start, positions[index].length);
+}
+
+const TextToken::Position & TextToken::getPositionAt(unsigned int index) const {
+	assert(index < positions.size());
+	return positions[index];
+}
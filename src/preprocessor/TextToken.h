@@ -0,0 +1,39 @@
+#ifndef TEXT_TOKEN_H
+#define TEXT_TOKEN_H
+
+#include <parser/ParsingTree.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * A TEXT token, a line of code with its macros expanded. It keeps where each
+ * of its tokens is, so they can be handed to the compiler without lexing
+ * the line again.
+ */
+class TextToken : public ParsingTree::Token {
+	public:
+		struct Position {
+			// in the text of the token
+			unsigned int start;
+			unsigned int length;
+			
+			// in the source, a macro call can go on in the next lines
+			unsigned int line;
+			unsigned int column;
+		};
+		typedef std::vector<Position> PositionList;
+		
+		TextToken(const std::string & tok, const InputLocation & location, const PositionList & pos);
+		virtual ~TextToken();
+		
+		unsigned int getTokenCount() const;
+		
+		std::string getTokenAt(unsigned int index) const;
+		const Position & getPositionAt(unsigned int index) const;
+		
+	private:
+		PositionList positions;
+};
+
+#endif
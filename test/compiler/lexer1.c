@@ -0,0 +1,26 @@
+/*
+ * Compiled with and without -e: the C lexer must split the code as the
+ * preprocessor scanner does.
+ */
+extern int printf(const char *format, ...);
+
+int main(int argc, char *argv[]) {
+	double d;
+	int a<:2:>;
+	int i;
+	
+	d = 1.e5;
+	d = d + 1.5e-3 + 10.25;
+	i = 0x1fL;
+	
+	/**/
+	a<:0:> = 6; /* a comment * with ** stars **/
+	a<:1:> = a<:0:>/2; // a line comment / * /
+	i = i + a<:1:> /* between */ / 3;
+	i /= 1;
+	
+	printf("/* not a comment */ // %d\n", i);
+	printf("%lf\n", d);
+	
+	return 0;
+}
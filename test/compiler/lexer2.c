@@ -0,0 +1,8 @@
+int main() {
+	double d;
+	
+	/* c_scanner.bnf has no constant for .5, it is a '.' and a 5 */
+	d = .5;
+	
+	return 0;
+}
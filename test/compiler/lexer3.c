@@ -0,0 +1,9 @@
+int main() {
+	int x;
+	double d;
+	
+	/* not an exponent, it is 1 e + x */
+	d = 1e+x;
+	
+	return 0;
+}
@@ -0,0 +1,6 @@
+/* '..' is not an ELLIPSIS, it is two '.' */
+extern int printf(const char *format, ..);
+
+int main() {
+	return 0;
+}
@@ -0,0 +1,6 @@
+int main() {
+	return 0;
+}
+
+/* a '/' at the end of the input */
+int a = 4 /
\ No newline at end of file
@@ -0,0 +1,22 @@
+/*
+ * Long runs of spaces and long comments, passed over in blocks of 16 or 32
+ * characters with -e: a token right after a block must keep its column.
+ */
+extern int printf(const char *format, ...);
+                                        
+
+int main(int argc, char *argv[]) {
+	int i;                                 
+																				i = 1;                               /*----------------------------------------------------------------------*/i = i + 2;
+
+	/* a comment over many lines, with a star at each end of a block:
+	 *                             *               *
+	****************************************
+	*/                                                                i = i * 3;
+                 
+
+
+               printf("%d\n", i);
+	
+	return 0;
+}
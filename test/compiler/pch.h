@@ -0,0 +1,15 @@
+/*
+ * Precompiled to pch.pch, the units that include it first are compiled with
+ * and without it: the declarations restored must give the same code.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef unsigned int count_t;
+typedef count_t *count_ptr;
+
+extern int total;
+int scratch[4];
+const double ratio;
+
+extern count_t increment(count_ptr c);
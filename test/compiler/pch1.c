@@ -0,0 +1,18 @@
+#include "pch.h"
+
+count_t increment(count_ptr c) {
+	*c = *c + 1;
+	return *c;
+}
+
+int main() {
+	count_t c;
+	
+	c = 0;
+	increment(&c);
+	scratch[0] = c;
+	
+	printf("%d %d %lf\n", scratch[0], total, ratio);
+	
+	return 0;
+}
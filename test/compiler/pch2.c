@@ -0,0 +1,2 @@
+// only the header, nothing is parsed with the precompiled one
+#include "pch.h"
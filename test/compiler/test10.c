@@ -0,0 +1,17 @@
+#include <stdio.h>
+
+#define ADD(a, b) ((a) + (b))
+#define SHOW(fmt, value) printf(fmt, value)
+
+int main(int argc, char *argv[]) {
+	int sum;
+	
+	sum = ADD(1,
+		2);
+	
+	SHOW("%d\n",
+		ADD(sum,
+			3)); printf("after the call\n");
+	
+	return 0;
+}
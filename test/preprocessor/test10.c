@@ -0,0 +1,19 @@
+// a macro is not expanded again inside its own expansion
+#define x (x + 1)
+#define TWICE(a) a + a
+
+// f(2)(9) expands to 2 * 9 * g
+#define f(a) a * g
+#define g(a) f(a)
+
+#define EMPTY()
+#define CALL(m, a) m(a)
+
+int main(int argc, char *argv[]) {
+	int x = 1;
+	int g = 2;
+	
+	x = TWICE(x);
+	EMPTY()
+	return CALL(TWICE, f(2)(9));
+}
@@ -0,0 +1,13 @@
+// preprocessed with --pch test11.pch, the first include is read from it
+#include "test11.h"
+#include "test8_once.h"
+
+int main() {
+	struct once o;
+	number n = SQUARE(LIMIT);
+	
+#ifdef __inline
+	return 1;
+#endif
+	return n;
+}
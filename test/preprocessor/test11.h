@@ -0,0 +1,13 @@
+#ifndef TEST11_H
+#define TEST11_H
+
+#include "test8_once.h"
+
+#define SQUARE(a) ((a) * (a))
+#define LIMIT 10
+
+#undef __inline
+
+typedef int number;
+
+#endif
@@ -0,0 +1,35 @@
+// the skipped lines are not lexed, only their directives are looked at
+#if 0
+don't lex this line
+#if 1
+#error nested in a skipped group
+#else
+#error nested in a skipped group
+#endif
+/* a comment hiding
+#endif
+*/ "#endif"
+#unknown directive
+/* a comment before */ #if 1
+#error nested in a skipped group
+/**/#endif
+#error still in the skipped group
+  # /* a comment
+  between */ endif
+#error still in the skipped group
+#elif(1)
+#define VALUE 1
+#else
+#error not taken
+#endif /* the end
+of the group */
+
+#ifndef VALUE
+#error not taken
+/* the directives may start with comments */ # /**/ else
+#define TAKEN 1
+#endif
+
+int main(int argc, char *argv[]) {
+	return VALUE + TAKEN;
+}
@@ -0,0 +1,19 @@
+// the same condition twice, the second time with other macros
+#define A 2
+#if A * 3 == 6 && (defined(A) ? 1 : UNDEFINED_NAME)
+#define FIRST 1
+#else
+#error A is 2
+#endif
+
+#undef A
+#define A 3
+#if A * 3 == 6 && (defined(A) ? 1 : UNDEFINED_NAME)
+#error A is 3
+#elif 0 && UNDEFINED_NAME || !defined B
+#define SECOND 2
+#endif
+
+int main(int argc, char *argv[]) {
+	return FIRST + SECOND;
+}
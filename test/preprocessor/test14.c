@@ -0,0 +1,14 @@
+// preprocessed with --pch test11.pch, its first include is not test11.h
+#include "test8_once.h"
+
+#ifdef LIMIT
+#error "the precompiled header was used"
+#endif
+
+/* test11.h is read again, it is not the first include */
+#include "test11.h"
+
+int main() {
+	number n = LIMIT;
+	return n;
+}
@@ -0,0 +1,19 @@
+// long skipped lines, passed over in blocks of 16 or 32 characters
+#if 0
+xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx "#endif" yyyyyyyyyyyyyyyyyyyy'#endif
+zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz/***
+#endif
+--------------------------------------------------*/ #error still skipped
+                                 // #endif
+aaaaaaaaaaaaaaa\
+#endif
+#if 1
+bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb
+#endif
+#else
+#define VALUE 3
+#endif
+
+int main(int argc, char *argv[]) {
+	return VALUE;
+}
@@ -0,0 +1,12 @@
+// each header must appear only once in the output
+#include "test8_once.h"
+#include "test8_guard.h"
+#include "test8_once.h"
+#include "test8_guard.h"
+
+int main() {
+	struct once o;
+	struct guard g;
+	
+	return 0;
+}
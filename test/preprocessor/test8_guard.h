@@ -0,0 +1,8 @@
+#ifndef TEST8_GUARD_H
+#define TEST8_GUARD_H
+
+struct guard {
+	int y;
+};
+
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+
+struct once {
+	int x;
+};
@@ -0,0 +1,21 @@
+#define ONE 1
+
+#if ONE
+#ifdef TWO
+#error TWO is not defined
+#elif ONE == 1
+#define THREE 3
+#else
+#error ONE is 1
+#endif
+#else
+#define TWO 2
+#if TWO
+#error skipped
+#endif
+#endif
+
+#line 100 "test9_line.c"
+int main(int argc, char *argv[]) {
+	return ONE + THREE;
+}